@@ -0,0 +1,68 @@
+#include "BallBlurProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+#include "GLState.hpp"
+
+BallBlurProgram::BallBlurProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform mat4 OBJECT_TO_CLIP;\n"
+		"uniform float BALL_RADIUS;\n"
+		"uniform float PIXEL_SIZE;\n"
+		"in vec2 Corner;\n"
+		"in vec4 Ball;\n"
+		"out vec2 local;\n" //(along the motion, across the motion) from the middle of the path
+		"flat out float half_path;\n"
+		"void main() {\n"
+		"	float moved = length(Ball.zw);\n"
+		"	vec2 along = (moved > 0.0 ? Ball.zw / moved : vec2(1.0, 0.0));\n"
+		"	vec2 across = vec2(-along.y, along.x);\n"
+		"	half_path = 0.5 * moved;\n"
+		//cover every position the ball was in, plus a pixel for the antialiased edge:
+		"	local = Corner * vec2(half_path + BALL_RADIUS + PIXEL_SIZE, BALL_RADIUS + PIXEL_SIZE);\n"
+		"	vec2 middle = Ball.xy - 0.5 * Ball.zw;\n"
+		"	gl_Position = OBJECT_TO_CLIP * vec4(middle + local.x * along + local.y * across, 0.0, 1.0);\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"uniform float BALL_RADIUS;\n"
+		"uniform float PIXEL_SIZE;\n"
+		"uniform vec4 COLOR;\n"
+		"in vec2 local;\n"
+		"flat in float half_path;\n"
+		"out vec4 fragColor;\n"
+		"void main() {\n"
+		//the ball covers this point while its center is within 'reach' of local.x along the path:
+		// (|local.y| is held back from the very edge so the sides fade out below instead of pinching off)
+		"	float y = min(abs(local.y), max(BALL_RADIUS - 0.5 * PIXEL_SIZE, 0.0));\n"
+		"	float reach = sqrt(BALL_RADIUS * BALL_RADIUS - y * y);\n"
+		//so the covered fraction of the exposure is the overlap of [local.x - reach, local.x + reach] with the path:
+		// (paths shorter than a pixel are treated as a pixel long, which also antialiases the front and back)
+		"	float path = max(half_path, 0.5 * PIXEL_SIZE);\n"
+		"	float covered = max(0.0, min(local.x + reach, path) - max(local.x - reach, -path)) / (2.0 * path);\n"
+		"	float sides = clamp(0.5 - (abs(local.y) - BALL_RADIUS) / PIXEL_SIZE, 0.0, 1.0);\n"
+		"	float alpha = COLOR.a * covered * sides;\n"
+		"	fragColor = vec4(COLOR.rgb * alpha, alpha);\n"
+		"}\n"
+	);
+
+	//look up the locations of vertex attributes:
+	Corner_vec2 = glGetAttribLocation(program, "Corner");
+	Ball_vec4 = glGetAttribLocation(program, "Ball");
+
+	//look up the locations of uniforms:
+	OBJECT_TO_CLIP_mat4 = glGetUniformLocation(program, "OBJECT_TO_CLIP");
+	BALL_RADIUS_float = glGetUniformLocation(program, "BALL_RADIUS");
+	PIXEL_SIZE_float = glGetUniformLocation(program, "PIXEL_SIZE");
+	COLOR_vec4 = glGetUniformLocation(program, "COLOR");
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+BallBlurProgram::~BallBlurProgram() {
+	GLState::delete_program(program);
+	program = 0;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "GL.hpp"
+
+//Shader program that draws one motion-blurred round ball per instance:
+// per-vertex Corner is in [-1,1]^2; per-instance Ball is (x, y, dx, dy) in court space --
+// where the ball is at the end of the exposure, and how far it moved during it.
+// Each quad is stretched along (dx, dy) to cover the ball's whole path; the fragment shader
+// computes the fraction of the exposure each point was covered, and outputs premultiplied alpha.
+struct BallBlurProgram {
+	BallBlurProgram();
+	~BallBlurProgram();
+
+	GLuint program = 0;
+
+	//Attribute (per-vertex variable) locations:
+	GLuint Corner_vec2 = -1U;
+
+	//Attribute (per-instance variable) locations:
+	GLuint Ball_vec4 = -1U;
+
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+	GLuint BALL_RADIUS_float = -1U;
+	GLuint PIXEL_SIZE_float = -1U; //size of a pixel in court units (for antialiasing)
+	GLuint COLOR_vec4 = -1U;
+};
@@ -0,0 +1,240 @@
+#include "BallDefender.hpp"
+
+//for PROFILE_ZONE():
+#include "Profiler.hpp"
+
+//for math operations related to the arc
+#include <cmath>
+#define _USE_MATH_DEFINES
+
+float BallDefender::speed_multiplier() const {
+	//increase the speed multiplier based on the number of wall collisions
+	return glm::min((float)num_collisions * speed_per_collision + base_speed, max_speed);
+}
+
+void BallDefender::update(float elapsed) {
+	PROFILE_ZONE("BallDefender::update");
+
+	//end the game if health reaches zero
+	if (health > 0)
+	{
+		//----- ball update -----
+
+		//add a new ball every spawn_interval (12) wall collisions, up to a max of 7 balls in play at once
+		if (num_collisions != 0 && num_collisions <= 6 * spawn_interval && num_collisions % spawn_interval == 0) {
+			PROFILE_ZONE("spawn");
+			int index = num_collisions / spawn_interval;
+			if (index % 2 == 0)
+			{
+				balls[index] = glm::vec2(6.0f, 0.0f);
+				ball_velocities[index] = glm::vec2(-1.0f, 0.0f);
+			}
+			else {
+				balls[index] = glm::vec2(-6.0f, 0.0f);
+				ball_velocities[index] = glm::vec2(1.0f, 0.0f);
+			}
+		}
+
+		float speed = speed_multiplier();
+
+		//loop through all the balls and move them if necessary
+		{
+			PROFILE_ZONE("integrate");
+			for (int i = 0; i < 7; i++) {
+				if (balls[i].x != 12.0f) {
+					balls[i] += elapsed * ball_velocities[i] * speed;
+				}
+			}
+		}
+
+		//---- collision handling ----
+
+		//arc paddle:
+		auto arc_vs_ball = [this](glm::vec2 const &paddle, glm::vec2 &ball, glm::vec2 &ball_velocity) {
+			//find the corners of the ball:
+			glm::vec2 top_left = glm::vec2(ball.x - ball_radius.x, ball.y - ball_radius.y);
+			glm::vec2 top_right = glm::vec2(ball.x + ball_radius.x, ball.y - ball_radius.y);
+			glm::vec2 bottom_left = glm::vec2(ball.x - ball_radius.x, ball.y + ball_radius.y);
+			glm::vec2 bottom_right = glm::vec2(ball.x + ball_radius.x, ball.y + ball_radius.y);
+
+			//compute the magnitude of the distance from the center of the window to the ball's corners:
+			float top_left_distance = std::sqrt(top_left.x * top_left.x + top_left.y * top_left.y);
+			float top_right_distance = std::sqrt(top_right.x * top_right.x + top_right.y * top_right.y);
+			float bottom_left_distance = std::sqrt(bottom_left.x * bottom_left.x + bottom_left.y * bottom_left.y);
+			float bottom_right_distance = std::sqrt(bottom_right.x * bottom_right.x + bottom_right.y * bottom_right.y);
+
+			//check if ball close enough to center to possibly collide with arc:
+			if ((top_left_distance <= 1.35f     && top_left_distance >= 1.0f) ||
+				(top_right_distance <= 1.35f    && top_right_distance >= 1.0f) ||
+				(bottom_left_distance <= 1.35f  && bottom_left_distance >= 1.0f) ||
+				(bottom_right_distance <= 1.35f && bottom_right_distance >= 1.0f)) {
+				//compute the "collision points" from the arc that will be compared against the ball
+				double theta = atan(paddle.y / paddle.x);
+				if (paddle.x < 0) theta += M_PI;
+				glm::vec2 arc_left_corner = glm::vec2(1.35f * cos(theta - 0.5f), 1.35f * sin(theta - 0.5f));
+				glm::vec2 arc_center = glm::vec2(1.35f * cos(theta), 1.35f * sin(theta));
+				glm::vec2 arc_right_corner = glm::vec2(1.35f * cos(theta + 0.25f), 1.35f * sin(theta + 0.25f));
+				//get the min and max in x and y of the arc's collision points
+				float x_min = glm::min(arc_center.x, glm::min(arc_left_corner.x, arc_right_corner.x));
+				float x_max = glm::max(arc_center.x, glm::max(arc_left_corner.x, arc_right_corner.x));
+				float y_min = glm::min(arc_center.y, glm::min(arc_left_corner.y, arc_right_corner.y));
+				float y_max = glm::max(arc_center.y, glm::max(arc_left_corner.y, arc_right_corner.y));
+				//compare corners of the ball against the arc's collision points
+				if ((top_left.x     >= x_min && top_left.x     <= x_max && top_left.y     >= y_min && top_left.y     <= y_max) ||
+					(top_right.x    >= x_min && top_right.x    <= x_max && top_right.y    >= y_min && top_right.y    <= y_max) ||
+					(bottom_left.x  >= x_min && bottom_left.x  <= x_max && bottom_left.y  >= y_min && bottom_left.y  <= y_max) ||
+					(bottom_right.x >= x_min && bottom_right.x <= x_max && bottom_right.y >= y_min && bottom_right.y <= y_max)) {
+					//change ball x velocity:
+					if (ball.x > 0.0f) {
+						ball.x += ball_radius.x;
+						ball_velocity.x = std::abs(ball_velocity.x);
+					}
+					else if (ball.x < 0.0f) {
+						ball.x -= ball_radius.x;
+						ball_velocity.x = -std::abs(ball_velocity.x);
+					}
+					//change ball y velocity:
+					if (ball.y > 0.0f) {
+						ball.y += ball_radius.y;
+						ball_velocity.y = std::abs(ball_velocity.y);
+					}
+					else if (ball.y < 0.0f) {
+						ball.y -= ball_radius.y;
+						ball_velocity.y = -std::abs(ball_velocity.y);
+					}
+					//warp y velocity based on offset from window center:
+					float vel = (ball.y - paddle.y) / (1.35f + ball_radius.y);
+					ball_velocity.y = glm::min(glm::mix(ball_velocity.y, vel, 0.75f), 1.0f);
+					ball_velocity.y = glm::max(ball_velocity.y, -1.0f);
+				}
+			}
+		};
+
+		//for each ball, do collisions
+		for (int i = 0; i < 7; i++) {
+			if (balls[i].x != 12.0f) {
+				{
+					PROFILE_ZONE("arc collision");
+					arc_vs_ball(arc_paddle, balls[i], ball_velocities[i]);
+				}
+
+				{
+					PROFILE_ZONE("wall bounce"); //(and the center square)
+
+					//court walls:
+					if (balls[i].y > court_radius.y - ball_radius.y) {
+						balls[i].y = court_radius.y - ball_radius.y;
+						if (ball_velocities[i].y > 0.0f) {
+							ball_velocities[i].y = -ball_velocities[i].y;
+						}
+						num_collisions += 1;
+					}
+					if (balls[i].y < -court_radius.y + ball_radius.y) {
+						balls[i].y = -court_radius.y + ball_radius.y;
+						if (ball_velocities[i].y < 0.0f) {
+							ball_velocities[i].y = -ball_velocities[i].y;
+						}
+						num_collisions += 1;
+					}
+
+					if (balls[i].x > court_radius.x - ball_radius.x) {
+						balls[i].x = court_radius.x - ball_radius.x;
+						if (ball_velocities[i].x > 0.0f) {
+							ball_velocities[i].x = -ball_velocities[i].x;
+						}
+						num_collisions += 1;
+					}
+					if (balls[i].x < -court_radius.x + ball_radius.x) {
+						balls[i].x = -court_radius.x + ball_radius.x;
+						if (ball_velocities[i].x < 0.0f) {
+							ball_velocities[i].x = -ball_velocities[i].x;
+						}
+						num_collisions += 1;
+					}
+
+					//center square:
+					if (balls[i].x >= -2.0f * ball_radius.x && balls[i].x <= 2.0f * ball_radius.x &&
+						balls[i].y >= -2.0f * ball_radius.y && balls[i].y <= 2.0f * ball_radius.y) {
+						if (num_collisions % 2 == 0) {
+							balls[i] = glm::vec2(6.0f, 0.0f);
+							ball_velocities[i] = glm::vec2(-1.0f, 0.0f);
+						}
+						else {
+							balls[i] = glm::vec2(-6.0f, 0.0f);
+							ball_velocities[i] = glm::vec2(1.0f, 0.0f);
+						}
+						health -= 1;
+						num_collisions += 1;
+					}
+				}
+
+				{
+					//other balls:
+					PROFILE_ZONE("pair resolution");
+					for (int j = 0; j < 7; j++) {
+						if (i != j && balls[j].x != 12.0f &&
+							balls[i].x - balls[j].x >= -2.0f * ball_radius.x && balls[i].x - balls[j].x <= 2.0f * ball_radius.x &&
+							balls[i].y - balls[j].y >= -2.0f * ball_radius.y && balls[i].y - balls[j].y <= 2.0f * ball_radius.y) {
+							if (std::abs(balls[i].x - balls[j].x) > std::abs(balls[i].y - balls[j].y)) {
+								if (balls[i].x > balls[j].x) {
+									balls[i].x += ball_radius.x;
+									balls[j].x -= ball_radius.x;
+								}
+								else {
+									balls[i].x -= ball_radius.x;
+									balls[j].x += ball_radius.x;
+								}
+								ball_velocities[i].x = -ball_velocities[i].x;
+								ball_velocities[j].x = -ball_velocities[j].x;
+							}
+							else if (std::abs(balls[i].x - balls[j].x) == std::abs(balls[i].y - balls[j].y)) {
+								if (balls[i].x > balls[j].x) {
+									balls[i].x += ball_radius.x;
+									balls[j].x -= ball_radius.x;
+								}
+								else {
+									balls[i].x -= ball_radius.x;
+									balls[j].x += ball_radius.x;
+								}
+								if (balls[i].y > balls[j].y) {
+									balls[i].y += ball_radius.y;
+									balls[j].y -= ball_radius.y;
+								}
+								else {
+									balls[i].y -= ball_radius.y;
+									balls[j].y += ball_radius.y;
+								}
+								ball_velocities[i].x = -ball_velocities[i].x;
+								ball_velocities[i].y = -ball_velocities[i].y;
+							}
+							else {
+								if (balls[i].y > balls[j].y) {
+									balls[i].y += ball_radius.y;
+									balls[j].y -= ball_radius.y;
+								}
+								else {
+									balls[i].y -= ball_radius.y;
+									balls[j].y += ball_radius.y;
+								}
+								ball_velocities[i].y = -ball_velocities[i].y;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	//reset the game if health reaches zero
+	else {
+		restart();
+	}
+}
+
+void BallDefender::restart() {
+	//a fresh game is a default-constructed state, adjusted for the difficulty settings:
+	Snapshot fresh;
+	fresh.arc_paddle = arc_paddle;
+	fresh.health = max_health;
+	fresh.num_collisions = spawn_interval - 1;
+	restore(fresh);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+/*
+ * BallDefenderState is everything about a game of Ball Defender that changes as it
+ *  is played. It is trivially copyable, so it doubles as the game's snapshot format:
+ *  saving and restoring are single ~130 byte struct copies, and snapshot_file.hpp can
+ *  write one to disk (bump Version whenever the layout changes).
+ */
+
+struct BallDefenderState {
+	static constexpr uint32_t Version = 1;
+
+	//paddle direction (the arc is drawn at the angle of this vector):
+	glm::vec2 arc_paddle = glm::vec2(1.0f, 0.0f);
+
+	//multiple balls, with the first already in the game at the start
+	glm::vec2 balls[7] = { glm::vec2(6.0f, 0.0f), glm::vec2(12.0f, 0.0f), glm::vec2(12.0f, 0.0f), glm::vec2(12.0f, 0.0f), glm::vec2(12.0f, 0.0f),
+	                       glm::vec2(12.0f, 0.0f), glm::vec2(12.0f, 0.0f) };
+	glm::vec2 ball_velocities[7] = { glm::vec2(-1.0f, 0.0f), glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 0.0f),
+	                                 glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 0.0f) };
+
+	uint32_t health = 5;
+	uint32_t num_collisions = 11; //initially set to 11 so the second ball spawns after the first wall collision
+};
+
+/*
+ * BallDefender holds the state and rules of Ball Defender (the game NewMode plays),
+ *  without any drawing or input code.
+ *
+ * It is plain data (no pointers, no GL objects), so it can be copied freely --
+ *  e.g., to hand snapshots from a simulation thread to the drawing code, or to run
+ *  many games at once without a window.
+ */
+
+struct BallDefender : BallDefenderState {
+	//advance the game by 'elapsed' seconds with the paddle at arc_paddle:
+	// (when health reaches zero, the following update restarts the game)
+	void update(float elapsed);
+
+	//----- snapshots -----
+	//(for rollback, restarting, or starting tools from a saved game; difficulty and court size are settings, so aren't included)
+
+	typedef BallDefenderState Snapshot;
+	Snapshot save() const { return *this; }
+	void restore(Snapshot const &snapshot) { static_cast< BallDefenderState & >(*this) = snapshot; }
+
+	//go back to the start of a game (with the current difficulty; the paddle stays where it is):
+	void restart();
+
+	//----- difficulty -----
+	//(the game uses the defaults; these are here so tools can try other difficulty curves)
+
+	uint32_t spawn_interval = 12; //a new ball enters every this many wall collisions
+	float base_speed = 2.0f; //ball speed multiplier at the start...
+	float speed_per_collision = 1.0f / 12.0f; //...increased by this per wall collision...
+	float max_speed = 7.5f; //...up to this
+	uint32_t max_health = 5; //health after a reset
+
+	//how many times ball_velocities the balls currently move per second:
+	float speed_multiplier() const;
+
+	//----- court size -----
+
+	glm::vec2 court_radius = glm::vec2(7.0f, 5.0f);
+	glm::vec2 paddle_radius = glm::vec2(0.2f, 1.0f);
+	glm::vec2 ball_radius = glm::vec2(0.2f, 0.2f);
+};
@@ -0,0 +1,46 @@
+#include "BallInstanceProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+#include "GLState.hpp"
+
+BallInstanceProgram::BallInstanceProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform mat4 OBJECT_TO_CLIP;\n"
+		"uniform vec2 BALL_RADIUS;\n"
+		"uniform vec4 COLOR;\n"
+		"in vec2 Corner;\n"
+		"in vec4 Ball;\n"
+		"out vec4 color;\n"
+		"void main() {\n"
+		"	gl_Position = OBJECT_TO_CLIP * vec4(Ball.xy + Corner * BALL_RADIUS, 0.0, 1.0);\n"
+		"	color = COLOR;\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"in vec4 color;\n"
+		"out vec4 fragColor;\n"
+		"void main() {\n"
+		"	fragColor = color;\n"
+		"}\n"
+	);
+
+	//look up the locations of vertex attributes:
+	Corner_vec2 = glGetAttribLocation(program, "Corner");
+	Ball_vec4 = glGetAttribLocation(program, "Ball");
+
+	//look up the locations of uniforms:
+	OBJECT_TO_CLIP_mat4 = glGetUniformLocation(program, "OBJECT_TO_CLIP");
+	BALL_RADIUS_vec2 = glGetUniformLocation(program, "BALL_RADIUS");
+	COLOR_vec4 = glGetUniformLocation(program, "COLOR");
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+BallInstanceProgram::~BallInstanceProgram() {
+	GLState::delete_program(program);
+	program = 0;
+}
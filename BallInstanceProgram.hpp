@@ -0,0 +1,24 @@
+#pragma once
+
+#include "GL.hpp"
+
+//Shader program that draws one solid-colored square per instance:
+// per-vertex Corner is in [-1,1]^2; per-instance Ball is (x, y, vx, vy) in court space.
+// (Ball uses the same layout as BallSimProgram, so its output buffer can be drawn directly)
+struct BallInstanceProgram {
+	BallInstanceProgram();
+	~BallInstanceProgram();
+
+	GLuint program = 0;
+
+	//Attribute (per-vertex variable) locations:
+	GLuint Corner_vec2 = -1U;
+
+	//Attribute (per-instance variable) locations:
+	GLuint Ball_vec4 = -1U;
+
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+	GLuint BALL_RADIUS_vec2 = -1U;
+	GLuint COLOR_vec4 = -1U;
+};
@@ -0,0 +1,63 @@
+#include "BallSimProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+#include "GLState.hpp"
+
+BallSimProgram::BallSimProgram() {
+	program = gl_compile_transform_feedback_program(
+		//vertex shader (no fragment shader -- results are only captured):
+		"#version 330\n"
+		"uniform float STEP;\n"
+		"uniform vec2 COURT_RADIUS;\n"
+		"uniform vec2 BALL_RADIUS;\n"
+		"uniform float PADDLE_THETA;\n"
+		"in vec4 Ball;\n"
+		"out vec4 NextBall;\n"
+		"void main() {\n"
+		"	vec2 at = Ball.xy + STEP * Ball.zw;\n"
+		"	vec2 vel = Ball.zw;\n"
+		//arc paddle: reflect inward-moving balls off the arc's radial normal:
+		"	float r = length(at);\n"
+		"	if (r >= 1.0 - BALL_RADIUS.x && r <= 1.35 + BALL_RADIUS.x) {\n"
+		"		float d = atan(at.y, at.x) - PADDLE_THETA;\n"
+		"		d -= 6.2831853 * floor((d + 3.1415927) / 6.2831853);\n"
+		"		if (d >= -0.5 && d <= 0.5) {\n"
+		"			vec2 n = at / r;\n"
+		"			float vn = dot(vel, n);\n"
+		"			if (vn < 0.0) vel -= 2.0 * vn * n;\n"
+		"		}\n"
+		"	}\n"
+		//court walls:
+		"	vec2 lim = COURT_RADIUS - BALL_RADIUS;\n"
+		"	if (at.x >  lim.x) { at.x =  lim.x; vel.x = -abs(vel.x); }\n"
+		"	if (at.x < -lim.x) { at.x = -lim.x; vel.x =  abs(vel.x); }\n"
+		"	if (at.y >  lim.y) { at.y =  lim.y; vel.y = -abs(vel.y); }\n"
+		"	if (at.y < -lim.y) { at.y = -lim.y; vel.y =  abs(vel.y); }\n"
+		//center square:
+		"	if (abs(at.x) <= 2.0 * BALL_RADIUS.x && abs(at.y) <= 2.0 * BALL_RADIUS.y) {\n"
+		"		at.x = (at.x < 0.0 ? 1.0 : -1.0) * (COURT_RADIUS.x - 1.0);\n"
+		"		vel = -vel;\n"
+		"	}\n"
+		"	NextBall = vec4(at, vel);\n"
+		"}\n"
+	,
+		{ "NextBall" }
+	);
+
+	//look up the locations of vertex attributes:
+	Ball_vec4 = glGetAttribLocation(program, "Ball");
+
+	//look up the locations of uniforms:
+	STEP_float = glGetUniformLocation(program, "STEP");
+	COURT_RADIUS_vec2 = glGetUniformLocation(program, "COURT_RADIUS");
+	BALL_RADIUS_vec2 = glGetUniformLocation(program, "BALL_RADIUS");
+	PADDLE_THETA_float = glGetUniformLocation(program, "PADDLE_THETA");
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+BallSimProgram::~BallSimProgram() {
+	GLState::delete_program(program);
+	program = 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "GL.hpp"
+
+//Transform feedback program that advances balls by one step:
+// reads Ball = (x, y, vx, vy) per vertex, writes the stepped ball to NextBall.
+// Run with GL_RASTERIZER_DISCARD enabled and GL_POINTS, one point per ball.
+//The rules match StressMode::step_balls() on the CPU:
+// integrate, bounce off the arc paddle and court walls, and send balls that reach
+// the center square back out from the far side of the court.
+struct BallSimProgram {
+	BallSimProgram();
+	~BallSimProgram();
+
+	GLuint program = 0;
+
+	//Attribute (per-vertex variable) locations:
+	GLuint Ball_vec4 = -1U;
+
+	//Uniform (per-invocation variable) locations:
+	GLuint STEP_float = -1U; //elapsed time * speed multiplier
+	GLuint COURT_RADIUS_vec2 = -1U;
+	GLuint BALL_RADIUS_vec2 = -1U;
+	GLuint PADDLE_THETA_float = -1U; //angle of the arc paddle's center
+};
@@ -0,0 +1,192 @@
+#include "BatchRenderer.hpp"
+
+#include "GLState.hpp"
+#include "gl_errors.hpp"
+
+//for glm::value_ptr() :
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+uint64_t BatchRenderer::submissions = 0;
+uint64_t BatchRenderer::draws = 0;
+
+//stable LSD radix sort on 'key', one byte at a time, skipping bytes that are the same in every key:
+static void radix_sort(std::vector< BatchRenderer::Item > &items, std::vector< BatchRenderer::Item > &scratch) {
+	scratch.resize(items.size());
+	for (uint32_t shift = 0; shift < 32; shift += 8) {
+		uint32_t counts[256] = { 0 };
+		for (auto const &item : items) {
+			counts[(item.key >> shift) & 0xff] += 1;
+		}
+		if (counts[(items[0].key >> shift) & 0xff] == items.size()) continue; //(nothing to reorder)
+
+		uint32_t offsets[256];
+		uint32_t total = 0;
+		for (uint32_t b = 0; b < 256; ++b) {
+			offsets[b] = total;
+			total += counts[b];
+		}
+		for (auto const &item : items) {
+			scratch[offsets[(item.key >> shift) & 0xff]++] = item;
+		}
+		items.swap(scratch);
+	}
+}
+
+BatchRenderer::BatchRenderer() {
+	vertex_buffer = GLResourcePool::get< GLBuffer >("batch vertices");
+	index_buffer = GLResourcePool::get< GLBuffer >("batch indices");
+	white_tex = GLResourcePool::get< Texture >("white 1x1", [](){
+		glm::uvec2 size = glm::uvec2(1, 1);
+		std::vector< glm::u8vec4 > data(size.x*size.y, glm::u8vec4(0xff, 0xff, 0xff, 0xff));
+		return Texture::upload(size, data, Texture::Options());
+	});
+	add_program(GLResourcePool::get< ColorTextureProgram >());
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+uint8_t BatchRenderer::add_program(std::shared_ptr< ColorTextureProgram > const &program) {
+	for (uint32_t p = 0; p < programs.size(); ++p) {
+		if (programs[p].program == program) return uint8_t(p);
+	}
+	if (programs.size() >= (1U << ProgramBits)) {
+		throw std::runtime_error("BatchRenderer supports at most 256 programs.");
+	}
+	programs.emplace_back();
+	programs.back().program = program;
+	programs.back().vertex_array = std::make_shared< GLVertexArray >(make_vertex_array< Vertex >(*program, vertex_buffer->name, index_buffer->name));
+	return uint8_t(programs.size() - 1);
+}
+
+void BatchRenderer::submit(uint8_t layer, GLuint texture, Blend blend, Vertex const *vertices_, uint32_t vertex_count, uint32_t const *indices_, uint32_t index_count, uint8_t program) {
+	if (index_count == 0) return;
+	if (program >= programs.size()) {
+		throw std::runtime_error("BatchRenderer: submission uses a program that wasn't added.");
+	}
+
+	//number this frame's textures in the order they show up:
+	if (texture == 0) texture = white_tex->tex;
+	auto f = texture_numbers.find(texture);
+	if (f == texture_numbers.end()) {
+		if (textures.size() >= (1U << TextureBits)) {
+			throw std::runtime_error("BatchRenderer: too many textures in one batch (flush more often).");
+		}
+		f = texture_numbers.emplace(texture, uint32_t(textures.size())).first;
+		textures.emplace_back(texture);
+	}
+
+	uint32_t base = uint32_t(vertices.size());
+	vertices.insert(vertices.end(), vertices_, vertices_ + vertex_count);
+
+	Submission submission;
+	submission.first_index = uint32_t(indices.size());
+	submission.index_count = index_count;
+	for (uint32_t i = 0; i < index_count; ++i) {
+		indices.emplace_back(base + indices_[i]);
+	}
+
+	items.emplace_back(Item{ make_key(layer, program, f->second, blend), uint32_t(batch.size()) });
+	batch.emplace_back(submission);
+}
+
+void BatchRenderer::rectangle(uint8_t layer, glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color, GLuint texture, Blend blend) {
+	Vertex corners[4] = {
+		Vertex(glm::vec3(center.x - radius.x, center.y - radius.y, 0.0f), color, glm::vec2(0.0f, 0.0f)),
+		Vertex(glm::vec3(center.x + radius.x, center.y - radius.y, 0.0f), color, glm::vec2(1.0f, 0.0f)),
+		Vertex(glm::vec3(center.x - radius.x, center.y + radius.y, 0.0f), color, glm::vec2(0.0f, 1.0f)),
+		Vertex(glm::vec3(center.x + radius.x, center.y + radius.y, 0.0f), color, glm::vec2(1.0f, 1.0f)),
+	};
+	static const uint32_t triangles[6] = { 0, 1, 2, 2, 1, 3 };
+	submit(layer, texture, blend, corners, 4, triangles, 6);
+}
+
+void BatchRenderer::flush(glm::mat4 const &object_to_clip) {
+	last_submissions = uint32_t(batch.size());
+	last_draws = 0;
+	if (batch.empty()) return;
+
+	radix_sort(items, scratch);
+
+	//lay out indices in sorted order, noting where each draw starts (runs that only differ by layer merge):
+	const uint32_t StateMask = (1U << (ProgramBits + TextureBits + BlendBits)) - 1;
+	draw_list.clear();
+	sorted_indices.clear();
+	sorted_indices.reserve(indices.size());
+	for (auto const &item : items) {
+		Submission const &submission = batch[item.submission];
+		if (draw_list.empty() || (draw_list.back().key & StateMask) != (item.key & StateMask)) {
+			draw_list.emplace_back(Draw{ item.key, uint32_t(sorted_indices.size()), 0 });
+		}
+		sorted_indices.insert(sorted_indices.end(), indices.begin() + submission.first_index, indices.begin() + submission.first_index + submission.index_count);
+		draw_list.back().count += submission.index_count;
+	}
+
+	//upload (orphaning last flush's storage):
+	GLState::bind_buffer(GL_ARRAY_BUFFER, vertex_buffer->name);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertices[0]), vertices.data(), GL_STREAM_DRAW);
+	//(the index buffer is every program's vertex array's element array buffer, so bind any of them to upload)
+	GLState::bind_vertex_array(programs[0].vertex_array->name);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sorted_indices.size() * sizeof(sorted_indices[0]), sorted_indices.data(), GL_STREAM_DRAW);
+
+	GLState::disable(GL_DEPTH_TEST);
+	//(modes leave restart on for their 16-bit strips; with 32-bit indices, vertex 65535 would otherwise restart)
+	GLState::disable(GL_PRIMITIVE_RESTART);
+	GLState::active_texture(GL_TEXTURE0);
+
+	matrix_set.assign(programs.size(), false);
+	for (auto const &draw : draw_list) {
+		uint32_t program = (draw.key >> (TextureBits + BlendBits)) & ((1U << ProgramBits) - 1);
+		uint32_t texture = (draw.key >> BlendBits) & ((1U << TextureBits) - 1);
+		Blend blend = Blend(draw.key & ((1U << BlendBits) - 1));
+
+		GLState::use_program(programs[program].program->program);
+		if (!matrix_set[program]) {
+			glUniformMatrix4fv(programs[program].program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(object_to_clip));
+			matrix_set[program] = true;
+		}
+		GLState::bind_vertex_array(programs[program].vertex_array->name);
+		GLState::bind_texture(GL_TEXTURE_2D, textures[texture]);
+
+		if (blend == Opaque) {
+			GLState::disable(GL_BLEND);
+		} else {
+			GLState::enable(GL_BLEND);
+			if (blend == Alpha) GLState::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			else if (blend == Additive) GLState::blend_func(GL_SRC_ALPHA, GL_ONE);
+			else GLState::blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		}
+
+		glDrawElements(GL_TRIANGLES, GLsizei(draw.count), GL_UNSIGNED_INT, (GLbyte *)0 + draw.first * sizeof(sorted_indices[0]));
+	}
+
+	last_draws = uint32_t(draw_list.size());
+	submissions += last_submissions;
+	draws += last_draws;
+
+	//start the next batch:
+	vertices.clear();
+	indices.clear();
+	batch.clear();
+	items.clear();
+	textures.clear();
+	texture_numbers.clear();
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+std::string BatchRenderer::stats(uint64_t frames) {
+	std::ostringstream out;
+	double per_frame = (frames ? 1.0 / double(frames) : 0.0);
+	out << std::fixed << std::setprecision(1)
+	    << "batches: " << (submissions * per_frame) << " submissions/frame in " << (draws * per_frame) << " draws/frame";
+	return out.str();
+}
+
+void BatchRenderer::reset_stats() {
+	submissions = 0;
+	draws = 0;
+}
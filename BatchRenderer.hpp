@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Vertex2D.hpp"
+#include "GLResourcePool.hpp"
+#include "Texture.hpp"
+
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * BatchRenderer collects 2D triangles (PosColTexVertex, drawn with a
+ *  ColorTextureProgram) from anywhere in a mode's draw(), then draws them
+ *  all with as few glDrawElements() calls as it can.
+ *
+ * Each submission has a sort key -- layer, program, texture, blend mode, from
+ *  most to least significant. flush() radix-sorts the submissions by key (stable, so
+ *  submissions with equal keys keep their order), and merges neighbors that
+ *  use the same program, texture, and blend mode into one draw, even across layers.
+ *
+ * Layers are the only ordering guarantee: within a layer, things that use
+ *  different programs / textures / blend modes may be drawn in any order.
+ *
+ * Usage (get it from GLResourcePool in load_step(), so modes share one):
+ *   batch = GLResourcePool::get< BatchRenderer >();
+ *   ...
+ *   batch->rectangle(0, center, radius, color);
+ *   batch->submit(1, texture, BatchRenderer::Additive, vertices, 4, indices, 6);
+ *   batch->flush(object_to_clip);
+ */
+
+struct BatchRenderer {
+	typedef PosColTexVertex Vertex;
+
+	enum Blend : uint8_t {
+		Opaque = 0,        //no blending
+		Alpha = 1,         //src * src.a + dst * (1 - src.a)
+		Additive = 2,      //src * src.a + dst
+		Premultiplied = 3, //src + dst * (1 - src.a)
+	};
+
+	BatchRenderer();
+	BatchRenderer(BatchRenderer const &) = delete;
+
+	//register another program (e.g., a ColorTextureProgram variant with a different fragment shader);
+	// returns its id for submit() (id 0 is the default ColorTextureProgram):
+	uint8_t add_program(std::shared_ptr< ColorTextureProgram > const &program);
+
+	//add triangles; 'indices' are relative to 'vertices'; texture 0 means solid white:
+	void submit(uint8_t layer, GLuint texture, Blend blend, Vertex const *vertices, uint32_t vertex_count, uint32_t const *indices, uint32_t index_count, uint8_t program = 0);
+
+	//add an axis-aligned rectangle:
+	void rectangle(uint8_t layer, glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color, GLuint texture = 0, Blend blend = Alpha);
+
+	//sort, upload, and draw everything submitted since the last flush():
+	void flush(glm::mat4 const &object_to_clip);
+
+	//----- statistics -----
+	uint32_t last_submissions = 0, last_draws = 0; //for the last flush()
+
+	//for all batches, since the last reset_stats():
+	static uint64_t submissions, draws;
+	static std::string stats(uint64_t frames);
+	static void reset_stats();
+
+	//sort key layout (most significant first):
+	static constexpr uint32_t LayerBits = 8, ProgramBits = 8, TextureBits = 12, BlendBits = 4;
+	static uint32_t make_key(uint8_t layer, uint8_t program, uint32_t texture, Blend blend) {
+		return (uint32_t(layer) << (ProgramBits + TextureBits + BlendBits))
+		     | (uint32_t(program) << (TextureBits + BlendBits))
+		     | (texture << BlendBits)
+		     | uint32_t(blend);
+	}
+
+	//(key + submission index; sorted by flush())
+	struct Item {
+		uint32_t key;
+		uint32_t submission;
+	};
+
+private:
+	struct Submission {
+		uint32_t first_index, index_count; //range in 'indices'
+	};
+	struct Program {
+		std::shared_ptr< ColorTextureProgram > program;
+		std::shared_ptr< GLVertexArray > vertex_array; //(reads vertex_buffer + index_buffer with this program's attribute locations)
+	};
+	struct Draw {
+		uint32_t key;
+		uint32_t first, count; //range in 'sorted_indices'
+	};
+
+	std::vector< Program > programs;
+	std::shared_ptr< GLBuffer > vertex_buffer, index_buffer;
+	std::shared_ptr< Texture > white_tex;
+
+	//this frame's submissions:
+	std::vector< Vertex > vertices;
+	std::vector< uint32_t > indices; //(already offset to index into 'vertices')
+	std::vector< Submission > batch;
+	std::vector< Item > items, scratch;
+	std::vector< GLuint > textures; //texture number in keys -> GL name
+	std::unordered_map< GLuint, uint32_t > texture_numbers;
+	std::vector< uint32_t > sorted_indices;
+	std::vector< Draw > draw_list;
+	std::vector< bool > matrix_set; //(per program, during flush())
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * BitWriter / BitReader pack unsigned values of any width (1-32 bits) back to back,
+ *  with no byte alignment, for compact snapshots and packets (see StateCodec.hpp).
+ *
+ * Bits go through a 64-bit accumulator and are stored little-endian, so a value
+ *  never costs more than a shift, a mask, and (every 32 bits) one 4-byte store.
+ *
+ * BitReader never reads past the end of its buffer: reads past the end return
+ *  zero bits and set 'overrun', so decoders can check once at the end.
+ */
+
+struct BitWriter {
+	std::vector< uint8_t > bytes;
+
+	//append the low 'bits' bits of 'value':
+	void write(uint32_t value, uint32_t bits) {
+		if (bits < 32) value &= (1U << bits) - 1U;
+		scratch |= uint64_t(value) << scratch_bits;
+		scratch_bits += bits;
+		if (scratch_bits >= 32) {
+			uint32_t word = uint32_t(scratch);
+			bytes.push_back(uint8_t(word));
+			bytes.push_back(uint8_t(word >> 8));
+			bytes.push_back(uint8_t(word >> 16));
+			bytes.push_back(uint8_t(word >> 24));
+			scratch >>= 32;
+			scratch_bits -= 32;
+		}
+	}
+	void write_bool(bool value) { write(value ? 1U : 0U, 1); }
+
+	//write out any partial byte (call once, after the last write()):
+	void flush() {
+		while (scratch_bits > 0) {
+			bytes.push_back(uint8_t(scratch));
+			scratch >>= 8;
+			scratch_bits = (scratch_bits > 8 ? scratch_bits - 8 : 0);
+		}
+		scratch = 0;
+	}
+
+	//start over (keeping the allocation):
+	void clear() {
+		bytes.clear();
+		scratch = 0;
+		scratch_bits = 0;
+	}
+
+	//bits written so far:
+	size_t bit_count() const { return bytes.size() * 8 + scratch_bits; }
+
+private:
+	uint64_t scratch = 0;
+	uint32_t scratch_bits = 0;
+};
+
+struct BitReader {
+	BitReader(uint8_t const *data_, size_t size_) : data(data_), size(size_) { }
+
+	uint32_t read(uint32_t bits) {
+		if (scratch_bits < bits) refill(bits);
+		uint32_t value = uint32_t(scratch & ((uint64_t(1) << bits) - 1U));
+		scratch >>= bits;
+		scratch_bits -= bits;
+		return value;
+	}
+	bool read_bool() { return read(1) != 0; }
+
+	uint8_t const *data;
+	size_t size;
+	size_t at = 0;
+	bool overrun = false;
+
+private:
+	void refill(uint32_t bits) {
+		if (at + 4 <= size) {
+			uint32_t word = uint32_t(data[at]) | (uint32_t(data[at+1]) << 8) | (uint32_t(data[at+2]) << 16) | (uint32_t(data[at+3]) << 24);
+			scratch |= uint64_t(word) << scratch_bits;
+			scratch_bits += 32;
+			at += 4;
+			return;
+		}
+		//near the end, a byte at a time:
+		while (scratch_bits < bits) {
+			uint64_t byte = 0;
+			if (at < size) byte = data[at];
+			else overrun = true;
+			at += 1;
+			scratch |= byte << scratch_bits;
+			scratch_bits += 8;
+		}
+	}
+	uint64_t scratch = 0;
+	uint32_t scratch_bits = 0;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "GL.hpp"
+
+//Shader program that draws transformed, vertex-colored vertices (no texture lookup):
+// (the untextured counterpart of ColorTextureProgram, used with the compact layouts in Vertex2D.hpp)
+struct ColorProgram {
+	ColorProgram();
+	~ColorProgram();
+
+	GLuint program = 0;
+
+	//Attribute (per-vertex variable) locations:
+	GLuint Position_vec4 = -1U;
+	GLuint Color_vec4 = -1U;
+
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+};
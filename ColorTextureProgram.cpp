@@ -2,6 +2,7 @@
 
 #include "gl_compile_program.hpp"
 #include "gl_errors.hpp"
+#include "GLState.hpp"
 
 ColorTextureProgram::ColorTextureProgram() {
 	//Compile vertex and fragment shaders using the convenient 'gl_compile_program' helper function:
@@ -43,14 +44,12 @@ ColorTextureProgram::ColorTextureProgram() {
 	GLuint TEX_sampler2D = glGetUniformLocation(program, "TEX");
 
 	//set TEX to always refer to texture binding zero:
-	glUseProgram(program); //bind program -- glUniform* calls refer to this program now
+	GLState::use_program(program); //bind program -- glUniform* calls refer to this program now
 
 	glUniform1i(TEX_sampler2D, 0); //set TEX to sample from GL_TEXTURE0
-
-	glUseProgram(0); //unbind program -- glUniform* calls refer to ??? now
 }
 
 ColorTextureProgram::~ColorTextureProgram() {
-	glDeleteProgram(program);
+	GLState::delete_program(program);
 	program = 0;
 }
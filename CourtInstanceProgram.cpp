@@ -0,0 +1,55 @@
+#include "CourtInstanceProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+#include "GLState.hpp"
+
+CourtInstanceProgram::CourtInstanceProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform mat4 OBJECT_TO_CLIP;\n"
+		"uniform vec2 TILE_STEP;\n"
+		"uniform int COLUMNS;\n"
+		"in vec2 Position;\n"
+		"in float Part;\n"
+		"in vec4 Color;\n"
+		"in vec4 State;\n"
+		"out vec4 color;\n"
+		"void main() {\n"
+		"	vec2 at = Position;\n"
+		"	if (Part == 1.0) at.y += State.x;\n"
+		"	else if (Part == 2.0) at.y += State.y;\n"
+		"	else if (Part == 3.0) at += State.zw;\n"
+		"	vec2 tile = vec2(gl_InstanceID % COLUMNS, gl_InstanceID / COLUMNS);\n"
+		"	gl_Position = OBJECT_TO_CLIP * vec4(at, 0.0, 1.0) + vec4(tile * TILE_STEP, 0.0, 0.0);\n"
+		"	color = Color;\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"in vec4 color;\n"
+		"out vec4 fragColor;\n"
+		"void main() {\n"
+		"	fragColor = color;\n"
+		"}\n"
+	);
+
+	//look up the locations of vertex attributes:
+	Position_vec2 = glGetAttribLocation(program, "Position");
+	Part_float = glGetAttribLocation(program, "Part");
+	Color_vec4 = glGetAttribLocation(program, "Color");
+	State_vec4 = glGetAttribLocation(program, "State");
+
+	//look up the locations of uniforms:
+	OBJECT_TO_CLIP_mat4 = glGetUniformLocation(program, "OBJECT_TO_CLIP");
+	TILE_STEP_vec2 = glGetUniformLocation(program, "TILE_STEP");
+	COLUMNS_int = glGetUniformLocation(program, "COLUMNS");
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+CourtInstanceProgram::~CourtInstanceProgram() {
+	GLState::delete_program(program);
+	program = 0;
+}
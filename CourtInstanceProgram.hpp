@@ -0,0 +1,29 @@
+#pragma once
+
+#include "GL.hpp"
+
+//Shader program that draws one whole Pong court per instance, tiled across the screen:
+// per-vertex Position is in court space, Part says which piece of the court the vertex belongs to
+// (0 = fixed, 1 = left paddle, 2 = right paddle, 3 = ball), and Color is its color;
+// per-instance State is (left paddle y, right paddle y, ball x, ball y).
+// Instance i is drawn in tile (i % COLUMNS, i / COLUMNS): OBJECT_TO_CLIP places tile (0,0)
+// and TILE_STEP is the clip-space offset from one tile to the next (x: columns, y: rows).
+struct CourtInstanceProgram {
+	CourtInstanceProgram();
+	~CourtInstanceProgram();
+
+	GLuint program = 0;
+
+	//Attribute (per-vertex variable) locations:
+	GLuint Position_vec2 = -1U;
+	GLuint Part_float = -1U;
+	GLuint Color_vec4 = -1U;
+
+	//Attribute (per-instance variable) locations:
+	GLuint State_vec4 = -1U;
+
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+	GLuint TILE_STEP_vec2 = -1U;
+	GLuint COLUMNS_int = -1U;
+};
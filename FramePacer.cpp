@@ -0,0 +1,87 @@
+#include "FramePacer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <thread>
+
+FramePacer::FramePacer(double target_hz_, bool spin_) : target_hz(target_hz_), spin(spin_) {
+	period = std::chrono::duration_cast< Clock::duration >(std::chrono::duration< double >(1.0 / target_hz));
+	spin_margin = std::chrono::microseconds(500);
+	deadline = last_return = Clock::now();
+	reset_stats();
+}
+
+void FramePacer::wait() {
+	Clock::time_point entered = Clock::now();
+
+	deadline += period;
+	//if the loop fell more than a frame behind, don't try to catch up with a burst of short frames:
+	if (entered > deadline + period) deadline = entered;
+
+	//sleep through most of the wait:
+	Clock::time_point wake = (spin ? deadline - spin_margin : deadline);
+	if (wake > entered) {
+		std::this_thread::sleep_until(wake);
+		Clock::time_point woke = Clock::now();
+		//adapt the margin to how much sleeps actually overshoot (jump up quickly, decay slowly):
+		Clock::duration overshoot = woke - wake;
+		if (overshoot > spin_margin) {
+			spin_margin = std::min< Clock::duration >(overshoot + overshoot / 4, period / 2);
+		} else {
+			spin_margin -= (spin_margin - overshoot) / 64;
+		}
+	}
+
+	//spin for the rest:
+	Clock::time_point spin_start = Clock::now();
+	if (spin) {
+		while (Clock::now() < deadline) {
+			std::this_thread::yield();
+		}
+	}
+
+	//----- statistics -----
+	Clock::time_point now = Clock::now();
+	double interval = std::chrono::duration< double >(now - last_return).count();
+	last_return = now;
+
+	frames += 1;
+	double delta = interval - interval_mean;
+	interval_mean += delta / frames;
+	interval_m2 += delta * (interval - interval_mean);
+	if (frames == 1) {
+		interval_min = interval_max = interval;
+	} else {
+		interval_min = std::min(interval_min, interval);
+		interval_max = std::max(interval_max, interval);
+	}
+	if (interval > 1.5 / target_hz) late_frames += 1;
+	waited += std::chrono::duration< double >(now - entered).count();
+	spun += std::chrono::duration< double >(now - spin_start).count();
+}
+
+std::string FramePacer::stats() const {
+	double elapsed = std::chrono::duration< double >(Clock::now() - stats_start).count();
+	double jitter = (frames > 1 ? std::sqrt(interval_m2 / (frames - 1)) : 0.0);
+	std::ostringstream str;
+	str.precision(3);
+	str << std::fixed;
+	str << frames << " frames at " << target_hz << " Hz target:"
+	    << " mean " << interval_mean * 1000.0 << " ms"
+	    << ", jitter " << jitter * 1000.0 << " ms"
+	    << ", range [" << interval_min * 1000.0 << ", " << interval_max * 1000.0 << "] ms"
+	    << ", " << late_frames << " late"
+	    << ", busy " << (elapsed > 0.0 ? 100.0 * (1.0 - (waited - spun) / elapsed) : 0.0) << "%"
+	    << " (spin margin " << std::chrono::duration< double, std::milli >(spin_margin).count() << " ms)";
+	return str.str();
+}
+
+void FramePacer::reset_stats() {
+	frames = 0;
+	interval_mean = interval_m2 = 0.0;
+	interval_min = interval_max = 0.0;
+	late_frames = 0;
+	waited = spun = 0.0;
+	stats_start = Clock::now();
+}
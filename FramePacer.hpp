@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/*
+ * FramePacer holds a loop to a target rate without vsync.
+ *
+ * Call wait() once per iteration (e.g., after swapping buffers). It sleeps until
+ *  shortly before the next frame's deadline, then spins for the remainder, since
+ *  OS sleeps routinely overshoot by a fraction of a millisecond. The spin margin
+ *  adapts to the worst oversleep recently observed.
+ *
+ * With spinning disabled (spin = false) the pacer only sleeps; frames may start a
+ *  little late, but the loop uses (close to) no CPU while waiting -- the right
+ *  choice for headless instances sharing a machine.
+ *
+ * FramePacer doesn't use SDL, so it works in programs without a window.
+ */
+
+struct FramePacer {
+	typedef std::chrono::steady_clock Clock;
+
+	FramePacer(double target_hz, bool spin = true);
+
+	//block until the next frame should start:
+	void wait();
+
+	double target_hz;
+	bool spin;
+
+	//----- statistics (since the last reset_stats()) -----
+	uint32_t frames = 0;
+	double interval_mean = 0.0; //seconds between wait() returns
+	double interval_m2 = 0.0; //(running sum of squared differences, for the variance)
+	double interval_min = 0.0, interval_max = 0.0;
+	uint32_t late_frames = 0; //frames that started more than half a period late
+	double waited = 0.0; //seconds spent inside wait() (sleeping or spinning)
+	double spun = 0.0; //seconds of that spent spinning
+
+	//one-line summary of the statistics ("frames / mean / jitter (standard deviation) / range / late / busy %"):
+	std::string stats() const;
+	void reset_stats();
+
+private:
+	Clock::duration period;
+	Clock::time_point deadline; //when the next frame should start
+	Clock::time_point last_return; //when wait() last returned
+	Clock::time_point stats_start;
+	Clock::duration spin_margin; //how long before the deadline to stop sleeping and start spinning
+};
@@ -0,0 +1,47 @@
+#include "GLResourcePool.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+uint32_t GLResourcePool::created = 0;
+uint32_t GLResourcePool::reused = 0;
+
+std::unordered_map< std::string, std::shared_ptr< void > > &GLResourcePool::resources() {
+	static std::unordered_map< std::string, std::shared_ptr< void > > resources;
+	return resources;
+}
+
+size_t GLResourcePool::release_unused() {
+	size_t released = 0;
+	//(some pooled objects hold handles to others -- e.g., MotionBlur's BatchRenderer -- so repeat until nothing more is freed)
+	size_t before = 0;
+	do {
+		before = released;
+		for (auto r = resources().begin(); r != resources().end(); ) {
+			if (r->second.use_count() == 1) {
+				r = resources().erase(r);
+				released += 1;
+			} else {
+				++r;
+			}
+		}
+	} while (released != before);
+	return released;
+}
+
+void GLResourcePool::clear() {
+	resources().clear();
+}
+
+std::shared_ptr< GLBuffer > square_corners_buffer() {
+	return GLResourcePool::get< GLBuffer >("square corners", [](){
+		auto buffer = std::make_shared< GLBuffer >();
+		std::vector< glm::vec2 > corners = {
+			glm::vec2(-1.0f,-1.0f), glm::vec2( 1.0f,-1.0f), glm::vec2(-1.0f, 1.0f), glm::vec2( 1.0f, 1.0f)
+		};
+		GLState::bind_buffer(GL_ARRAY_BUFFER, buffer->name);
+		glBufferData(GL_ARRAY_BUFFER, corners.size() * sizeof(corners[0]), corners.data(), GL_STATIC_DRAW);
+		return buffer;
+	});
+}
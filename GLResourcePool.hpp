@@ -0,0 +1,79 @@
+#pragma once
+
+#include "GL.hpp"
+#include "GLState.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+
+/*
+ * GLResourcePool keeps GL objects (programs, buffers, vertex arrays, textures)
+ *  alive across Mode switches, so a new Mode reuses already-compiled programs and
+ *  already-allocated buffers instead of rebuilding everything in its constructor.
+ *
+ * Objects are looked up by type + description; the first get() creates the object,
+ *  later get()s with the same description return it. Handles are std::shared_ptr's,
+ *  so the pool can tell which objects are no longer used by anyone: release_unused() frees
+ *  them, and Mode calls it after every switch (once the new mode holds what it needs).
+ *
+ * Usage:
+ *   program = GLResourcePool::get< ColorProgram >();
+ *   white_tex = GLResourcePool::get< Texture >("white 1x1", [](){ return Texture::upload(...); });
+ *
+ * NOTE: objects that refer to each other by GL name (e.g., a vertex array and the buffers it
+ *  reads) should be held together; call GLResourcePool::clear() before destroying the GL context.
+ */
+
+//Owning wrappers for GL names that don't have a helper class of their own:
+struct GLBuffer {
+	GLBuffer() { glGenBuffers(1, &name); }
+	~GLBuffer() { GLState::delete_buffers(1, &name); }
+	GLBuffer(GLBuffer const &) = delete;
+	GLBuffer &operator=(GLBuffer const &) = delete;
+	GLuint name = 0;
+};
+
+struct GLVertexArray {
+	GLVertexArray(GLuint name_) : name(name_) { } //takes ownership of an existing vertex array
+	~GLVertexArray() { GLState::delete_vertex_arrays(1, &name); }
+	GLVertexArray(GLVertexArray const &) = delete;
+	GLVertexArray &operator=(GLVertexArray const &) = delete;
+	GLuint name = 0;
+};
+
+struct GLResourcePool {
+	//fetch the object of type T with the given description, calling 'make' to create it if needed:
+	template< typename T >
+	static std::shared_ptr< T > get(std::string const &description = "", std::function< std::shared_ptr< T >() > const &make = [](){ return std::make_shared< T >(); }) {
+		std::string key = std::string(typeid(T).name()) + ":" + description;
+		auto f = resources().find(key);
+		if (f != resources().end()) {
+			reused += 1;
+			return std::static_pointer_cast< T >(f->second);
+		}
+		std::shared_ptr< T > made = make();
+		resources().emplace(key, made);
+		created += 1;
+		return made;
+	}
+
+	//free every object that only the pool is holding; returns the number freed:
+	static size_t release_unused();
+
+	//free everything (outstanding handles keep their objects until they are dropped):
+	static void clear();
+
+	//counts of get() calls that created an object vs. returned an existing one:
+	static uint32_t created;
+	static uint32_t reused;
+
+private:
+	static std::unordered_map< std::string, std::shared_ptr< void > > &resources();
+};
+
+//the pooled "square corners" buffer -- [-1,1]^2 as a four-vertex triangle strip of vec2's,
+// shared by everything that draws instanced quads (ShapeProgram, BallInstanceProgram, BallBlurProgram):
+std::shared_ptr< GLBuffer > square_corners_buffer();
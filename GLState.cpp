@@ -0,0 +1,305 @@
+#include "GLState.hpp"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+uint32_t GLState::frame_calls = 0;
+uint32_t GLState::frame_skipped = 0;
+uint32_t GLState::last_frame_calls = 0;
+uint32_t GLState::last_frame_skipped = 0;
+uint64_t GLState::frames = 0;
+uint64_t GLState::calls = 0;
+uint64_t GLState::skipped = 0;
+uint64_t GLState::mismatches = 0;
+bool GLState::validate = false;
+
+namespace {
+	//marks a cached name / enum that isn't known:
+	const GLuint Unknown = ~0U;
+
+	//capabilities that are tracked (others pass straight through):
+	const GLenum Caps[] = { GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST, GL_PRIMITIVE_RESTART, GL_RASTERIZER_DISCARD };
+	const uint32_t CapCount = sizeof(Caps) / sizeof(Caps[0]);
+
+	//buffer targets that are tracked, and the queries for their bindings:
+	const GLenum BufferTargets[] = { GL_ARRAY_BUFFER, GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER, GL_UNIFORM_BUFFER };
+	const GLenum BufferBindings[] = { GL_ARRAY_BUFFER_BINDING, GL_PIXEL_PACK_BUFFER_BINDING, GL_PIXEL_UNPACK_BUFFER_BINDING, GL_UNIFORM_BUFFER_BINDING };
+	const uint32_t BufferTargetCount = sizeof(BufferTargets) / sizeof(BufferTargets[0]);
+
+	//texture units whose GL_TEXTURE_2D binding is tracked (GL 3.3 guarantees at least 48 units; nothing here uses more than one):
+	const uint32_t TextureUnits = 16;
+
+	struct Cache {
+		Cache() { forget(); }
+		void forget() {
+			for (auto &cap : caps) cap = Unknown;
+			blend_src = blend_dst = Unknown;
+			clear_known = false;
+			restart_known = false;
+			program = Unknown;
+			vertex_array = Unknown;
+			for (auto &buffer : buffers) buffer = Unknown;
+			active_unit = Unknown;
+			for (auto &texture : texture_2d) texture = Unknown;
+		}
+		GLuint caps[CapCount]; //GL_TRUE, GL_FALSE, or Unknown
+		GLenum blend_src, blend_dst;
+		bool clear_known;
+		float clear[4];
+		bool restart_known;
+		GLuint restart_index;
+		GLuint program;
+		GLuint vertex_array;
+		GLuint buffers[BufferTargetCount];
+		GLenum active_unit; //GL_TEXTURE0 + i
+		GLuint texture_2d[TextureUnits];
+	};
+	Cache cache;
+
+	int32_t find(GLenum const *list, uint32_t count, GLenum value) {
+		for (uint32_t i = 0; i < count; ++i) {
+			if (list[i] == value) return int32_t(i);
+		}
+		return -1;
+	}
+
+	GLuint get_integer(GLenum pname) {
+		GLint value = 0;
+		glGetIntegerv(pname, &value);
+		return GLuint(value);
+	}
+
+	//compare a known cached value with GL's; on a mismatch, warn and return true:
+	bool differs(char const *what, GLenum which, GLuint cached, GLuint actual) {
+		if (cached == Unknown || cached == actual) return false;
+		std::cerr << "WARNING: GLState thinks " << what << " 0x" << std::hex << which << " is 0x" << cached
+		          << ", but GL has 0x" << actual << std::dec << " (changed without going through GLState?)" << std::endl;
+		GLState::mismatches += 1;
+		return true;
+	}
+
+	//count a call as made or skipped; returns true if it should be made:
+	bool needed(bool changes) {
+		if (changes) GLState::frame_calls += 1;
+		else GLState::frame_skipped += 1;
+		return changes;
+	}
+
+	void set_cap(GLenum cap, GLuint on) {
+		int32_t c = find(Caps, CapCount, cap);
+		if (c >= 0) {
+			if (GLState::validate && differs("capability", cap, cache.caps[c], glIsEnabled(cap))) cache.caps[c] = Unknown;
+			if (!needed(cache.caps[c] != on)) return;
+			cache.caps[c] = on;
+		} else {
+			needed(true);
+		}
+		if (on == GL_TRUE) glEnable(cap);
+		else glDisable(cap);
+	}
+}
+
+void GLState::enable(GLenum cap) {
+	set_cap(cap, GL_TRUE);
+}
+
+void GLState::disable(GLenum cap) {
+	set_cap(cap, GL_FALSE);
+}
+
+void GLState::blend_func(GLenum sfactor, GLenum dfactor) {
+	if (validate) {
+		if (differs("blend src", GL_BLEND_SRC_RGB, cache.blend_src, get_integer(GL_BLEND_SRC_RGB))
+		 || differs("blend dst", GL_BLEND_DST_RGB, cache.blend_dst, get_integer(GL_BLEND_DST_RGB))) {
+			cache.blend_src = cache.blend_dst = Unknown;
+		}
+	}
+	if (!needed(cache.blend_src != sfactor || cache.blend_dst != dfactor)) return;
+	cache.blend_src = sfactor;
+	cache.blend_dst = dfactor;
+	glBlendFunc(sfactor, dfactor);
+}
+
+void GLState::clear_color(float r, float g, float b, float a) {
+	float color[4] = { r, g, b, a };
+	if (validate && cache.clear_known) {
+		float actual[4];
+		glGetFloatv(GL_COLOR_CLEAR_VALUE, actual);
+		for (uint32_t i = 0; i < 4; ++i) {
+			if (std::abs(actual[i] - cache.clear[i]) > 1.0f / 1024.0f) {
+				std::cerr << "WARNING: GLState's clear color doesn't match GL's (changed without going through GLState?)" << std::endl;
+				mismatches += 1;
+				cache.clear_known = false;
+				break;
+			}
+		}
+	}
+	bool same = cache.clear_known;
+	for (uint32_t i = 0; i < 4 && same; ++i) same = (cache.clear[i] == color[i]);
+	if (!needed(!same)) return;
+	cache.clear_known = true;
+	for (uint32_t i = 0; i < 4; ++i) cache.clear[i] = color[i];
+	glClearColor(r, g, b, a);
+}
+
+void GLState::primitive_restart_index(GLuint index) {
+	if (validate && cache.restart_known && differs("primitive restart index", GL_PRIMITIVE_RESTART_INDEX, cache.restart_index, get_integer(GL_PRIMITIVE_RESTART_INDEX))) {
+		cache.restart_known = false;
+	}
+	if (!needed(!cache.restart_known || cache.restart_index != index)) return;
+	cache.restart_known = true;
+	cache.restart_index = index;
+	glPrimitiveRestartIndex(index);
+}
+
+void GLState::use_program(GLuint program) {
+	if (validate && differs("binding", GL_CURRENT_PROGRAM, cache.program, get_integer(GL_CURRENT_PROGRAM))) cache.program = Unknown;
+	if (!needed(cache.program != program)) return;
+	cache.program = program;
+	glUseProgram(program);
+}
+
+void GLState::bind_vertex_array(GLuint vertex_array) {
+	if (validate && differs("binding", GL_VERTEX_ARRAY_BINDING, cache.vertex_array, get_integer(GL_VERTEX_ARRAY_BINDING))) cache.vertex_array = Unknown;
+	if (!needed(cache.vertex_array != vertex_array)) return;
+	cache.vertex_array = vertex_array;
+	glBindVertexArray(vertex_array);
+}
+
+void GLState::bind_buffer(GLenum target, GLuint buffer) {
+	int32_t t = find(BufferTargets, BufferTargetCount, target);
+	if (t >= 0) {
+		if (validate && differs("binding", BufferBindings[t], cache.buffers[t], get_integer(BufferBindings[t]))) cache.buffers[t] = Unknown;
+		if (!needed(cache.buffers[t] != buffer)) return;
+		cache.buffers[t] = buffer;
+	} else {
+		needed(true);
+	}
+	glBindBuffer(target, buffer);
+}
+
+void GLState::active_texture(GLenum unit) {
+	if (validate && differs("binding", GL_ACTIVE_TEXTURE, cache.active_unit, get_integer(GL_ACTIVE_TEXTURE))) cache.active_unit = Unknown;
+	if (!needed(cache.active_unit != unit)) return;
+	cache.active_unit = unit;
+	glActiveTexture(unit);
+}
+
+void GLState::bind_texture(GLenum target, GLuint texture) {
+	uint32_t unit = cache.active_unit - GL_TEXTURE0;
+	if (target == GL_TEXTURE_2D && cache.active_unit != Unknown && unit < TextureUnits) {
+		GLuint &cached = cache.texture_2d[unit];
+		if (validate && differs("binding", GL_TEXTURE_BINDING_2D, cached, get_integer(GL_TEXTURE_BINDING_2D))) cached = Unknown;
+		if (!needed(cached != texture)) return;
+		cached = texture;
+	} else {
+		needed(true);
+		//(binding on an unknown unit could have changed any of them)
+		if (target == GL_TEXTURE_2D && cache.active_unit == Unknown) {
+			for (auto &cached : cache.texture_2d) cached = Unknown;
+		}
+	}
+	glBindTexture(target, texture);
+}
+
+void GLState::delete_program(GLuint program) {
+	//(a deleted program stays in use until another one replaces it, and its name isn't reused until then)
+	needed(true);
+	glDeleteProgram(program);
+}
+
+void GLState::delete_vertex_arrays(GLsizei count, GLuint const *vertex_arrays) {
+	//deleting a bound object reverts its bindings to 0:
+	for (GLsizei i = 0; i < count; ++i) {
+		if (vertex_arrays[i] != 0 && cache.vertex_array == vertex_arrays[i]) cache.vertex_array = 0;
+	}
+	needed(true);
+	glDeleteVertexArrays(count, vertex_arrays);
+}
+
+void GLState::delete_buffers(GLsizei count, GLuint const *buffers) {
+	for (GLsizei i = 0; i < count; ++i) {
+		if (buffers[i] == 0) continue;
+		for (auto &cached : cache.buffers) {
+			if (cached == buffers[i]) cached = 0;
+		}
+	}
+	needed(true);
+	glDeleteBuffers(count, buffers);
+}
+
+void GLState::delete_textures(GLsizei count, GLuint const *textures) {
+	for (GLsizei i = 0; i < count; ++i) {
+		if (textures[i] == 0) continue;
+		for (auto &cached : cache.texture_2d) {
+			if (cached == textures[i]) cached = 0;
+		}
+	}
+	needed(true);
+	glDeleteTextures(count, textures);
+}
+
+void GLState::invalidate() {
+	cache.forget();
+}
+
+uint32_t GLState::check(char const *where) {
+	uint64_t before = mismatches;
+	for (uint32_t c = 0; c < CapCount; ++c) {
+		if (differs("capability", Caps[c], cache.caps[c], glIsEnabled(Caps[c]))) cache.caps[c] = Unknown;
+	}
+	if (differs("blend src", GL_BLEND_SRC_RGB, cache.blend_src, get_integer(GL_BLEND_SRC_RGB))
+	 || differs("blend dst", GL_BLEND_DST_RGB, cache.blend_dst, get_integer(GL_BLEND_DST_RGB))) {
+		cache.blend_src = cache.blend_dst = Unknown;
+	}
+	if (cache.restart_known && differs("primitive restart index", GL_PRIMITIVE_RESTART_INDEX, cache.restart_index, get_integer(GL_PRIMITIVE_RESTART_INDEX))) {
+		cache.restart_known = false;
+	}
+	if (differs("binding", GL_CURRENT_PROGRAM, cache.program, get_integer(GL_CURRENT_PROGRAM))) cache.program = Unknown;
+	if (differs("binding", GL_VERTEX_ARRAY_BINDING, cache.vertex_array, get_integer(GL_VERTEX_ARRAY_BINDING))) cache.vertex_array = Unknown;
+	for (uint32_t t = 0; t < BufferTargetCount; ++t) {
+		if (differs("binding", BufferBindings[t], cache.buffers[t], get_integer(BufferBindings[t]))) cache.buffers[t] = Unknown;
+	}
+	GLenum active = get_integer(GL_ACTIVE_TEXTURE);
+	if (differs("binding", GL_ACTIVE_TEXTURE, cache.active_unit, active)) cache.active_unit = Unknown;
+	for (uint32_t u = 0; u < TextureUnits; ++u) {
+		if (cache.texture_2d[u] == Unknown) continue;
+		glActiveTexture(GL_TEXTURE0 + u);
+		if (differs("binding", GL_TEXTURE_BINDING_2D, cache.texture_2d[u], get_integer(GL_TEXTURE_BINDING_2D))) cache.texture_2d[u] = Unknown;
+	}
+	glActiveTexture(active);
+
+	uint32_t found = uint32_t(mismatches - before);
+	if (found) std::cerr << "  (" << found << " GLState mismatches found at " << where << ")" << std::endl;
+	return found;
+}
+
+void GLState::end_frame() {
+	if (validate) check("end of frame");
+	last_frame_calls = frame_calls;
+	last_frame_skipped = frame_skipped;
+	frames += 1;
+	calls += frame_calls;
+	skipped += frame_skipped;
+	frame_calls = 0;
+	frame_skipped = 0;
+}
+
+std::string GLState::stats() {
+	std::ostringstream out;
+	double per_frame = (frames ? 1.0 / double(frames) : 0.0);
+	out << std::fixed << std::setprecision(1)
+	    << "GL state: " << (calls * per_frame) << " calls/frame, " << (skipped * per_frame) << " skipped/frame"
+	    << " (" << (calls + skipped ? 100.0 * skipped / double(calls + skipped) : 0.0) << "% redundant) over " << frames << " frames";
+	if (validate) out << "; " << mismatches << " cache mismatches";
+	return out.str();
+}
+
+void GLState::reset_stats() {
+	frames = 0;
+	calls = 0;
+	skipped = 0;
+	mismatches = 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "GL.hpp"
+
+#include <cstdint>
+#include <string>
+
+/*
+ * GLState remembers the GL state it has set (capabilities, blend function,
+ *  program, vertex array, buffer and texture bindings, ...) and skips calls
+ *  that wouldn't change anything.
+ *
+ * Draw code sets the state it needs and leaves it set -- no unbinding to 0 when
+ *  done -- so in a frame that looks like the last one, most state calls are skipped.
+ *  That only works if every change to this state goes through GLState (or is
+ *  followed by invalidate()), including deleting objects that may be bound.
+ *
+ * State starts out unknown, so the first call for each piece is always made.
+ *
+ * GL_ELEMENT_ARRAY_BUFFER is part of the bound vertex array's state, so binding
+ *  it always passes through; likewise capabilities, buffer targets, and texture
+ *  targets that aren't tracked (see GLState.cpp).
+ *
+ * With 'validate' set, every call also reads the real GL state (slow: glGet*
+ *  waits for the driver) and prints a warning wherever the cache disagrees.
+ */
+
+struct GLState {
+	static void enable(GLenum cap);
+	static void disable(GLenum cap);
+	static void blend_func(GLenum sfactor, GLenum dfactor);
+	static void clear_color(float r, float g, float b, float a);
+	static void primitive_restart_index(GLuint index);
+
+	static void use_program(GLuint program);
+	static void bind_vertex_array(GLuint vertex_array);
+	static void bind_buffer(GLenum target, GLuint buffer);
+	static void active_texture(GLenum unit);
+	static void bind_texture(GLenum target, GLuint texture);
+
+	//delete objects (and forget any bindings of them):
+	static void delete_program(GLuint program);
+	static void delete_vertex_arrays(GLsizei count, GLuint const *vertex_arrays);
+	static void delete_buffers(GLsizei count, GLuint const *buffers);
+	static void delete_textures(GLsizei count, GLuint const *textures);
+
+	//forget everything (e.g., after code that changes GL state directly):
+	static void invalidate();
+
+	//check the whole cache against GL (done every frame when validating); returns the number of mismatches:
+	static uint32_t check(char const *where);
+
+	//----- statistics -----
+	//call once per frame (after drawing) to tally the frame's calls:
+	static void end_frame();
+
+	static uint32_t frame_calls, frame_skipped; //this frame so far
+	static uint32_t last_frame_calls, last_frame_skipped; //the last finished frame
+
+	//since the last reset_stats():
+	static uint64_t frames, calls, skipped, mismatches;
+	static std::string stats();
+	static void reset_stats();
+
+	static bool validate;
+};
@@ -0,0 +1,62 @@
+#include "Input.hpp"
+
+bool Input::late_latch = false;
+uint64_t Input::latched_at = 0;
+
+glm::ivec2 Input::latch_mouse() {
+	//(pumped events stay queued, so they are still seen by next frame's poll())
+	SDL_PumpEvents();
+	int x, y;
+	SDL_GetMouseState(&x, &y);
+	latched_at = SDL_GetPerformanceCounter();
+	return glm::ivec2(x, y);
+}
+
+void Input::poll() {
+	events.clear();
+	mouse_motion = glm::ivec2(0);
+	mouse_moved = false;
+	raw_events = 0;
+
+	//fetch events from SDL's queue in chunks (one call per chunk rather than one per event):
+	SDL_PumpEvents();
+	polled_at = SDL_GetPerformanceCounter();
+	SDL_Event chunk[64];
+	while (true) {
+		int count = SDL_PeepEvents(chunk, 64, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+		if (count <= 0) break;
+		raw_events += uint32_t(count);
+
+		for (int i = 0; i < count; ++i) {
+			SDL_Event const &evt = chunk[i];
+			if (evt.type == SDL_MOUSEMOTION) {
+				mouse = glm::ivec2(evt.motion.x, evt.motion.y);
+				mouse_motion += glm::ivec2(evt.motion.xrel, evt.motion.yrel);
+				mouse_buttons = evt.motion.state;
+				mouse_moved = true;
+				newest_motion_ticks = evt.motion.timestamp;
+				//merge with the previous event if it was also motion (from the same mouse):
+				if (!events.empty() && events.back().type == SDL_MOUSEMOTION && events.back().motion.which == evt.motion.which) {
+					SDL_MouseMotionEvent &prev = events.back().motion;
+					prev.timestamp = evt.motion.timestamp;
+					prev.state = evt.motion.state;
+					prev.x = evt.motion.x;
+					prev.y = evt.motion.y;
+					prev.xrel += evt.motion.xrel;
+					prev.yrel += evt.motion.yrel;
+					continue;
+				}
+			} else if (evt.type == SDL_MOUSEBUTTONDOWN) {
+				mouse_buttons |= SDL_BUTTON(evt.button.button);
+			} else if (evt.type == SDL_MOUSEBUTTONUP) {
+				mouse_buttons &= ~SDL_BUTTON(evt.button.button);
+			}
+			events.emplace_back(evt);
+		}
+
+		if (count < 64) break;
+	}
+
+	total_raw_events += raw_events;
+	total_dispatched_events += events.size();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SDL.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/*
+ * Input collects one frame's worth of SDL events at a time.
+ *
+ * High-polling-rate mice can queue dozens of SDL_MOUSEMOTION events per frame;
+ * only the last position matters to the modes, so runs of motion events are
+ * merged into one (relative motion is summed) before anything is dispatched.
+ *
+ * Modes see the (shorter) event list through Mode::handle_event, and the
+ * frame's resulting mouse state through Mode::handle_input.
+ */
+
+struct Input {
+	//drain all pending SDL events into 'events' (replacing last frame's batch):
+	void poll();
+
+	//this frame's events, in order, with runs of mouse motion merged:
+	std::vector< SDL_Event > events;
+
+	//----- snapshot of input state after this frame's events -----
+	glm::ivec2 mouse = glm::ivec2(0); //mouse position (window pixels, top-left origin, +y is down)
+	glm::ivec2 mouse_motion = glm::ivec2(0); //total relative motion this frame
+	bool mouse_moved = false; //did any motion events arrive this frame?
+	uint32_t mouse_buttons = 0; //SDL_BUTTON() mask
+
+	//----- latency measurement -----
+	uint64_t polled_at = 0; //SDL_GetPerformanceCounter() when poll() read the queue
+	uint32_t newest_motion_ticks = 0; //SDL timestamp (ms) of the newest motion event, ever
+
+	//----- late latching -----
+	//when set, modes re-read the mouse just before drawing instead of using the (up to a frame old) snapshot:
+	static bool late_latch;
+	//read the mouse position from SDL right now (pumping the OS queue first) and note when:
+	static glm::ivec2 latch_mouse();
+	static uint64_t latched_at; //SDL_GetPerformanceCounter() of the most recent latch_mouse()
+
+	//----- counters (useful for checking how much merging is going on) -----
+	uint32_t raw_events = 0; //events received from SDL this frame
+	uint64_t total_raw_events = 0; //...and since startup
+	uint64_t total_dispatched_events = 0; //events left after merging, since startup
+};
@@ -1,8 +1,100 @@
 #include "Mode.hpp"
 
+#include "GLResourcePool.hpp"
+
 std::shared_ptr< Mode > Mode::current;
+std::vector< std::shared_ptr< Mode > > Mode::overlays;
+std::shared_ptr< Mode > Mode::pending;
+std::future< void > Mode::pending_prepared;
+glm::uvec2 Mode::window_size = glm::uvec2(0);
+glm::uvec2 Mode::drawable_size = glm::uvec2(0);
+
+//finish preparing + loading a mode right now:
+static void load_now(Mode &mode) {
+	if (mode.loaded) return;
+	mode.prepare();
+	while (!mode.load_step()) { }
+	mode.loaded = true;
+}
 
 void Mode::set_current(std::shared_ptr< Mode > const &new_current) {
+	//a direct switch replaces any in-progress asynchronous one:
+	if (pending_prepared.valid()) pending_prepared.wait();
+	pending_prepared = std::future< void >();
+	pending.reset();
+
+	if (new_current) {
+		load_now(*new_current);
+		new_current->on_resize(window_size, drawable_size);
+	}
 	current = new_current;
-	//NOTE: may wish to, e.g., trigger resize events on new current mode.
+	overlays.clear();
+
+	//free GL resources that only the old mode was using:
+	GLResourcePool::release_unused();
+}
+
+void Mode::push(std::shared_ptr< Mode > const &overlay) {
+	load_now(*overlay);
+	overlay->on_resize(window_size, drawable_size);
+	overlays.emplace_back(overlay);
+}
+
+void Mode::pop() {
+	if (!overlays.empty()) overlays.pop_back();
+}
+
+void Mode::set_current_async(std::shared_ptr< Mode > const &next) {
+	if (pending_prepared.valid()) pending_prepared.wait();
+	pending = next;
+	if (next->loaded) {
+		pending_prepared = std::future< void >();
+	} else {
+		//the lambda holds its own reference, so the mode outlives the worker even if 'pending' is replaced:
+		std::shared_ptr< Mode > mode = next;
+		pending_prepared = std::async(std::launch::async, [mode](){ mode->prepare(); });
+	}
+}
+
+void Mode::advance_loading() {
+	if (!pending) return;
+
+	//wait (without blocking) for the worker thread to finish prepare():
+	if (pending_prepared.valid()) {
+		if (pending_prepared.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+		pending_prepared.get(); //re-throws anything prepare() threw
+	}
+
+	//one load step per frame:
+	if (!pending->loaded) {
+		if (!pending->load_step()) return;
+		pending->loaded = true;
+	}
+
+	//loaded -- swap it in:
+	std::shared_ptr< Mode > next = pending;
+	pending.reset();
+	next->on_resize(window_size, drawable_size);
+	current = next;
+	overlays.clear();
+
+	//free GL resources that only the old mode was using:
+	GLResourcePool::release_unused();
+}
+
+bool Mode::paused() const {
+	//(matches the main loop: walk down from the topmost overlay until reaching this mode)
+	for (auto o = overlays.rbegin(); o != overlays.rend() && o->get() != this; ++o) {
+		if ((*o)->pauses_below()) return true;
+	}
+	return false;
+}
+
+void Mode::set_window_size(glm::uvec2 const &window_size_, glm::uvec2 const &drawable_size_) {
+	window_size = window_size_;
+	drawable_size = drawable_size_;
+	if (current) current->on_resize(window_size, drawable_size);
+	for (auto const &overlay : overlays) {
+		overlay->on_resize(window_size, drawable_size);
+	}
 }
@@ -1,9 +1,13 @@
 #pragma once
 
+#include "Input.hpp"
+
 #include <SDL.h>
 #include <glm/glm.hpp>
 
+#include <future>
 #include <memory>
+#include <vector>
 
 struct Mode : std::enable_shared_from_this< Mode > {
 	virtual ~Mode() { }
@@ -13,6 +17,10 @@ struct Mode : std::enable_shared_from_this< Mode > {
 	//The function should return 'true' if it handled the event.
 	virtual bool handle_event(SDL_Event const &, glm::uvec2 const &window_size) { return false; }
 
+	//handle_input is called once per frame, after handle_event, with the input state the frame's events left behind:
+	// (use this for continuous things like mouse position, so work isn't repeated for every motion event)
+	virtual void handle_input(Input const &, glm::uvec2 const &window_size) { }
+
 	//update is called at the start of a new frame, after events are handled:
 	// 'elapsed' is time in seconds since the last call to 'update'
 	virtual void update(float elapsed) { }
@@ -20,9 +28,47 @@ struct Mode : std::enable_shared_from_this< Mode > {
 	//draw is called after update:
 	virtual void draw(glm::uvec2 const &drawable_size) = 0;
 
+	//on_resize is called when the mode is shown and whenever the window changes size:
+	virtual void on_resize(glm::uvec2 const &window_size, glm::uvec2 const &drawable_size) { }
+
+	//----- loading -----
+	//Modes can split their setup so that showing them never produces a long frame:
+	// prepare() runs once, on a worker thread, for CPU-side work (no GL calls!)
+	// load_step() then runs on the main thread until it returns true, doing a bit of GL setup per call
+	//(set_current() and push() run both to completion immediately; set_current_async() spreads them over frames)
+	virtual void prepare() { }
+	virtual bool load_step() { return true; }
+	bool loaded = false; //set once prepare() and load_step() are done
+
+	//----- overlays -----
+	//an overlay that returns true here stops the modes below it from being updated (e.g., a pause screen):
+	virtual bool pauses_below() const { return false; }
+	//true when an overlay above this mode pauses it (it is still drawn, but gets no input or updates):
+	bool paused() const;
+
 	//Mode::current is the Mode to which events are dispatched.
 	// use 'set_current' to change the current Mode (e.g., to switch to a menu)
+	// (this also removes any overlays)
 	static std::shared_ptr< Mode > current;
 	static void set_current(std::shared_ptr< Mode > const &);
-};
 
+	//Mode::overlays are drawn (in order) on top of Mode::current, and get first pick of events (last first):
+	// use 'push' and 'pop' to show and hide them
+	static std::vector< std::shared_ptr< Mode > > overlays;
+	static void push(std::shared_ptr< Mode > const &);
+	static void pop();
+
+	//switch to 'next' without stalling: 'next' is prepared on a worker thread and loaded over
+	// the following frames (while the current mode keeps running), then becomes current:
+	static void set_current_async(std::shared_ptr< Mode > const &next);
+	static std::shared_ptr< Mode > pending;
+	static std::future< void > pending_prepared;
+
+	//called by the main loop once per frame to advance any asynchronous switch:
+	static void advance_loading();
+
+	//called by the main loop when the window changes size (and once at startup):
+	static void set_window_size(glm::uvec2 const &window_size, glm::uvec2 const &drawable_size);
+	static glm::uvec2 window_size;
+	static glm::uvec2 drawable_size;
+};
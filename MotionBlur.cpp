@@ -0,0 +1,98 @@
+#include "MotionBlur.hpp"
+
+#include "GLState.hpp"
+#include "gl_errors.hpp"
+
+//for glm::value_ptr() :
+#include <glm/gtc/type_ptr.hpp>
+
+#include <stdexcept>
+
+MotionBlur::MotionBlur() {
+	program = GLResourcePool::get< BallBlurProgram >();
+	corner_buffer = square_corners_buffer();
+	ball_buffer = GLResourcePool::get< GLBuffer >("blurred balls");
+
+	GLuint vertex_array = 0;
+	glGenVertexArrays(1, &vertex_array);
+	GLState::bind_vertex_array(vertex_array);
+	GLState::bind_buffer(GL_ARRAY_BUFFER, corner_buffer->name);
+	glVertexAttribPointer(program->Corner_vec2, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (GLbyte *)0);
+	glEnableVertexAttribArray(program->Corner_vec2);
+	GLState::bind_buffer(GL_ARRAY_BUFFER, ball_buffer->name);
+	glVertexAttribPointer(program->Ball_vec4, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (GLbyte *)0);
+	glEnableVertexAttribArray(program->Ball_vec4);
+	//advance Ball once per instance (streak) instead of once per vertex:
+	glVertexAttribDivisor(program->Ball_vec4, 1);
+	GLState::bind_vertex_array(0);
+	balls_for_program = std::make_shared< GLVertexArray >(vertex_array);
+
+	glGenFramebuffers(1, &framebuffer);
+
+	batch = GLResourcePool::get< BatchRenderer >();
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+MotionBlur::~MotionBlur() {
+	glDeleteFramebuffers(1, &framebuffer);
+	framebuffer = 0;
+	GLState::delete_textures(1, &layer_tex);
+	layer_tex = 0;
+}
+
+void MotionBlur::draw(std::vector< glm::vec4 > const &balls, float radius, glm::vec4 const &color, glm::mat4 const &object_to_clip, float pixel_size, glm::uvec2 const &drawable_size) {
+	if (balls.empty() || drawable_size.x == 0 || drawable_size.y == 0) return;
+
+	//(re)allocate the ball layer to match the framebuffer pixel-for-pixel:
+	if (layer_size != drawable_size) {
+		if (layer_tex == 0) glGenTextures(1, &layer_tex);
+		GLState::active_texture(GL_TEXTURE0);
+		GLState::bind_texture(GL_TEXTURE_2D, layer_tex);
+		//(with a pixel buffer object bound, the null data pointer would be read as an offset into it)
+		GLState::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, GLsizei(drawable_size.x), GLsizei(drawable_size.y), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer_tex, 0);
+		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (status != GL_FRAMEBUFFER_COMPLETE) {
+			throw std::runtime_error("MotionBlur: ball layer framebuffer is incomplete.");
+		}
+		layer_size = drawable_size;
+	}
+
+	//upload balls:
+	GLState::bind_buffer(GL_ARRAY_BUFFER, ball_buffer->name);
+	glBufferData(GL_ARRAY_BUFFER, balls.size() * sizeof(balls[0]), balls.data(), GL_STREAM_DRAW);
+
+	//draw every streak into the ball layer (with premultiplied alpha, so overlapping streaks accumulate):
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	GLState::clear_color(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	GLState::disable(GL_DEPTH_TEST);
+	GLState::enable(GL_BLEND);
+	GLState::blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+	GLState::use_program(program->program);
+	glUniformMatrix4fv(program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(object_to_clip));
+	glUniform1f(program->BALL_RADIUS_float, radius);
+	glUniform1f(program->PIXEL_SIZE_float, pixel_size);
+	glUniform4fv(program->COLOR_vec4, 1, glm::value_ptr(color));
+	GLState::bind_vertex_array(balls_for_program->name);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(balls.size()));
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	//composite the layer over the framebuffer with one full-screen quad:
+	batch->rectangle(0, glm::vec2(0.0f), glm::vec2(1.0f), glm::u8vec4(0xff), layer_tex, BatchRenderer::Premultiplied);
+	batch->flush(glm::mat4(1.0f));
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
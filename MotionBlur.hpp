@@ -0,0 +1,53 @@
+#pragma once
+
+#include "BallBlurProgram.hpp"
+#include "BatchRenderer.hpp"
+#include "GLResourcePool.hpp"
+
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+/*
+ * MotionBlur draws fast-moving balls as streaks covering the path each one took
+ *  during the frame, so they don't strobe at high speeds.
+ *
+ * All balls are drawn (one instanced draw of BallBlurProgram quads) into an offscreen
+ *  ball layer, where overlapping streaks accumulate with premultiplied alpha; the layer
+ *  is then composited over the framebuffer in one more draw. So the cost over drawing
+ *  the balls directly is one full-screen pass, however many balls there are.
+ *
+ * Usage (get it from GLResourcePool in load_step(), so modes share one):
+ *   motion_blur = GLResourcePool::get< MotionBlur >();
+ *   ...
+ *   //(x, y) = position now, (dx, dy) = distance moved during the frame:
+ *   balls.emplace_back(x, y, dx, dy);
+ *   motion_blur->draw(balls, radius, color, court_to_clip, pixel_size, drawable_size);
+ */
+
+struct MotionBlur {
+	MotionBlur();
+	~MotionBlur();
+	MotionBlur(MotionBlur const &) = delete;
+
+	//draw 'balls' into the ball layer, then composite it over the bound (default) framebuffer:
+	// pixel_size is the size of a pixel in court units
+	void draw(std::vector< glm::vec4 > const &balls, float radius, glm::vec4 const &color, glm::mat4 const &object_to_clip, float pixel_size, glm::uvec2 const &drawable_size);
+
+private:
+	std::shared_ptr< BallBlurProgram > program;
+	std::shared_ptr< GLBuffer > corner_buffer; //(square_corners_buffer())
+	std::shared_ptr< GLBuffer > ball_buffer;
+	std::shared_ptr< GLVertexArray > balls_for_program;
+
+	//the ball layer (reallocated when the drawable size changes):
+	GLuint framebuffer = 0;
+	GLuint layer_tex = 0;
+	glm::uvec2 layer_size = glm::uvec2(0);
+
+	//(composites the layer)
+	std::shared_ptr< BatchRenderer > batch;
+};
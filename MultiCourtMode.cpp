@@ -0,0 +1,211 @@
+#include "MultiCourtMode.hpp"
+
+//for the GL_ERRORS() macro:
+#include "gl_errors.hpp"
+
+//for cached GL state changes:
+#include "GLState.hpp"
+
+//for glm::value_ptr() :
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <iostream>
+
+//layout of the court template:
+struct CourtVertex {
+	CourtVertex(glm::vec2 const &Position_, float Part_, glm::u8vec4 const &Color_) : Position(Position_), Part(Part_), Color(Color_) { }
+	glm::vec2 Position;
+	float Part;
+	glm::u8vec4 Color;
+};
+static_assert(sizeof(CourtVertex) == 4*2 + 4 + 4, "CourtVertex is packed.");
+
+//some nice colors from the course web page:
+#define HEX_TO_U8VEC4( HX ) (glm::u8vec4( (HX >> 24) & 0xff, (HX >> 16) & 0xff, (HX >> 8) & 0xff, (HX) & 0xff ))
+static const glm::u8vec4 bg_color = HEX_TO_U8VEC4(0x171714ff);
+static const glm::u8vec4 fg_color = HEX_TO_U8VEC4(0xd1bb54ff);
+#undef HEX_TO_U8VEC4
+
+//other useful drawing constants:
+static const float wall_radius = 0.05f;
+static const float padding = 0.14f; //padding between outside of walls and edge of tile
+
+MultiCourtMode::MultiCourtMode(uint32_t court_count) : courts(court_count) {
+	instances.resize(court_count);
+	//(OpenGL resources are created in load_step())
+}
+
+bool MultiCourtMode::load_step() {
+	//----- get shared OpenGL resources -----
+	if (!program) {
+		program = GLResourcePool::get< CourtInstanceProgram >();
+
+		//the court template: walls, plus paddles and ball (offset per-instance by the vertex shader):
+		std::vector< CourtVertex > vertices;
+		auto draw_rectangle = [&vertices](glm::vec2 const &center, glm::vec2 const &radius, float part) {
+			//two triangles:
+			vertices.emplace_back(glm::vec2(center.x - radius.x, center.y - radius.y), part, fg_color);
+			vertices.emplace_back(glm::vec2(center.x + radius.x, center.y - radius.y), part, fg_color);
+			vertices.emplace_back(glm::vec2(center.x + radius.x, center.y + radius.y), part, fg_color);
+			vertices.emplace_back(glm::vec2(center.x - radius.x, center.y - radius.y), part, fg_color);
+			vertices.emplace_back(glm::vec2(center.x + radius.x, center.y + radius.y), part, fg_color);
+			vertices.emplace_back(glm::vec2(center.x - radius.x, center.y + radius.y), part, fg_color);
+		};
+		glm::vec2 const &court_radius = courts.court_radius;
+		draw_rectangle(glm::vec2(-court_radius.x - wall_radius, 0.0f), glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), 0.0f);
+		draw_rectangle(glm::vec2( court_radius.x + wall_radius, 0.0f), glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), 0.0f);
+		draw_rectangle(glm::vec2(0.0f, -court_radius.y - wall_radius), glm::vec2(court_radius.x, wall_radius), 0.0f);
+		draw_rectangle(glm::vec2(0.0f,  court_radius.y + wall_radius), glm::vec2(court_radius.x, wall_radius), 0.0f);
+		draw_rectangle(glm::vec2(-courts.paddle_x, 0.0f), courts.paddle_radius, 1.0f);
+		draw_rectangle(glm::vec2( courts.paddle_x, 0.0f), courts.paddle_radius, 2.0f);
+		draw_rectangle(glm::vec2(0.0f, 0.0f), courts.ball_radius, 3.0f);
+		template_count = GLsizei(vertices.size());
+
+		template_buffer = GLResourcePool::get< GLBuffer >("pong court template", [&vertices](){
+			auto buffer = std::make_shared< GLBuffer >();
+			GLState::bind_buffer(GL_ARRAY_BUFFER, buffer->name);
+			glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertices[0]), vertices.data(), GL_STATIC_DRAW);
+			return buffer;
+		});
+
+		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+		return false;
+	}
+
+	//----- allocate per-mode OpenGL resources -----
+	{ //instance buffer + vertex array object:
+		glGenBuffers(1, &instance_buffer);
+		GLState::bind_buffer(GL_ARRAY_BUFFER, instance_buffer);
+		glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(instances[0]), nullptr, GL_STREAM_DRAW);
+
+		glGenVertexArrays(1, &buffers_for_program);
+		GLState::bind_vertex_array(buffers_for_program);
+
+		GLState::bind_buffer(GL_ARRAY_BUFFER, template_buffer->name);
+		glVertexAttribPointer(program->Position_vec2, 2, GL_FLOAT, GL_FALSE, sizeof(CourtVertex), (GLbyte *)0 + offsetof(CourtVertex, Position));
+		glEnableVertexAttribArray(program->Position_vec2);
+		glVertexAttribPointer(program->Part_float, 1, GL_FLOAT, GL_FALSE, sizeof(CourtVertex), (GLbyte *)0 + offsetof(CourtVertex, Part));
+		glEnableVertexAttribArray(program->Part_float);
+		glVertexAttribPointer(program->Color_vec4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CourtVertex), (GLbyte *)0 + offsetof(CourtVertex, Color));
+		glEnableVertexAttribArray(program->Color_vec4);
+
+		GLState::bind_buffer(GL_ARRAY_BUFFER, instance_buffer);
+		glVertexAttribPointer(program->State_vec4, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (GLbyte *)0);
+		glEnableVertexAttribArray(program->State_vec4);
+		//advance State once per instance (court) instead of once per vertex:
+		glVertexAttribDivisor(program->State_vec4, 1);
+
+		GLState::bind_vertex_array(0);
+
+		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+	}
+
+	return true;
+}
+
+MultiCourtMode::~MultiCourtMode() {
+	//----- free OpenGL resources -----
+	GLState::delete_vertex_arrays(1, &buffers_for_program);
+	GLState::delete_buffers(1, &instance_buffer);
+	//(program and court template are pooled -- see GLResourcePool)
+}
+
+void MultiCourtMode::update(float elapsed) {
+	auto before = std::chrono::high_resolution_clock::now();
+
+	courts.update(elapsed, &pool);
+
+	auto after = std::chrono::high_resolution_clock::now();
+	report_update_seconds += std::chrono::duration< double >(after - before).count();
+
+	//print timing every couple of seconds:
+	report_timer += elapsed;
+	report_frames += 1;
+	if (report_timer > 2.0f) {
+		std::cout << "MultiCourtMode: " << courts.size() << " courts (" << PongCourts::BytesPerCourt << " bytes of state + "
+		          << sizeof(instances[0]) << " bytes of instance data each) on " << pool.thread_count() << " threads, "
+		          << "update " << (report_update_seconds / report_frames * 1000.0) << " ms, "
+		          << "draw " << (report_draw_seconds / report_frames * 1000.0) << " ms per frame." << std::endl;
+		report_timer = 0.0f;
+		report_frames = 0;
+		report_update_seconds = 0.0;
+		report_draw_seconds = 0.0;
+	}
+}
+
+void MultiCourtMode::draw(glm::uvec2 const &drawable_size) {
+	auto before = std::chrono::high_resolution_clock::now();
+
+	//------ compute tiling ------
+
+	//half-size of the area each court needs:
+	glm::vec2 scene_radius = courts.court_radius + glm::vec2(2.0f * wall_radius + padding);
+
+	//pick the number of columns that lets courts be drawn largest:
+	// (scale is in pixels per court unit)
+	uint32_t count = std::max(1U, courts.size());
+	uint32_t columns = 1;
+	float scale = 0.0f;
+	for (uint32_t c = 1; c <= count; ++c) {
+		uint32_t r = (count + c - 1) / c;
+		float s = std::min(drawable_size.x / (c * 2.0f * scene_radius.x), drawable_size.y / (r * 2.0f * scene_radius.y));
+		if (s > scale) {
+			scale = s;
+			columns = c;
+		}
+	}
+	uint32_t rows = (count + columns - 1) / columns;
+
+	//size of a tile in clip space, and offset of the (centered) grid's top-left tile:
+	glm::vec2 clip_per_pixel = glm::vec2(2.0f / drawable_size.x, 2.0f / drawable_size.y);
+	glm::vec2 tile = 2.0f * scene_radius * scale * clip_per_pixel;
+	glm::vec2 first = glm::vec2(
+		-0.5f * columns * tile.x + 0.5f * tile.x,
+		 0.5f * rows * tile.y - 0.5f * tile.y
+	);
+
+	//build matrix that scales court units into tile (0,0):
+	glm::mat4 court_to_clip = glm::mat4(
+		glm::vec4(scale * clip_per_pixel.x, 0.0f, 0.0f, 0.0f),
+		glm::vec4(0.0f, scale * clip_per_pixel.y, 0.0f, 0.0f),
+		glm::vec4(0.0f, 0.0f, 1.0f, 0.0f),
+		glm::vec4(first.x, first.y, 0.0f, 1.0f)
+	);
+
+	//------ gather instance data ------
+	for (uint32_t i = 0; i < courts.size(); ++i) {
+		instances[i] = glm::vec4(courts.left_ai.paddle_y[i], courts.right_ai.paddle_y[i], courts.ball_x[i], courts.ball_y[i]);
+	}
+
+	//---- actual drawing ----
+
+	//clear the color buffer:
+	GLState::clear_color(bg_color.r / 255.0f, bg_color.g / 255.0f, bg_color.b / 255.0f, bg_color.a / 255.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	//use alpha blending:
+	GLState::enable(GL_BLEND);
+	GLState::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	//don't use the depth test:
+	GLState::disable(GL_DEPTH_TEST);
+
+	//upload instance data (orphaning last frame's storage):
+	GLState::bind_buffer(GL_ARRAY_BUFFER, instance_buffer);
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(instances[0]), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(instances[0]), instances.data());
+
+	GLState::use_program(program->program);
+	glUniformMatrix4fv(program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
+	glUniform2f(program->TILE_STEP_vec2, tile.x, -tile.y);
+	glUniform1i(program->COLUMNS_int, GLint(columns));
+
+	//every court in one draw:
+	GLState::bind_vertex_array(buffers_for_program);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, template_count, GLsizei(courts.size()));
+
+	GL_ERRORS(); //PARANOIA: print errors just in case we did something wrong.
+
+	auto after = std::chrono::high_resolution_clock::now();
+	report_draw_seconds += std::chrono::duration< double >(after - before).count();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "PongCourts.hpp"
+#include "CourtInstanceProgram.hpp"
+#include "WorkStealingPool.hpp"
+#include "GLResourcePool.hpp"
+
+#include "Mode.hpp"
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/*
+ * MultiCourtMode runs many AI-vs-AI Pong courts at once and shows them all, tiled.
+ *
+ * Courts are simulated by PongCourts (a few dozen bytes of structure-of-arrays state
+ *  each, updated in parallel), and drawn with one instanced draw call: the court's
+ *  geometry is a single shared template, and each instance only adds four floats
+ *  (paddle and ball positions). So adding a court costs no extra Modes or GL objects.
+ */
+
+struct MultiCourtMode : Mode {
+	MultiCourtMode(uint32_t court_count);
+	virtual ~MultiCourtMode();
+
+	//functions called by main loop:
+	virtual bool load_step() override;
+	virtual void update(float elapsed) override;
+	virtual void draw(glm::uvec2 const &drawable_size) override;
+
+	//----- game state -----
+
+	PongCourts courts;
+	WorkStealingPool pool;
+
+	//----- timing report -----
+
+	//time spent in update() and draw() (CPU side), printed every couple of seconds:
+	float report_timer = 0.0f;
+	uint32_t report_frames = 0;
+	double report_update_seconds = 0.0;
+	double report_draw_seconds = 0.0;
+
+	//----- opengl assets / helpers ------
+
+	//Shader program that draws whole courts, one per instance:
+	std::shared_ptr< CourtInstanceProgram > program;
+
+	//Court template (walls, paddles, ball) as triangles (shared with any other MultiCourtMode):
+	std::shared_ptr< GLBuffer > template_buffer;
+	GLsizei template_count = 0;
+
+	//Per-court instance data (left paddle y, right paddle y, ball x, ball y), re-uploaded every frame:
+	std::vector< glm::vec4 > instances;
+	GLuint instance_buffer = 0;
+
+	//Vertex Array Object reading template_buffer per-vertex and instance_buffer per-instance:
+	GLuint buffers_for_program = 0;
+};
@@ -0,0 +1,244 @@
+#include "NetPongMode.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+UdpSocket::LinkConditions NetPongMode::link_conditions;
+
+NetPongMode::NetPongMode(Role role_, UdpSocket::Address const &address) : role(role_), socket(role_ == Host ? address.port : 0) {
+	socket.conditions = link_conditions;
+	//both paddles belong to players:
+	right_ai = false;
+
+	if (role == Host) {
+		std::cout << "NetPongMode: hosting on port " << socket.port() << "; waiting for a player to join." << std::endl;
+	} else {
+		peer = address;
+		have_peer = true;
+		std::cout << "NetPongMode: joining " << peer.to_string() << " (from port " << socket.port() << ")." << std::endl;
+	}
+}
+
+NetPongMode::~NetPongMode() {
+}
+
+PongNetState NetPongMode::net_state() const {
+	PongNetState state;
+	state.tick = tick;
+	state.words[0] = float_bits(left_paddle.y);
+	state.words[1] = float_bits(right_paddle.y);
+	state.words[2] = float_bits(ball.x);
+	state.words[3] = float_bits(ball.y);
+	state.words[4] = float_bits(ball_velocity.x);
+	state.words[5] = float_bits(ball_velocity.y);
+	state.words[6] = left_score;
+	state.words[7] = right_score;
+	return state;
+}
+
+void NetPongMode::set_net_state(PongNetState const &state) {
+	left_paddle.y = bits_float(state.words[0]);
+	right_paddle.y = bits_float(state.words[1]);
+	ball.x = bits_float(state.words[2]);
+	ball.y = bits_float(state.words[3]);
+	ball_velocity.x = bits_float(state.words[4]);
+	ball_velocity.y = bits_float(state.words[5]);
+	left_score = state.words[6];
+	right_score = state.words[7];
+}
+
+void NetPongMode::handle_input(Input const &input, glm::uvec2 const &window_size) {
+	if (role == Host) {
+		//host is the left player, just like in PongMode:
+		PongMode::handle_input(input, window_size);
+	} else if (input.mouse_moved) {
+		//client is the right player; the paddle moves at the next tick:
+		glm::vec2 clip_mouse = glm::vec2(
+			(input.mouse.x + 0.5f) / window_size.x * 2.0f - 1.0f,
+			(input.mouse.y + 0.5f) / window_size.y *-2.0f + 1.0f
+		);
+		local_y = (clip_to_court * glm::vec3(clip_mouse, 1.0f)).y;
+	}
+}
+
+void NetPongMode::update(float elapsed) {
+	socket.poll();
+
+	if (role == Host) host_receive();
+	else client_receive();
+
+	//fixed-rate ticks (dropping time if very far behind):
+	tick_accumulator = std::min(tick_accumulator + elapsed, 5.0f * Tick);
+	while (tick_accumulator >= Tick) {
+		tick_accumulator -= Tick;
+		if (role == Host) host_tick();
+		else client_tick();
+	}
+
+	report_timer += elapsed;
+	if (report_timer > 2.0f) report();
+}
+
+//---------------- host ----------------
+
+void NetPongMode::host_receive() {
+	uint8_t data[MaxPacket];
+	UdpSocket::Address from;
+	while (size_t size = socket.receive(data, sizeof(data), &from)) {
+		PacketReader packet(data, size);
+		PongInputPacket input;
+		if (!read_input_packet(packet, &input)) continue;
+
+		if (!have_peer) {
+			peer = from;
+			have_peer = true;
+			std::cout << "NetPongMode: " << peer.to_string() << " joined." << std::endl;
+		}
+		if (from != peer) continue; //(only one client per game)
+
+		client_acked_tick = std::max(client_acked_tick, input.ack_tick);
+
+		//queue inputs the host hasn't seen yet, oldest first:
+		for (uint32_t i = 0; i < input.count; ++i) {
+			uint32_t seq = input.newest_seq - (input.count - 1 - i);
+			if (seq > client_seq) {
+				input_queue.push_back(PaddleInput{ seq, input.ys[i] });
+				client_seq = seq;
+			}
+		}
+	}
+}
+
+void NetPongMode::host_tick() {
+	//use one client input per tick, so the game steps the way the client predicted it would:
+	// (if inputs pile up -- e.g., after a burst of delayed packets -- skip ahead, keeping a couple of ticks of buffer)
+	while (input_queue.size() > 3) input_queue.pop_front();
+	if (!input_queue.empty()) {
+		remote_y = input_queue.front().y;
+		applied_seq = input_queue.front().seq;
+		input_queue.pop_front();
+	}
+	right_paddle.y = remote_y;
+
+	step(Tick);
+	update_trail(Tick);
+
+	tick += 1;
+	PongNetState state = net_state();
+	history.store(state);
+
+	if (!have_peer) return;
+
+	//delta against the newest state the client has (if it's still in the history):
+	PongNetState const *baseline = history.find(client_acked_tick);
+
+	PacketWriter packet;
+	write_state_packet(packet, state, baseline, applied_seq);
+	socket.send(peer, packet.data, packet.size);
+
+	if (baseline) deltas_sent += 1;
+	else fulls_sent += 1;
+}
+
+//---------------- client ----------------
+
+void NetPongMode::client_receive() {
+	uint8_t data[MaxPacket];
+	UdpSocket::Address from;
+	uint32_t ack_seq = 0;
+	bool fresh = false;
+	while (size_t size = socket.receive(data, sizeof(data), &from)) {
+		if (from != peer) continue;
+		PacketReader packet(data, size);
+		PongNetState state;
+		uint32_t seq;
+		if (!read_state_packet(packet, history, &state, &seq)) continue;
+		if (state.tick <= newest_state) continue; //(ignore late, out-of-order states)
+
+		history.store(state);
+		newest_state = state.tick;
+		ack_seq = seq;
+		fresh = true;
+	}
+
+	if (!fresh) return;
+
+	//----- reconcile -----
+	auto before = std::chrono::high_resolution_clock::now();
+	glm::vec2 predicted_ball = ball;
+
+	//the host's state includes all inputs up to ack_seq:
+	set_net_state(*history.find(newest_state));
+	while (!pending.empty() && pending.front().seq <= ack_seq) pending.pop_front();
+
+	//replay the rest (the opponent's paddle stays where the host last had it):
+	for (auto const &input : pending) {
+		right_paddle.y = input.y;
+		step(Tick);
+	}
+
+	auto after = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration< double >(after - before).count();
+	reconciliations += 1;
+	replayed_ticks += uint32_t(pending.size());
+	reconcile_seconds += seconds;
+	reconcile_max_seconds = std::max(reconcile_max_seconds, seconds);
+	correction_sum += glm::length(ball - predicted_ball);
+}
+
+void NetPongMode::client_tick() {
+	tick += 1;
+	pending.push_back(PaddleInput{ tick, local_y });
+	//(if the host has gone quiet, don't let the replay list grow forever)
+	while (pending.size() > PongNetHistory::Size) pending.pop_front();
+
+	//predict:
+	right_paddle.y = local_y;
+	step(Tick);
+	update_trail(Tick);
+
+	//send the newest few inputs:
+	PongInputPacket input;
+	input.ack_tick = newest_state;
+	input.newest_seq = tick;
+	input.count = uint8_t(std::min< size_t >(pending.size(), MaxRepeatedInputs));
+	for (uint32_t i = 0; i < input.count; ++i) {
+		input.ys[i] = pending[pending.size() - input.count + i].y;
+	}
+	PacketWriter packet;
+	write_input_packet(packet, input);
+	socket.send(peer, packet.data, packet.size);
+}
+
+//---------------- statistics ----------------
+
+void NetPongMode::report() {
+	float seconds = report_timer;
+	std::cout << "NetPongMode (" << (role == Host ? "host" : "client") << "): "
+		<< "sent " << (socket.bytes_sent - reported_bytes_sent) / seconds << " B/s in "
+		<< (socket.packets_sent - reported_packets_sent) / seconds << " packets/s, "
+		<< "received " << (socket.bytes_received - reported_bytes_received) / seconds << " B/s in "
+		<< (socket.packets_received - reported_packets_received) / seconds << " packets/s";
+	if (socket.packets_dropped) std::cout << ", " << socket.packets_dropped << " dropped by the simulated link so far";
+	if (role == Host) {
+		std::cout << "; " << deltas_sent << " delta + " << fulls_sent << " full states";
+	} else if (reconciliations) {
+		std::cout << "; " << reconciliations << " reconciliations, "
+			<< float(replayed_ticks) / reconciliations << " ticks replayed, "
+			<< (reconcile_seconds / reconciliations * 1e6) << " us avg, "
+			<< (reconcile_max_seconds * 1e6) << " us max, "
+			<< "ball corrected by " << correction_sum / reconciliations << " avg";
+	}
+	std::cout << std::endl;
+
+	report_timer = 0.0f;
+	reported_bytes_sent = socket.bytes_sent;
+	reported_bytes_received = socket.bytes_received;
+	reported_packets_sent = socket.packets_sent;
+	reported_packets_received = socket.packets_received;
+	reconciliations = replayed_ticks = 0;
+	reconcile_seconds = reconcile_max_seconds = 0.0;
+	correction_sum = 0.0f;
+	deltas_sent = fulls_sent = 0;
+}
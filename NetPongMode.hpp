@@ -0,0 +1,92 @@
+#pragma once
+
+#include "PongMode.hpp"
+#include "UdpSocket.hpp"
+#include "PongProtocol.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <deque>
+
+/*
+ * NetPongMode is two-player PongMode over UDP: the host plays the left paddle
+ *  (and runs the real game), and a client plays the right paddle.
+ *
+ * Both sides step the game at a fixed Tick. The client sends its paddle position
+ *  every tick (repeating the last few, in case of loss), and moves its paddle and
+ *  the ball right away -- client-side prediction -- instead of waiting for the host.
+ * The host sends the game state back every tick, tagged with the newest client input
+ *  it has used. When that arrives, the client reconciles: it resets to the host's
+ *  state and replays the inputs the host hasn't seen yet.
+ *
+ * State packets are delta-compressed: only fields that changed since a state the
+ *  client has acknowledged are sent. (Packet layouts are in PongProtocol.hpp; a client
+ *  can also join a dedicated pong-server.)
+ *
+ * Bandwidth and reconciliation cost are printed every few seconds.
+ */
+
+struct NetPongMode : PongMode {
+	enum Role { Host, Client };
+	//host: listen on address.port; client: connect to address:
+	NetPongMode(Role role, UdpSocket::Address const &address);
+	virtual ~NetPongMode();
+
+	//functions called by main loop:
+	virtual void handle_input(Input const &, glm::uvec2 const &window_size) override;
+	virtual void update(float elapsed) override;
+
+	//simulated network conditions for new NetPongModes' sockets (set by main.cpp's --net-latency etc.):
+	static UdpSocket::LinkConditions link_conditions;
+
+	static constexpr float Tick = 1.0f / 60.0f;
+
+	Role role;
+	UdpSocket socket;
+	UdpSocket::Address peer; //host: the client (once one has sent something); client: the host
+	bool have_peer = false;
+
+	float tick_accumulator = 0.0f;
+	uint32_t tick = 0; //host: state number; client: input number (both start at 1, so 0 means "none")
+
+	//----- game state on the wire (see PongProtocol.hpp) -----
+	PongNetState net_state() const;
+	void set_net_state(PongNetState const &);
+
+	//recent states sent (host) or received (client):
+	PongNetHistory history;
+
+	//----- host -----
+	struct PaddleInput {
+		uint32_t seq;
+		float y;
+	};
+	std::deque< PaddleInput > input_queue; //inputs from the client not yet used
+	uint32_t client_seq = 0; //newest input received (queued or used)
+	uint32_t applied_seq = 0; //newest input used
+	float remote_y = 0.0f;
+	uint32_t client_acked_tick = 0; //newest state the client says it has
+
+	void host_receive();
+	void host_tick();
+
+	//----- client -----
+	float local_y = 0.0f; //where the mouse wants our paddle
+	std::deque< PaddleInput > pending; //inputs sent but not yet acknowledged by the host
+	uint32_t newest_state = 0; //newest state tick received
+
+	void client_receive();
+	void client_tick();
+
+	//----- statistics -----
+	float report_timer = 0.0f;
+	uint64_t reported_bytes_sent = 0, reported_bytes_received = 0;
+	uint64_t reported_packets_sent = 0, reported_packets_received = 0;
+	uint32_t reconciliations = 0;
+	uint32_t replayed_ticks = 0;
+	double reconcile_seconds = 0.0, reconcile_max_seconds = 0.0;
+	float correction_sum = 0.0f; //how far reconciliation moved the ball (court units)
+	uint32_t deltas_sent = 0, fulls_sent = 0;
+	void report();
+};
@@ -1,8 +1,31 @@
 #include "NewMode.hpp"
 
+float NewMode::sim_thread_rate = 0.0f;
+bool NewMode::motion_blur = true;
+std::function< std::shared_ptr< PaddleController >() > NewMode::make_controller;
+std::string NewMode::record_paddle;
+std::string NewMode::snapshot_file;
+std::shared_ptr< SpectatorServer > NewMode::spectator_server;
+std::shared_ptr< SpectatorViewer > NewMode::spectator_source;
+
+//for saving and loading game snapshots:
+#include "snapshot_file.hpp"
+
+//for the pause overlay:
+#include "PauseMode.hpp"
+
 //for the GL_ERRORS() macro:
 #include "gl_errors.hpp"
 
+//for cached GL state changes:
+#include "GLState.hpp"
+
+//for pacing the simulation thread:
+#include "FramePacer.hpp"
+
+//for PROFILE_ZONE():
+#include "Profiler.hpp"
+
 //for glm::value_ptr() :
 #include <glm/gtc/type_ptr.hpp>
 
@@ -10,341 +33,261 @@
 #include <cmath>
 #define _USE_MATH_DEFINES
 
+#include <chrono>
+#include <iostream>
+
 NewMode::NewMode() {
-	//----- allocate OpenGL resources -----
-	{ //vertex buffer:
-		glGenBuffers(1, &vertex_buffer);
-		//for now, buffer will be un-filled.
+	//(OpenGL resources are fetched in load_step(), so this mode can be loaded over several frames)
 
-		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+	if (make_controller) controller = make_controller();
+
+	//(so the first frame drawn doesn't blur the balls along a path from garbage)
+	for (int i = 0; i < 7; i++) {
+		last_balls[i] = game.balls[i];
 	}
+}
 
-	{ //vertex array mapping buffer for color_texture_program:
-		//ask OpenGL to fill vertex_buffer_for_color_texture_program with the name of an unused vertex array object:
-		glGenVertexArrays(1, &vertex_buffer_for_color_texture_program);
+bool NewMode::load_step() {
+	//----- get OpenGL resources, one per call -----
+	//(these come from GLResourcePool, so after the first mode is created, switching modes
+	// reuses the compiled program, buffers, vertex array, and texture instead of rebuilding them)
 
-		//set vertex_buffer_for_color_texture_program as the current vertex array object:
-		glBindVertexArray(vertex_buffer_for_color_texture_program);
+	if (!program) { //shader program for the chosen vertex layout:
+		program = GLResourcePool::get< Vertex::Program >();
+		return false;
+	}
 
-		//set vertex_buffer as the source of glVertexAttribPointer() commands:
-		glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+	if (!vertex_buffer) { //vertex + index buffers, re-filled every frame in draw():
+		vertex_buffer = GLResourcePool::get< GLBuffer >("2D stream vertices");
+		index_buffer = GLResourcePool::get< GLBuffer >("2D stream indices");
+		return false;
+	}
 
-		//set up the vertex array object to describe arrays of NewMode::Vertex:
-		glVertexAttribPointer(
-			color_texture_program.Position_vec4, //attribute
-			3, //size
-			GL_FLOAT, //type
-			GL_FALSE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte *)0 + 0 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.Position_vec4);
-		//[Note that it is okay to bind a vec3 input to a vec4 attribute -- the w component will be filled with 1.0 automatically]
-
-		glVertexAttribPointer(
-			color_texture_program.Color_vec4, //attribute
-			4, //size
-			GL_UNSIGNED_BYTE, //type
-			GL_TRUE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte *)0 + 4 * 3 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.Color_vec4);
-
-		glVertexAttribPointer(
-			color_texture_program.TexCoord_vec2, //attribute
-			2, //size
-			GL_FLOAT, //type
-			GL_FALSE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte *)0 + 4 * 3 + 4 * 1 //offset
+	if (!vertex_buffer_for_program) { //vertex array mapping buffer for program:
+		//the layout of Vertex decides which attributes are set up (see Vertex2D.hpp):
+		vertex_buffer_for_program = GLResourcePool::get< GLVertexArray >(
+			std::string("2D stream vertices + indices as ") + typeid(Vertex).name(), [this](){
+				return std::make_shared< GLVertexArray >(make_vertex_array< Vertex >(*program, vertex_buffer->name, index_buffer->name));
+			}
 		);
-		glEnableVertexAttribArray(color_texture_program.TexCoord_vec2);
-
-		//done referring to vertex_buffer, so unbind it:
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-		//done setting up vertex array object, so unbind it:
-		glBindVertexArray(0);
 
 		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+		return false;
 	}
 
-	{ //solid white texture:
-		//ask OpenGL to fill white_tex with the name of an unused texture object:
-		glGenTextures(1, &white_tex);
+	if (!white_tex) { //solid white texture:
+		white_tex = GLResourcePool::get< Texture >("white 1x1", [](){
+			//upload a 1x1 image of solid white:
+			glm::uvec2 size = glm::uvec2(1, 1);
+			std::vector< glm::u8vec4 > data(size.x*size.y, glm::u8vec4(0xff, 0xff, 0xff, 0xff));
+			//(no mipmaps -- a 1x1 texture doesn't need them; set Texture::Options::mipmaps when loading larger images)
+			return Texture::upload(size, data, Texture::Options());
+		});
+		return false;
+	}
 
-		//bind that texture object as a GL_TEXTURE_2D-type texture:
-		glBindTexture(GL_TEXTURE_2D, white_tex);
+	if (!shapes_for_program) { //shape program, buffers, and vertex array:
+		shape_program = GLResourcePool::get< ShapeProgram >();
+		corner_buffer = square_corners_buffer();
+		shape_buffer = GLResourcePool::get< GLBuffer >("shape stream");
+		shapes_for_program = GLResourcePool::get< GLVertexArray >("square corners + shape stream", [this](){
+			return std::make_shared< GLVertexArray >(make_shape_vertex_array(*shape_program, corner_buffer->name, shape_buffer->name));
+		});
 
-		//upload a 1x1 image of solid white to the texture:
-		glm::uvec2 size = glm::uvec2(1, 1);
-		std::vector< glm::u8vec4 > data(size.x*size.y, glm::u8vec4(0xff, 0xff, 0xff, 0xff));
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+		return false;
+	}
 
-		//set filtering and wrapping parameters:
-		//(it's a bit silly to mipmap a 1x1 texture, but I'm doing it because you may want to use this code to load different sizes of texture)
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	if (motion_blur && !blur) { //ball layer for motion blur:
+		blur = GLResourcePool::get< MotionBlur >();
+	}
 
-		//since texture uses a mipmap and we haven't uploaded one, instruct opengl to make one for us:
-		glGenerateMipmap(GL_TEXTURE_2D);
+	//start the simulation thread (if enabled) now that the mode is ready to go:
+	if (sim_thread_rate > 0.0f && !spectator_source && !sim_thread.joinable()) {
+		snapshots.back() = game;
+		snapshots.publish();
+		sim_thread = std::thread(&NewMode::run_sim, this);
+	}
 
-		//Okay, texture uploaded, can unbind it:
-		glBindTexture(GL_TEXTURE_2D, 0);
+	return true;
+}
 
-		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+NewMode::~NewMode() {
+	if (sim_thread.joinable()) {
+		sim_quit = true;
+		sim_thread.join();
+	}
+	if (!record_paddle.empty() && !recording.empty()) {
+		try {
+			ScriptPaddle::save(record_paddle, recording);
+			std::cout << "Saved " << recording.size() << " paddle keys to '" << record_paddle << "'." << std::endl;
+		} catch (std::exception const &e) {
+			std::cerr << e.what() << std::endl;
+		}
 	}
+	//OpenGL resources are pooled, so they stay alive for the next mode (see GLResourcePool).
 }
 
-NewMode::~NewMode() {
+bool NewMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size) {
 
-	//----- free OpenGL resources -----
-	glDeleteBuffers(1, &vertex_buffer);
-	vertex_buffer = 0;
+	if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_ESCAPE) {
+		//pause (restarting from the pause screen loads a fresh NewMode in the background):
+		Mode::push(std::make_shared< PauseMode >([](){ return std::make_shared< NewMode >(); }));
+		return true;
+	}
 
-	glDeleteVertexArrays(1, &vertex_buffer_for_color_texture_program);
-	vertex_buffer_for_color_texture_program = 0;
+	if (evt.type == SDL_KEYDOWN && !snapshot_file.empty() && (evt.key.keysym.sym == SDLK_F5 || evt.key.keysym.sym == SDLK_F9)) {
+		try {
+			if (evt.key.keysym.sym == SDLK_F5) {
+				save_snapshot(snapshot_file, view().save());
+				std::cout << "Saved game to '" << snapshot_file << "'." << std::endl;
+			} else if (sim_thread.joinable()) {
+				//(the simulation thread owns 'game' while it runs)
+				std::cerr << "Can't load a snapshot while the simulation thread is running." << std::endl;
+			} else {
+				game.restore(load_snapshot< BallDefender::Snapshot >(snapshot_file));
+				std::cout << "Loaded game from '" << snapshot_file << "'." << std::endl;
+			}
+		} catch (std::exception const &e) {
+			std::cerr << e.what() << std::endl;
+		}
+		return true;
+	}
 
-	glDeleteTextures(1, &white_tex);
-	white_tex = 0;
+	return false;
 }
 
-bool NewMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size) {
+void NewMode::handle_input(Input const &input, glm::uvec2 const &window_size) {
+	//the paddle only depends on where the mouse ended up this frame:
+	if (!controller && !spectator_source && view().health > 0 && input.mouse_moved) {
+		arc_paddle = mouse_to_court(input.mouse, window_size);
+		if (sim_thread.joinable()) {
+			paddle_input.back() = arc_paddle;
+			paddle_input.publish();
+		}
+	}
+}
 
-	if (health > 0 && evt.type == SDL_MOUSEMOTION) {
-		//convert mouse from window pixels (top-left origin, +y is down) to clip space ([-1,1]x[-1,1], +y is up):
-		glm::vec2 clip_mouse = glm::vec2(
-			(evt.motion.x + 0.5f) / window_size.x * 2.0f - 1.0f,
-			(evt.motion.y + 0.5f) / window_size.y *-2.0f + 1.0f
-		);
+glm::vec2 NewMode::mouse_to_court(glm::ivec2 const &mouse, glm::uvec2 const &window_size) const {
+	//convert mouse from window pixels (top-left origin, +y is down) to clip space ([-1,1]x[-1,1], +y is up):
+	glm::vec2 clip_mouse = glm::vec2(
+		(mouse.x + 0.5f) / window_size.x * 2.0f - 1.0f,
+		(mouse.y + 0.5f) / window_size.y *-2.0f + 1.0f
+	);
 
-		//calculate the distance vector from the mouse to the center of the screen
-		glm::vec2 distance = glm::vec2(
-			(clip_to_court * glm::vec3(clip_mouse, 1.0f)).x,
-			(clip_to_court * glm::vec3(clip_mouse, 1.0f)).y
-		);
+	//calculate the distance vector from the mouse to the center of the screen
+	return clip_to_court * glm::vec3(clip_mouse, 1.0f);
+}
 
-		arc_paddle.x = distance.x;
-		arc_paddle.y = distance.y;
+void NewMode::update(float elapsed) {
+	PROFILE_ZONE("NewMode::update");
+
+	if (spectator_source) {
+		//just show the newest frame from the broadcast:
+		if (spectator_source->poll()) game.restore(spectator_source->state);
+		return;
 	}
 
-	return false;
+	if (!sim_thread.joinable()) {
+		step_game(elapsed, arc_paddle);
+		return;
+	}
+
+	//let the simulation thread run for the same amount of game time:
+	sim_budget_us += uint64_t(elapsed * 1e6f);
+
+	//report how much simulation overlapped with drawing:
+	report_timer += elapsed;
+	if (report_timer > 5.0f) {
+		uint64_t busy = sim_busy_ns.exchange(0);
+		std::cout << "sim thread: " << (sim_steps.exchange(0) / report_timer) << " steps/s"
+		          << ", busy " << (busy * 1e-9 / report_timer * 100.0) << "%"
+		          << ", draw busy " << (draw_ns * 1e-9 / report_timer * 100.0) << "%"
+		          << ", " << (busy ? 100.0 * sim_busy_ns_during_draw / busy : 0.0) << "% of sim time overlapped draw()"
+		          << std::endl;
+		sim_busy_ns_during_draw = 0;
+		draw_ns = 0;
+		report_timer = 0.0f;
+	}
 }
 
-void NewMode::update(float elapsed) {
-	//end the game if health reaches zero
-	if (health > 0)
-	{
-		//----- ball update -----
-
-		//add a new ball every 12 wall collisions, up to a max of 7 balls in play at once
-		if (num_collisions != 0 && num_collisions <= 72 && num_collisions % 12 == 0) {
-			int index = num_collisions / 12;
-			if (index % 2 == 0)
-			{
-				balls[index] = glm::vec2(6.0f, 0.0f);
-				ball_velocities[index] = glm::vec2(-1.0f, 0.0f);
-			}
-			else {
-				balls[index] = glm::vec2(-6.0f, 0.0f);
-				ball_velocities[index] = glm::vec2(1.0f, 0.0f);
-			}
-		}
+void NewMode::run_sim() {
+	//simulation thread: step the game at a fixed rate, as long as update() has provided game time to do so:
+	const float step = 1.0f / sim_thread_rate;
+	const uint64_t step_us = uint64_t(1e6f / sim_thread_rate);
+	FramePacer pacer(sim_thread_rate, false);
+	glm::vec2 requested = game.arc_paddle;
+	Profiler::name_thread("simulation");
 
-		//increase the speed multiplier based on the number of wall collisions
-		float speed_multiplier = glm::min((float)num_collisions / 12.0f + 2.0f, 7.5f);
+	while (!sim_quit) {
+		pacer.wait();
+		PROFILE_ZONE("NewMode::run_sim tick");
 
-		//loop through all the balls and move them if necessary
-		for (int i = 0; i < 7; i++) {
-			if (balls[i].x != 12.0f) {
-				balls[i] += elapsed * ball_velocities[i] * speed_multiplier;
-			}
+		if (paddle_input.fetch()) {
+			requested = paddle_input.front();
 		}
 
-		//---- collision handling ----
-
-		//arc paddle:
-		auto arc_vs_ball = [this](glm::vec2 const &paddle, glm::vec2 &ball, glm::vec2 &ball_velocity) {
-			//find the corners of the ball:
-			glm::vec2 top_left = glm::vec2(ball.x - ball_radius.x, ball.y - ball_radius.y);
-			glm::vec2 top_right = glm::vec2(ball.x + ball_radius.x, ball.y - ball_radius.y);
-			glm::vec2 bottom_left = glm::vec2(ball.x - ball_radius.x, ball.y + ball_radius.y);
-			glm::vec2 bottom_right = glm::vec2(ball.x + ball_radius.x, ball.y + ball_radius.y);
-
-			//compute the magnitude of the distance from the center of the window to the ball's corners:
-			float top_left_distance = std::sqrt(top_left.x * top_left.x + top_left.y * top_left.y);
-			float top_right_distance = std::sqrt(top_right.x * top_right.x + top_right.y * top_right.y);
-			float bottom_left_distance = std::sqrt(bottom_left.x * bottom_left.x + bottom_left.y * bottom_left.y);
-			float bottom_right_distance = std::sqrt(bottom_right.x * bottom_right.x + bottom_right.y * bottom_right.y);
-
-			//check if ball close enough to center to possibly collide with arc:
-			if ((top_left_distance <= 1.35f     && top_left_distance >= 1.0f) ||
-				(top_right_distance <= 1.35f    && top_right_distance >= 1.0f) ||
-				(bottom_left_distance <= 1.35f  && bottom_left_distance >= 1.0f) ||
-				(bottom_right_distance <= 1.35f && bottom_right_distance >= 1.0f)) {
-				//compute the "collision points" from the arc that will be compared against the ball
-				double theta = atan(paddle.y / paddle.x);
-				if (paddle.x < 0) theta += M_PI;
-				glm::vec2 arc_left_corner = glm::vec2(1.35f * cos(theta - 0.5f), 1.35f * sin(theta - 0.5f));
-				glm::vec2 arc_center = glm::vec2(1.35f * cos(theta), 1.35f * sin(theta));
-				glm::vec2 arc_right_corner = glm::vec2(1.35f * cos(theta + 0.25f), 1.35f * sin(theta + 0.25f));
-				//get the min and max in x and y of the arc's collision points
-				float x_min = glm::min(arc_center.x, glm::min(arc_left_corner.x, arc_right_corner.x));
-				float x_max = glm::max(arc_center.x, glm::max(arc_left_corner.x, arc_right_corner.x));
-				float y_min = glm::min(arc_center.y, glm::min(arc_left_corner.y, arc_right_corner.y));
-				float y_max = glm::max(arc_center.y, glm::max(arc_left_corner.y, arc_right_corner.y));
-				//compare corners of the ball against the arc's collision points
-				if ((top_left.x     >= x_min && top_left.x     <= x_max && top_left.y     >= y_min && top_left.y     <= y_max) ||
-					(top_right.x    >= x_min && top_right.x    <= x_max && top_right.y    >= y_min && top_right.y    <= y_max) ||
-					(bottom_left.x  >= x_min && bottom_left.x  <= x_max && bottom_left.y  >= y_min && bottom_left.y  <= y_max) ||
-					(bottom_right.x >= x_min && bottom_right.x <= x_max && bottom_right.y >= y_min && bottom_right.y <= y_max)) {
-					//change ball x velocity:
-					if (ball.x > 0.0f) {
-						ball.x += ball_radius.x;
-						ball_velocity.x = std::abs(ball_velocity.x);
-					}
-					else if (ball.x < 0.0f) {
-						ball.x -= ball_radius.x;
-						ball_velocity.x = -std::abs(ball_velocity.x);
-					}
-					//change ball y velocity:
-					if (ball.y > 0.0f) {
-						ball.y += ball_radius.y;
-						ball_velocity.y = std::abs(ball_velocity.y);
-					}
-					else if (ball.y < 0.0f) {
-						ball.y -= ball_radius.y;
-						ball_velocity.y = -std::abs(ball_velocity.y);
-					}
-					//warp y velocity based on offset from window center:
-					float vel = (ball.y - paddle.y) / (1.35f + ball_radius.y);
-					ball_velocity.y = glm::min(glm::mix(ball_velocity.y, vel, 0.75f), 1.0f);
-					ball_velocity.y = glm::max(ball_velocity.y, -1.0f);
-				}
-			}
-		};
+		uint32_t steps = 0;
+		auto before = std::chrono::steady_clock::now();
+		//(at most a few steps per tick, so a long stall doesn't turn into a long catch-up)
+		while (sim_budget_us >= step_us && steps < 4) {
+			sim_budget_us -= step_us; //(only this thread subtracts, so the budget can't drop below step_us in between)
+			step_game(step, requested);
+			steps += 1;
+		}
+		if (steps == 0) continue;
 
-		//for each ball, do collisions
-		for (int i = 0; i < 7; i++) {
-			if (balls[i].x != 12.0f) {
-				arc_vs_ball(arc_paddle, balls[i], ball_velocities[i]);
-
-				//court walls:
-				if (balls[i].y > court_radius.y - ball_radius.y) {
-					balls[i].y = court_radius.y - ball_radius.y;
-					if (ball_velocities[i].y > 0.0f) {
-						ball_velocities[i].y = -ball_velocities[i].y;
-					}
-					num_collisions += 1;
-				}
-				if (balls[i].y < -court_radius.y + ball_radius.y) {
-					balls[i].y = -court_radius.y + ball_radius.y;
-					if (ball_velocities[i].y < 0.0f) {
-						ball_velocities[i].y = -ball_velocities[i].y;
-					}
-					num_collisions += 1;
-				}
+		snapshots.back() = game;
+		snapshots.publish();
 
-				if (balls[i].x > court_radius.x - ball_radius.x) {
-					balls[i].x = court_radius.x - ball_radius.x;
-					if (ball_velocities[i].x > 0.0f) {
-						ball_velocities[i].x = -ball_velocities[i].x;
-					}
-					num_collisions += 1;
-				}
-				if (balls[i].x < -court_radius.x + ball_radius.x) {
-					balls[i].x = -court_radius.x + ball_radius.x;
-					if (ball_velocities[i].x < 0.0f) {
-						ball_velocities[i].x = -ball_velocities[i].x;
-					}
-					num_collisions += 1;
-				}
+		sim_busy_ns += uint64_t(std::chrono::duration_cast< std::chrono::nanoseconds >(std::chrono::steady_clock::now() - before).count());
+		sim_steps += steps;
+	}
+}
 
-				//center square:
-				if (balls[i].x >= -2.0f * ball_radius.x && balls[i].x <= 2.0f * ball_radius.x &&
-					balls[i].y >= -2.0f * ball_radius.y && balls[i].y <= 2.0f * ball_radius.y) {
-					if (num_collisions % 2 == 0) {
-						balls[i] = glm::vec2(6.0f, 0.0f);
-						ball_velocities[i] = glm::vec2(-1.0f, 0.0f);
-					}
-					else {
-						balls[i] = glm::vec2(-6.0f, 0.0f);
-						ball_velocities[i] = glm::vec2(1.0f, 0.0f);
-					}
-					health -= 1;
-					num_collisions += 1;
-				}
+void NewMode::step_game(float elapsed, glm::vec2 const &requested) {
+	PROFILE_ZONE("NewMode::step_game");
 
-				//other balls:
-				for (int j = 0; j < 7; j++) {
-					if (i != j && balls[j].x != 12.0f &&
-						balls[i].x - balls[j].x >= -2.0f * ball_radius.x && balls[i].x - balls[j].x <= 2.0f * ball_radius.x &&
-						balls[i].y - balls[j].y >= -2.0f * ball_radius.y && balls[i].y - balls[j].y <= 2.0f * ball_radius.y) {
-						if (std::abs(balls[i].x - balls[j].x) > std::abs(balls[i].y - balls[j].y)) {
-							if (balls[i].x > balls[j].x) {
-								balls[i].x += ball_radius.x;
-								balls[j].x -= ball_radius.x;
-							}
-							else {
-								balls[i].x -= ball_radius.x;
-								balls[j].x += ball_radius.x;
-							}
-							ball_velocities[i].x = -ball_velocities[i].x;
-							ball_velocities[j].x = -ball_velocities[j].x;
-						}
-						else if (std::abs(balls[i].x - balls[j].x) == std::abs(balls[i].y - balls[j].y)) {
-							if (balls[i].x > balls[j].x) {
-								balls[i].x += ball_radius.x;
-								balls[j].x -= ball_radius.x;
-							}
-							else {
-								balls[i].x -= ball_radius.x;
-								balls[j].x += ball_radius.x;
-							}
-							if (balls[i].y > balls[j].y) {
-								balls[i].y += ball_radius.y;
-								balls[j].y -= ball_radius.y;
-							}
-							else {
-								balls[i].y -= ball_radius.y;
-								balls[j].y += ball_radius.y;
-							}
-							ball_velocities[i].x = -ball_velocities[i].x;
-							ball_velocities[i].y = -ball_velocities[i].y;
-						}
-						else {
-							if (balls[i].y > balls[j].y) {
-								balls[i].y += ball_radius.y;
-								balls[j].y -= ball_radius.y;
-							}
-							else {
-								balls[i].y -= ball_radius.y;
-								balls[j].y += ball_radius.y;
-							}
-							ball_velocities[i].y = -ball_velocities[i].y;
-						}
-					}
-				}
-			}
+	game.arc_paddle = (controller ? controller->paddle(game, elapsed) : requested);
+
+	if (!record_paddle.empty()) {
+		//record angles unwrapped (continuing from the previous key), so playback interpolates the short way around:
+		float angle = std::atan2(game.arc_paddle.y, game.arc_paddle.x);
+		if (!recording.empty()) {
+			float d = angle - recording.back().angle;
+			angle = recording.back().angle + (d - 6.2831853f * std::floor((d + 3.1415927f) / 6.2831853f));
 		}
+		recording.emplace_back(ScriptPaddle::Key{ game_time, angle });
 	}
-	//reset the game if health reaches zero
-	else {
-		health = 5;
-		num_collisions = 11;
-		balls[0] = glm::vec2(6.0f, 0.0f);
-		ball_velocities[0] = glm::vec2(-1.0f, 0.0f);
-		for (int i = 1; i < 7; i++) {
-			balls[i] = glm::vec2(12.0f, 0.0f);
-			ball_velocities[i] = glm::vec2(0.0f, 0.0f);
-		}
+	game_time += elapsed;
+
+	game.update(elapsed);
+
+	if (spectator_server) {
+		spectator_server->poll();
+		spectator_server->broadcast(game.save());
 	}
 }
 
+BallDefender const &NewMode::view() const {
+	return (sim_thread.joinable() ? snapshots.front() : game);
+}
+
 void NewMode::draw(glm::uvec2 const &drawable_size) {
+	PROFILE_ZONE("NewMode::draw");
+
+	//(for the simulation thread's overlap metrics)
+	auto draw_start = std::chrono::steady_clock::now();
+	uint64_t sim_busy_ns_at_start = sim_busy_ns;
+
+	//the game state to show (with the simulation thread running, the latest finished step):
+	if (sim_thread.joinable()) snapshots.fetch();
+	BallDefender const &state = view();
+	glm::vec2 const &court_radius = state.court_radius;
+	glm::vec2 const &ball_radius = state.ball_radius;
+	glm::vec2 const (&balls)[7] = state.balls;
+	uint32_t health = state.health;
+
 	//some nice colors from the course web page:
 #define HEX_TO_U8VEC4( HX ) (glm::u8vec4( (HX >> 24) & 0xff, (HX >> 16) & 0xff, (HX >> 8) & 0xff, (HX) & 0xff ))
 	const glm::u8vec4 bg_color = HEX_TO_U8VEC4(0x171714ff);
@@ -372,33 +315,27 @@ void NewMode::draw(glm::uvec2 const &drawable_size) {
 	//vertices will be accumulated into this list and then uploaded+drawn at the end of this function:
 	std::vector< Vertex > vertices;
 
-	//inline helper function for rectangle drawing:
-	auto draw_rectangle = [&vertices](glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color) {
-		//draw rectangle as two CCW-oriented triangles:
-		vertices.emplace_back(glm::vec3(center.x - radius.x, center.y - radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x + radius.x, center.y - radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x + radius.x, center.y + radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-
-		vertices.emplace_back(glm::vec3(center.x - radius.x, center.y - radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x + radius.x, center.y + radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x - radius.x, center.y + radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+	//shapes are drawn as triangle strips of indices into 'vertices', separated by restart_index:
+	// (shared vertices are stored once, so a rectangle costs 4 vertices instead of 6)
+	std::vector< GLushort > indices;
+	const GLushort restart_index = 0xffff;
+
+	//inline helper function to start a new triangle strip:
+	auto begin_strip = [&indices, &restart_index]() {
+		if (!indices.empty()) indices.emplace_back(restart_index);
 	};
 
-	//inline helper function for arc drawing:
-	auto draw_arc = [&vertices](glm::vec2 const &center, glm::u8vec4 const &color) {
-		//get the angle that the mouse is at from the center of the window in radians
-		double theta = atan(center.y / center.x);
-		if (center.x < 0) theta += M_PI;
-		
-		//draw arc as eight triangles along an arc:
-		for (int i = -2; i < 2; i++) {
-			vertices.emplace_back(glm::vec3(1.0f * cos(theta + 0.25f * i),       1.0f * sin(theta + 0.25f * i),       0.0f), color, glm::vec2(0.5f, 0.5f));
-			vertices.emplace_back(glm::vec3(1.0f * cos(theta + 0.25f * (i + 1)), 1.0f * sin(theta + 0.25f * (i + 1)), 0.0f), color, glm::vec2(0.5f, 0.5f));
-			vertices.emplace_back(glm::vec3(1.35f * cos(theta + 0.25f * i),       1.35f * sin(theta + 0.25f * i),       0.0f), color, glm::vec2(0.5f, 0.5f));
-			
-			vertices.emplace_back(glm::vec3(1.0f * cos(theta + 0.25f * (i + 1)), 1.0f * sin(theta + 0.25f * (i + 1)), 0.0f), color, glm::vec2(0.5f, 0.5f));
-			vertices.emplace_back(glm::vec3(1.35f * cos(theta + 0.25f * i),       1.35f * sin(theta + 0.25f * i),       0.0f), color, glm::vec2(0.5f, 0.5f));
-			vertices.emplace_back(glm::vec3(1.35f * cos(theta + 0.25f * (i + 1)), 1.35f * sin(theta + 0.25f * (i + 1)), 0.0f), color, glm::vec2(0.5f, 0.5f));
+	//inline helper function for rectangle drawing:
+	auto draw_rectangle = [&vertices, &indices, &begin_strip](glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color) {
+		//draw rectangle as a four-vertex (two CCW-oriented triangle) strip:
+		begin_strip();
+		GLushort base = GLushort(vertices.size());
+		vertices.emplace_back(glm::vec2(center.x - radius.x, center.y - radius.y), color);
+		vertices.emplace_back(glm::vec2(center.x + radius.x, center.y - radius.y), color);
+		vertices.emplace_back(glm::vec2(center.x - radius.x, center.y + radius.y), color);
+		vertices.emplace_back(glm::vec2(center.x + radius.x, center.y + radius.y), color);
+		for (GLushort i = 0; i < 4; ++i) {
+			indices.emplace_back(base + i);
 		}
 	};
 
@@ -407,21 +344,7 @@ void NewMode::draw(glm::uvec2 const &drawable_size) {
 
 	//things that should only be drawn if health is greater than zero
 	if (health > 0) {
-		//shadow for the paddle
-		draw_arc(arc_paddle + s, shadow_color);
-
-		//draw center point to be protected
-		draw_rectangle(glm::vec2(0.0f, 0.0f), ball_radius, fg_color);
-
-		//paddle:
-		draw_arc(arc_paddle, fg_color);
-
-		//ball:
-		for (int i = 0; i < 7; i++) {
-			if (balls[i].x != 12.0f) {
-				draw_rectangle(balls[i], ball_radius, fg_color);
-			}
-		}
+		//(the paddle, its shadow, the center point, and the balls are drawn as Shape-s below)
 
 		//health:
 		uint32_t max_i = health;
@@ -485,49 +408,131 @@ void NewMode::draw(glm::uvec2 const &drawable_size) {
 		glm::vec2(center.x, center.y)
 	);
 
+	//---- late latch ----
+	//re-read the mouse as late as possible, so the paddle reflects where the mouse is now rather than
+	// where it was when this frame's events were polled (the vertices don't depend on the paddle angle):
+	//(a controller or a broadcast moves the paddle in the game itself, so draw it from there)
+	//(so does pausing: while paused the mouse isn't input, so show the paddle the game last accepted)
+	bool is_paused = paused();
+	if (controller || spectator_source || is_paused) arc_paddle = state.arc_paddle;
+
+	if (Input::late_latch && !controller && !spectator_source && !is_paused && health > 0) {
+		arc_paddle = mouse_to_court(Input::latch_mouse(), Mode::window_size);
+		if (sim_thread.joinable()) {
+			paddle_input.back() = arc_paddle;
+			paddle_input.publish();
+		}
+	}
+
+	//---- shapes ----
+	//(built after the late latch, since the paddle's angle is part of its Shape)
+
+	//one quad each, antialiased by ShapeProgram (see ShapeProgram.hpp):
+	std::vector< Shape > shapes;
+	if (health > 0) {
+		//the paddle is the part of the ring from radius 1.0 to 1.35 within 0.5 radians of the paddle direction:
+		auto paddle_arc = [](glm::vec2 const &at, glm::u8vec4 const &color) {
+			return Shape::annular_sector(glm::vec2(0.0f), 1.0f, 1.35f, std::atan2(at.y, at.x), 0.5f, color);
+		};
+
+		//shadow for the paddle:
+		shapes.emplace_back(paddle_arc(arc_paddle + s, shadow_color));
+
+		//center point to be protected:
+		shapes.emplace_back(Shape::circle(glm::vec2(0.0f), ball_radius.x, fg_color));
+
+		//paddle:
+		shapes.emplace_back(paddle_arc(arc_paddle, fg_color));
+
+		//balls (unless they are drawn blurred, below):
+		if (!blur) {
+			for (int i = 0; i < 7; i++) {
+				if (balls[i].x != 12.0f) {
+					shapes.emplace_back(Shape::circle(balls[i], ball_radius.x, fg_color));
+				}
+			}
+		}
+	}
+
+	//blurred balls, as (position, distance moved since the last frame was drawn):
+	// (so balls that aren't moving -- e.g., while paused -- aren't streaked; a ball that moved further
+	//  than it could have in 1/15th of a second -- a slow 1/30th-second frame, with 2x margin -- was
+	//  just spawned or the game restarted, so it isn't either)
+	std::vector< glm::vec4 > blurred_balls;
+	if (blur && health > 0) {
+		float max_move = 2.0f * state.speed_multiplier() * (1.0f / 30.0f); //(2x margin on a 1/30 s frame)
+		for (int i = 0; i < 7; i++) {
+			if (balls[i].x != 12.0f) {
+				glm::vec2 moved = balls[i] - last_balls[i];
+				if (glm::length(moved) > max_move * glm::length(state.ball_velocities[i])) moved = glm::vec2(0.0f);
+				blurred_balls.emplace_back(balls[i], moved);
+			}
+		}
+	}
+	for (int i = 0; i < 7; i++) {
+		last_balls[i] = balls[i];
+	}
+
 	//---- actual drawing ----
+	PROFILE_ZONE("NewMode::draw GL calls");
 
 	//clear the color buffer:
-	glClearColor(bg_color.r / 255.0f, bg_color.g / 255.0f, bg_color.b / 255.0f, bg_color.a / 255.0f);
+	GLState::clear_color(bg_color.r / 255.0f, bg_color.g / 255.0f, bg_color.b / 255.0f, bg_color.a / 255.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	//use alpha blending:
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLState::enable(GL_BLEND);
+	GLState::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	//don't use the depth test:
-	glDisable(GL_DEPTH_TEST);
+	GLState::disable(GL_DEPTH_TEST);
 
 	//upload vertices to vertex_buffer:
-	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer); //set vertex_buffer as current
+	GLState::bind_buffer(GL_ARRAY_BUFFER, vertex_buffer->name); //set vertex_buffer as current
 	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertices[0]), vertices.data(), GL_STREAM_DRAW); //upload vertices array
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	//set color_texture_program as current program:
-	glUseProgram(color_texture_program.program);
-
-	//upload OBJECT_TO_CLIP to the proper uniform location:
-	glUniformMatrix4fv(color_texture_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
 
-	//use the mapping vertex_buffer_for_color_texture_program to fetch vertex data:
-	glBindVertexArray(vertex_buffer_for_color_texture_program);
+	//set program as current program:
+	GLState::use_program(program->program);
 
-	//bind the solid white texture to location zero so things will be drawn just with their colors:
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, white_tex);
+	//use the mapping vertex_buffer_for_program to fetch vertex data:
+	GLState::bind_vertex_array(vertex_buffer_for_program->name);
 
-	//run the OpenGL pipeline:
-	glDrawArrays(GL_TRIANGLES, 0, GLsizei(vertices.size()));
+	//upload indices to index_buffer (already bound as the vertex array object's element array buffer):
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(indices[0]), indices.data(), GL_STREAM_DRAW);
 
-	//unbind the solid white texture:
-	glBindTexture(GL_TEXTURE_2D, 0);
+	//if the layout is textured, bind the solid white texture to location zero so things will be drawn just with their colors:
+	if (Vertex::UsesTexture) {
+		GLState::active_texture(GL_TEXTURE0);
+		GLState::bind_texture(GL_TEXTURE_2D, white_tex->tex);
+	}
 
-	//reset vertex array to none:
-	glBindVertexArray(0);
+	//run the OpenGL pipeline, restarting the triangle strip at every restart_index:
+	GLState::enable(GL_PRIMITIVE_RESTART);
+	GLState::primitive_restart_index(restart_index);
+	glUniformMatrix4fv(program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
+	glDrawElements(GL_TRIANGLE_STRIP, GLsizei(indices.size()), GL_UNSIGNED_SHORT, (GLbyte *)0);
+
+	//draw the shapes on top, as one instanced draw:
+	if (!shapes.empty()) {
+		GLState::bind_buffer(GL_ARRAY_BUFFER, shape_buffer->name);
+		glBufferData(GL_ARRAY_BUFFER, shapes.size() * sizeof(shapes[0]), shapes.data(), GL_STREAM_DRAW);
+
+		GLState::use_program(shape_program->program);
+		glUniformMatrix4fv(shape_program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
+		//(the visible court spans 2 / scale units over the window's height)
+		glUniform1f(shape_program->PIXEL_SIZE_float, 2.0f / (scale * drawable_size.y));
+		GLState::bind_vertex_array(shapes_for_program->name);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(shapes.size()));
+	}
 
-	//reset current program to none:
-	glUseProgram(0);
+	//draw the blurred balls on top (into the ball layer, then composited):
+	if (!blurred_balls.empty()) {
+		blur->draw(blurred_balls, ball_radius.x, glm::vec4(fg_color) / 255.0f, court_to_clip, 2.0f / (scale * drawable_size.y), drawable_size);
+	}
 
+	//(the state set above is left as-is, so next frame's identical calls are skipped -- see GLState.hpp)
 
 	GL_ERRORS(); //PARANOIA: print errors just in case we did something wrong.
 
+	draw_ns += uint64_t(std::chrono::duration_cast< std::chrono::nanoseconds >(std::chrono::steady_clock::now() - draw_start).count());
+	sim_busy_ns_during_draw += sim_busy_ns - sim_busy_ns_at_start;
 }
\ No newline at end of file
@@ -1,15 +1,28 @@
-#include "ColorTextureProgram.hpp"
+#include "BallDefender.hpp"
+#include "PaddleController.hpp"
+#include "SpectatorStream.hpp"
+#include "TripleBuffer.hpp"
+#include "Vertex2D.hpp"
+#include "ShapeProgram.hpp"
+#include "MotionBlur.hpp"
+#include "Texture.hpp"
+#include "GLResourcePool.hpp"
 
 #include "Mode.hpp"
 #include "GL.hpp"
 
 #include <glm/glm.hpp>
 
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
 #include <vector>
 #include <deque>
 
 /*
  * NewMode is a game mode that implements a single-player game of Not-Pong.
+ * (The rules are in BallDefender; NewMode handles input and drawing.)
  */
 
 struct NewMode : Mode {
@@ -17,50 +30,116 @@ struct NewMode : Mode {
 	virtual ~NewMode();
 
 	//functions called by main loop:
+	virtual bool load_step() override;
 	virtual bool handle_event(SDL_Event const &, glm::uvec2 const &window_size) override;
+	virtual void handle_input(Input const &, glm::uvec2 const &window_size) override;
 	virtual void update(float elapsed) override;
 	virtual void draw(glm::uvec2 const &drawable_size) override;
 
+	//convert a mouse position (window pixels) to court coordinates (using the most recently computed clip_to_court):
+	glm::vec2 mouse_to_court(glm::ivec2 const &mouse, glm::uvec2 const &window_size) const;
+
 	//----- game state -----
 
-	glm::vec2 court_radius = glm::vec2(7.0f, 5.0f);
-	glm::vec2 paddle_radius = glm::vec2(0.2f, 1.0f);
-	glm::vec2 ball_radius = glm::vec2(0.2f, 0.2f);
+	//the game itself (updated here, or on the simulation thread if it is running):
+	BallDefender game;
 
+	//where the player wants the paddle (copied into the game before each update):
 	glm::vec2 arc_paddle = glm::vec2(1.0f, 0.0f);
 
-	//multiple balls, with the first already in the game at the start
-	glm::vec2 balls[7] = { glm::vec2(6.0f, 0.0f), glm::vec2(12.0f, 0.0f), glm::vec2(12.0f, 0.0f), glm::vec2(12.0f, 0.0f), glm::vec2(12.0f, 0.0f),
-	                       glm::vec2(12.0f, 0.0f), glm::vec2(12.0f, 0.0f) };
-	glm::vec2 ball_velocities[7] = { glm::vec2(-1.0f, 0.0f), glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 0.0f),
-	                                 glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 0.0f) };
-
-	uint32_t health = 5;
-	uint32_t num_collisions = 11; //initially set to 11 so NewMode will spawn the second ball after the first wall collision
+	//----- optional paddle controller -----
+	//if set, drives the paddle instead of the mouse (see PaddleController.hpp):
+	std::shared_ptr< PaddleController > controller;
+	//used to create 'controller' for each new NewMode (set by main.cpp's --bot and --script-paddle):
+	static std::function< std::shared_ptr< PaddleController >() > make_controller;
+
+	//if non-empty, paddle angles are recorded and saved (as a ScriptPaddle script) to this file when the mode ends:
+	static std::string record_paddle;
+	std::vector< ScriptPaddle::Key > recording;
+	float game_time = 0.0f;
+
+	//if non-empty, F5 saves the game to this file and F9 loads it back (set by main.cpp's --snapshot):
+	static std::string snapshot_file;
+
+	//----- optional spectating (see SpectatorStream.hpp) -----
+	//if set, every game step is broadcast to local viewers (main.cpp's --broadcast):
+	static std::shared_ptr< SpectatorServer > spectator_server;
+	//if set, the game isn't played here; it shows the frames this receives instead (main.cpp's --spectate):
+	static std::shared_ptr< SpectatorViewer > spectator_source;
+
+	//----- drawing options -----
+	//draw the balls streaked along their motion over the last frame (see MotionBlur.hpp); main.cpp's --no-motion-blur clears it:
+	static bool motion_blur;
+
+	//advance the game by 'elapsed', with the paddle from controller (if set) or at 'requested':
+	void step_game(float elapsed, glm::vec2 const &requested);
+
+	//----- optional simulation thread -----
+	//if non-zero, the game is updated on its own thread at this many steps per second,
+	// and draw() shows the latest finished step; set before creating the mode (main.cpp's --sim-thread):
+	static float sim_thread_rate;
+
+	std::thread sim_thread;
+	void run_sim(); //(body of sim_thread)
+	std::atomic< bool > sim_quit{ false };
+
+	//game time update() has allowed the simulation thread to run (in microseconds):
+	// (so the simulation stops when the mode isn't updated, e.g., while paused)
+	std::atomic< uint64_t > sim_budget_us{ 0 };
+
+	//simulation thread -> draw(): finished game states:
+	TripleBuffer< BallDefender > snapshots;
+	//handle_input() -> simulation thread: paddle position:
+	TripleBuffer< glm::vec2 > paddle_input;
+
+	//----- simulation thread metrics -----
+	//(printed by update() every few seconds)
+	std::atomic< uint64_t > sim_steps{ 0 };
+	std::atomic< uint64_t > sim_busy_ns{ 0 }; //time spent inside BallDefender::update
+	uint64_t sim_busy_ns_during_draw = 0; //how much of that time passed while draw() was running
+	uint64_t draw_ns = 0; //time spent in draw()
+	float report_timer = 0.0f;
+
+	//the game state to draw (game, or the latest snapshot):
+	BallDefender const &view() const;
 
 	//----- opengl assets / helpers ------
+	//(all shared with other modes through GLResourcePool)
 
-	//draw functions will work on vectors of vertices, defined as follows:
-	struct Vertex {
-		Vertex(glm::vec3 const &Position_, glm::u8vec4 const &Color_, glm::vec2 const &TexCoord_) :
-			Position(Position_), Color(Color_), TexCoord(TexCoord_) { }
-		glm::vec3 Position;
-		glm::u8vec4 Color;
-		glm::vec2 TexCoord;
-	};
-	static_assert(sizeof(Vertex) == 4 * 3 + 1 * 4 + 4 * 2, "NewMode::Vertex should be packed");
+	//draw functions will work on vectors of vertices, using one of the layouts from Vertex2D.hpp:
+	// (PosColVertex is 12 bytes; swap in HalfPosColVertex for 8 bytes or PosColTexVertex for textured drawing)
+	typedef PosColVertex Vertex;
 
-	//Shader program that draws transformed, vertices tinted with vertex colors:
-	ColorTextureProgram color_texture_program;
+	//Shader program that draws transformed vertices in the chosen layout:
+	std::shared_ptr< Vertex::Program > program;
 
 	//Buffer used to hold vertex data during drawing:
-	GLuint vertex_buffer = 0;
+	std::shared_ptr< GLBuffer > vertex_buffer;
+
+	//Buffer used to hold index data (triangle strips separated by a restart index) during drawing:
+	std::shared_ptr< GLBuffer > index_buffer;
+
+	//Vertex Array Object that maps buffer locations to program attribute locations:
+	// (also records index_buffer as its element array buffer)
+	std::shared_ptr< GLVertexArray > vertex_buffer_for_program;
+
+	//Solid white texture (bound when Vertex::UsesTexture; shared with other modes):
+	std::shared_ptr< Texture > white_tex;
+
+	//Program that draws the balls, center point, and paddle arcs from their distance functions, one quad each:
+	std::shared_ptr< ShapeProgram > shape_program;
+
+	//Corners of the quad (square_corners_buffer()) and per-frame Shape-s:
+	std::shared_ptr< GLBuffer > corner_buffer;
+	std::shared_ptr< GLBuffer > shape_buffer;
 
-	//Vertex Array Object that maps buffer locations to color_texture_program attribute locations:
-	GLuint vertex_buffer_for_color_texture_program = 0;
+	//Vertex Array Object that reads corner_buffer per vertex and shape_buffer per instance:
+	std::shared_ptr< GLVertexArray > shapes_for_program;
 
-	//Solid white texture:
-	GLuint white_tex = 0;
+	//Ball layer that draws the balls motion-blurred (when motion_blur is set):
+	std::shared_ptr< MotionBlur > blur;
+	//where the balls were when the last frame was drawn (each is blurred along its path since then):
+	glm::vec2 last_balls[7];
 
 	//matrix that maps from clip coordinates to court-space coordinates:
 	glm::mat3x2 clip_to_court = glm::mat3x2(1.0f);
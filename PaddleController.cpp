@@ -0,0 +1,101 @@
+#include "PaddleController.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+BotPaddle::BotPaddle(uint32_t seed) : mt(seed) {
+}
+
+glm::vec2 BotPaddle::paddle(BallDefender const &game, float elapsed) {
+	std::uniform_real_distribution< float > unit(0.0f, 1.0f);
+
+	decide_timer -= elapsed;
+	if (decide_timer <= 0.0f) {
+		decide_timer = reaction * (0.5f + unit(mt));
+
+		//find the ball heading inward that will reach the arc soonest:
+		float best_time = std::numeric_limits< float >::infinity();
+		for (uint32_t i = 0; i < 7; ++i) {
+			glm::vec2 at = game.balls[i];
+			glm::vec2 vel = game.ball_velocities[i];
+			if (at.x == 12.0f) continue; //(inactive)
+			float r = glm::length(at);
+			float inward = -glm::dot(at, vel) / std::max(r, 1e-6f);
+			if (inward <= 0.0f) continue;
+			float time = (r - 1.35f) / inward;
+			if (time < best_time) {
+				best_time = time;
+				glm::vec2 meet = at + std::max(0.0f, time) * vel;
+				target_theta = std::atan2(meet.y, meet.x) + aim_error * (2.0f * unit(mt) - 1.0f);
+			}
+		}
+	}
+
+	//turn toward the target (the short way around), no faster than turn_rate:
+	float d = target_theta - theta;
+	d -= 6.2831853f * std::floor((d + 3.1415927f) / 6.2831853f);
+	theta += glm::clamp(d, -turn_rate * elapsed, turn_rate * elapsed);
+
+	return glm::vec2(std::cos(theta), std::sin(theta));
+}
+
+ScriptPaddle::ScriptPaddle(std::vector< Key > const &keys_, bool loop_) : keys(keys_), loop(loop_) {
+	std::stable_sort(keys.begin(), keys.end(), [](Key const &a, Key const &b){ return a.time < b.time; });
+}
+
+std::vector< ScriptPaddle::Key > ScriptPaddle::load(std::string const &filename) {
+	std::ifstream in(filename);
+	if (!in) throw std::runtime_error("Failed to open paddle script '" + filename + "'.");
+	std::vector< Key > keys;
+	std::string line;
+	uint32_t line_number = 0;
+	while (std::getline(in, line)) {
+		line_number += 1;
+		line = line.substr(0, line.find('#'));
+		std::istringstream str(line);
+		Key key;
+		if (!(str >> key.time)) continue; //(blank line)
+		if (!(str >> key.angle)) {
+			throw std::runtime_error("Paddle script '" + filename + "' line " + std::to_string(line_number) + " should be '<seconds> <radians>'.");
+		}
+		keys.emplace_back(key);
+	}
+	if (keys.empty()) throw std::runtime_error("Paddle script '" + filename + "' has no keys.");
+	return keys;
+}
+
+void ScriptPaddle::save(std::string const &filename, std::vector< Key > const &keys) {
+	std::ofstream out(filename);
+	if (!out) throw std::runtime_error("Failed to open '" + filename + "' for writing.");
+	out << "#seconds radians\n";
+	for (auto const &key : keys) {
+		out << key.time << ' ' << key.angle << '\n';
+	}
+}
+
+glm::vec2 ScriptPaddle::paddle(BallDefender const &game, float elapsed) {
+	time += elapsed;
+	if (keys.empty()) return game.arc_paddle;
+
+	float end = keys.back().time;
+	float at = time;
+	if (loop && end > 0.0f) at = std::fmod(time, end);
+
+	//find the pair of keys around 'at' and interpolate:
+	float angle;
+	auto next = std::upper_bound(keys.begin(), keys.end(), at, [](float t, Key const &key){ return t < key.time; });
+	if (next == keys.begin()) {
+		angle = next->angle;
+	} else if (next == keys.end()) {
+		angle = keys.back().angle;
+	} else {
+		auto prev = next - 1;
+		float amt = (at - prev->time) / std::max(1e-6f, next->time - prev->time);
+		angle = prev->angle + amt * (next->angle - prev->angle);
+	}
+	return glm::vec2(std::cos(angle), std::sin(angle));
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "BallDefender.hpp"
+
+#include <glm/glm.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * PaddleControllers move Ball Defender's paddle instead of the mouse, so the game can
+ *  run unattended (e.g., long profiling sessions, or batch_sim's headless games).
+ *
+ * paddle() is called before every BallDefender::update and returns the direction the
+ *  paddle should point (it is assigned to arc_paddle).
+ */
+
+struct PaddleController {
+	virtual ~PaddleController() { }
+	virtual glm::vec2 paddle(BallDefender const &game, float elapsed) = 0;
+};
+
+//BotPaddle aims at the inward-moving ball that will reach the arc first, with a human-ish
+// reaction time, turn rate, and aim error (so it doesn't play forever unless told to):
+struct BotPaddle : PaddleController {
+	BotPaddle(uint32_t seed = 0);
+	virtual glm::vec2 paddle(BallDefender const &game, float elapsed) override;
+
+	//skill (set all three to zero-ish values for a bot that (almost) never misses):
+	float reaction = 0.15f; //seconds between picking targets (randomized +/-50% per decision)
+	float turn_rate = 6.0f; //radians per second the paddle can turn
+	float aim_error = 0.15f; //radians of random aim error per decision
+
+	std::mt19937 mt;
+	float theta = 0.0f; //paddle angle
+	float target_theta = 0.0f; //where the bot wants it
+	float decide_timer = 0.0f;
+};
+
+//ScriptPaddle plays back a list of (time, angle) keys, interpolating between them:
+// script files have one "<seconds> <radians>" key per line ('#' starts a comment);
+// angles aren't wrapped, so 0 -> 6.28 is one full turn counter-clockwise.
+struct ScriptPaddle : PaddleController {
+	struct Key {
+		float time;
+		float angle;
+	};
+	ScriptPaddle(std::vector< Key > const &keys, bool loop = true);
+	static std::vector< Key > load(std::string const &filename); //NOTE: throws on error
+	static void save(std::string const &filename, std::vector< Key > const &keys);
+
+	virtual glm::vec2 paddle(BallDefender const &game, float elapsed) override;
+
+	std::vector< Key > keys; //sorted by time
+	bool loop; //start over after the last key (otherwise hold the last angle)
+	float time = 0.0f;
+};
@@ -0,0 +1,60 @@
+#include "PauseMode.hpp"
+
+//for the GL_ERRORS() macro:
+#include "gl_errors.hpp"
+
+
+PauseMode::PauseMode(std::function< std::shared_ptr< Mode >() > const &restart_) : restart(restart_) {
+}
+
+PauseMode::~PauseMode() {
+}
+
+bool PauseMode::load_step() {
+	//pooled, so pausing again never compiles or allocates anything:
+	batch = GLResourcePool::get< BatchRenderer >();
+	return true;
+}
+
+bool PauseMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size) {
+	//let the main loop see quit requests:
+	if (evt.type == SDL_QUIT) return false;
+
+	if (evt.type == SDL_KEYDOWN) {
+		if (evt.key.keysym.sym == SDLK_ESCAPE || evt.key.keysym.sym == SDLK_SPACE) {
+			Mode::pop();
+		} else if (evt.key.keysym.sym == SDLK_r && restart) {
+			//the paused mode keeps drawing (still paused) until the new one has finished loading:
+			Mode::set_current_async(restart());
+		}
+	}
+
+	//swallow everything else so the paused mode doesn't react:
+	return true;
+}
+
+void PauseMode::draw(glm::uvec2 const &drawable_size) {
+	const glm::u8vec4 dim_color = glm::u8vec4(0x17, 0x17, 0x14, 0xb0);
+	const glm::u8vec4 fg_color = glm::u8vec4(0xd1, 0xbb, 0x54, 0xff);
+
+	//draw in a [-aspect,aspect]x[-1,1] space so the bars stay square:
+	float aspect = drawable_size.x / float(drawable_size.y);
+
+	//dim everything (layer 0), then the pause symbol on top (layer 1):
+	batch->rectangle(0, glm::vec2(0.0f, 0.0f), glm::vec2(aspect, 1.0f), dim_color);
+	batch->rectangle(1, glm::vec2(-0.1f, 0.0f), glm::vec2(0.05f, 0.2f), fg_color);
+	batch->rectangle(1, glm::vec2( 0.1f, 0.0f), glm::vec2(0.05f, 0.2f), fg_color);
+
+	glm::mat4 object_to_clip = glm::mat4(
+		glm::vec4(1.0f / aspect, 0.0f, 0.0f, 0.0f),
+		glm::vec4(0.0f, 1.0f, 0.0f, 0.0f),
+		glm::vec4(0.0f, 0.0f, 1.0f, 0.0f),
+		glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)
+	);
+
+	//---- actual drawing (no clear -- this goes on top of the paused mode) ----
+	//(all three rectangles use the same program, texture, and blending, so this is one draw)
+	batch->flush(object_to_clip);
+
+	GL_ERRORS(); //PARANOIA: print errors just in case we did something wrong.
+}
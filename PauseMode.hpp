@@ -0,0 +1,35 @@
+#pragma once
+
+#include "BatchRenderer.hpp"
+#include "GLResourcePool.hpp"
+
+#include "Mode.hpp"
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <functional>
+
+/*
+ * PauseMode is an overlay (see Mode::push) that dims the mode below it and stops it from updating.
+ *  Escape or Space resumes; R restarts by asynchronously loading a fresh mode from 'restart'.
+ */
+
+struct PauseMode : Mode {
+	PauseMode(std::function< std::shared_ptr< Mode >() > const &restart);
+	virtual ~PauseMode();
+
+	//functions called by main loop:
+	virtual bool load_step() override;
+	virtual bool handle_event(SDL_Event const &, glm::uvec2 const &window_size) override;
+	virtual void draw(glm::uvec2 const &drawable_size) override;
+	virtual bool pauses_below() const override { return true; }
+
+	//makes the mode to switch to on restart:
+	std::function< std::shared_ptr< Mode >() > restart;
+
+	//----- opengl assets / helpers ------
+	//(shared with other modes through GLResourcePool)
+
+	std::shared_ptr< BatchRenderer > batch;
+};
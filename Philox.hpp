@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Philox4x32-10 counter-based random number generator
+ *  (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC '11).
+ *
+ * Unlike std::mt19937, there is no generator state to carry around: the output is a
+ *  pure function of a 128-bit counter and a 64-bit key. So the n-th random number for
+ *  the i-th object can be computed directly as philox({i, n, ...}, key) -- in any
+ *  order, on any thread, in SIMD batches -- and always comes out the same.
+ */
+
+struct Philox {
+	struct Block {
+		uint32_t x[4];
+	};
+
+	static inline Block generate(Block ctr, uint32_t key0, uint32_t key1) {
+		for (uint32_t round = 0; round < 10; ++round) {
+			uint64_t p0 = uint64_t(0xD2511F53U) * ctr.x[0];
+			uint64_t p1 = uint64_t(0xCD9E8D57U) * ctr.x[2];
+			Block next;
+			next.x[0] = uint32_t(p1 >> 32) ^ ctr.x[1] ^ key0;
+			next.x[1] = uint32_t(p1);
+			next.x[2] = uint32_t(p0 >> 32) ^ ctr.x[3] ^ key1;
+			next.x[3] = uint32_t(p0);
+			ctr = next;
+			key0 += 0x9E3779B9U;
+			key1 += 0xBB67AE85U;
+		}
+		return ctr;
+	}
+
+	//uniform float in [0,1) from the top 24 bits of 'bits':
+	static inline float to_unit(uint32_t bits) {
+		return float(bits >> 8) * (1.0f / 16777216.0f);
+	}
+};
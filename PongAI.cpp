@@ -0,0 +1,74 @@
+#include "PongAI.hpp"
+
+#include "Philox.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+
+PongAI::PongAI(uint32_t count, uint32_t seed_) : seed(seed_) {
+	resize(count);
+}
+
+void PongAI::resize(uint32_t count) {
+	paddle_y.resize(count, 0.0f);
+	offset.resize(count, 0.0f);
+	offset_timer.resize(count, 0.0f);
+	decisions.resize(count, 0);
+}
+
+//update AIs [begin,end):
+// (timers and chasing are plain loops over arrays, so they vectorize; random numbers are only
+//  needed for the few AIs picking a new offset this frame, so those are gathered up first)
+void PongAI::update_range(uint32_t begin, uint32_t end, float elapsed, float const *ball_y, float paddle_min, float paddle_max) {
+	float *__restrict paddle_y = this->paddle_y.data();
+	float *__restrict offset = this->offset.data();
+	float *__restrict offset_timer = this->offset_timer.data();
+	uint32_t *__restrict decisions = this->decisions.data();
+	const float step = 2.0f * elapsed;
+
+	//AIs are handled in groups of Lanes:
+	const uint32_t Lanes = 16;
+	for (uint32_t group = begin; group < end; group += Lanes) {
+		uint32_t count = std::min(Lanes, end - group);
+
+		//count down timers, and note which AIs need a new offset:
+		// (each AI only decides every 0.5-1 seconds, so most groups have few or none;
+		//  computing Philox for every lane and selecting measured ~1.5x slower than this)
+		uint32_t deciding[Lanes];
+		uint32_t deciding_count = 0;
+		for (uint32_t l = 0; l < count; ++l) {
+			uint32_t i = group + l;
+			offset_timer[i] -= elapsed;
+			deciding[deciding_count] = i;
+			deciding_count += (offset_timer[i] < elapsed ? 1 : 0);
+		}
+
+		//update again in [0.5,1.0) seconds, aiming within [-1.25,1.25) of the ball:
+		// (random numbers come from counter = (index, decision number), so they don't depend on update order)
+		for (uint32_t l = 0; l < deciding_count; ++l) {
+			uint32_t i = deciding[l];
+			Philox::Block r = Philox::generate({{ i, decisions[i], 0, 0 }}, seed, 0x5ea7U);
+			offset_timer[i] = Philox::to_unit(r.x[0]) * 0.5f + 0.5f;
+			offset[i] = Philox::to_unit(r.x[1]) * 2.5f - 1.25f;
+			decisions[i] += 1;
+		}
+
+		//chase the target, no faster than 'step', then clamp to the court:
+		for (uint32_t l = 0; l < count; ++l) {
+			uint32_t i = group + l;
+			float target = ball_y[i] + offset[i];
+			float y = std::min(std::max(target, paddle_y[i] - step), paddle_y[i] + step);
+			paddle_y[i] = std::min(std::max(y, paddle_min), paddle_max);
+		}
+	}
+}
+
+void PongAI::update(float elapsed, float const *ball_y, float paddle_min, float paddle_max, WorkStealingPool *pool) {
+	if (pool && size() > Batch) {
+		pool->parallel_for(size(), Batch, [&](uint32_t begin, uint32_t end, uint32_t) {
+			update_range(begin, end, elapsed, ball_y, paddle_min, paddle_max);
+		});
+	} else {
+		update_range(0, size(), elapsed, ball_y, paddle_min, paddle_max);
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct WorkStealingPool;
+
+/*
+ * PongAI updates any number of PongMode-style AI paddles at once.
+ *
+ * Each AI chases its ball's y position plus a random offset, picking a new
+ *  offset every [0.5,1.0) seconds, and moves at most 2 units per second.
+ *
+ * State is kept as structure-of-arrays and updated in groups of 16, with
+ *  branch-free loops for the timers and paddle motion (so the compiler can
+ *  vectorize them); random offsets come from Philox, a counter-based generator,
+ *  for just the AIs whose timers ran out. Large batches are split over a
+ *  WorkStealingPool.
+ *
+ * The n-th offset of AI i is a pure function of (seed, i, n), so results are
+ *  identical no matter how many threads (or which batch sizes) are used.
+ */
+
+struct PongAI {
+	PongAI(uint32_t count = 0, uint32_t seed = 0);
+
+	//add or remove AIs (new ones start centered, deciding on their first update):
+	void resize(uint32_t count);
+	uint32_t size() const { return uint32_t(paddle_y.size()); }
+
+	//advance all AIs by 'elapsed' seconds; ball_y[i] is the y position of AI i's ball;
+	// paddles stay within [paddle_min, paddle_max]; pass a pool to update in parallel:
+	void update(float elapsed, float const *ball_y, float paddle_min, float paddle_max, WorkStealingPool *pool = nullptr);
+	//...or just AIs [begin,end) (e.g., when the caller is already splitting work into chunks):
+	void update_range(uint32_t begin, uint32_t end, float elapsed, float const *ball_y, float paddle_min, float paddle_max);
+
+	//----- state (one entry per AI) -----
+	std::vector< float > paddle_y; //paddle position
+	std::vector< float > offset; //where the AI aims, relative to the ball
+	std::vector< float > offset_timer; //seconds until a new offset is picked
+	std::vector< uint32_t > decisions; //number of offsets picked so far (Philox counter)
+
+	uint32_t seed;
+
+	//AIs per parallel_for chunk:
+	static constexpr uint32_t Batch = 1024;
+};
@@ -0,0 +1,161 @@
+#include "PongCourts.hpp"
+
+#include "Philox.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+PongCourts::PongCourts(uint32_t count, uint32_t seed_) : seed(seed_), left_ai(0, seed_ * 2 + 0), right_ai(0, seed_ * 2 + 1) {
+	resize(count);
+}
+
+void PongCourts::resize(uint32_t count) {
+	uint32_t old_count = size();
+
+	ball_x.resize(count, 0.0f);
+	ball_y.resize(count, 0.0f);
+	ball_vx.resize(count, -1.0f);
+	ball_vy.resize(count, 0.0f);
+	left_score.resize(count, 0);
+	right_score.resize(count, 0);
+	left_ai.resize(count);
+	right_ai.resize(count);
+	right_player.resize(count, 0);
+	right_input.resize(count, 0.0f);
+	active.resize(count, 1);
+
+	for (uint32_t i = old_count; i < count; ++i) {
+		serve(i);
+	}
+}
+
+void PongCourts::reset(uint32_t court) {
+	left_score[court] = 0;
+	right_score[court] = 0;
+	left_ai.paddle_y[court] = 0.0f;
+	right_ai.paddle_y[court] = 0.0f;
+	right_input[court] = 0.0f;
+	serve(court);
+}
+
+void PongCourts::serve(uint32_t court) {
+	//serve balls in slightly different directions, so the courts don't all play the same game:
+	Philox::Block r = Philox::generate({{ court, serves, 0, 0 }}, seed, 0xc0U);
+	serves += 1;
+	ball_x[court] = 0.0f;
+	ball_y[court] = 0.0f;
+	ball_vx[court] = (r.x[0] & 1) ? 1.0f : -1.0f;
+	ball_vy[court] = Philox::to_unit(r.x[1]) - 0.5f;
+}
+
+void PongCourts::update(float elapsed, WorkStealingPool *pool) {
+	if (pool && size() > Batch) {
+		pool->parallel_for(size(), Batch, [&](uint32_t begin, uint32_t end, uint32_t) {
+			update_range(begin, end, elapsed);
+		});
+	} else {
+		update_range(0, size(), elapsed);
+	}
+}
+
+void PongCourts::update_range(uint32_t begin, uint32_t end, float elapsed) {
+	//inactive courts cost only this scan:
+	// (contiguous runs of active courts are updated together, so the AIs still work in full groups)
+	uint32_t i = begin;
+	while (i < end) {
+		while (i < end && !active[i]) ++i;
+		uint32_t run_begin = i;
+		while (i < end && active[i]) ++i;
+		if (run_begin < i) update_run(run_begin, i, elapsed);
+	}
+}
+
+void PongCourts::update_run(uint32_t begin, uint32_t end, float elapsed) {
+	//----- paddle update -----
+	float paddle_min = -court_radius.y + paddle_radius.y;
+	float paddle_max =  court_radius.y - paddle_radius.y;
+	left_ai.update_range(begin, end, elapsed, ball_y.data(), paddle_min, paddle_max);
+	right_ai.update_range(begin, end, elapsed, ball_y.data(), paddle_min, paddle_max);
+	for (uint32_t i = begin; i < end; ++i) {
+		float player = std::min(std::max(right_input[i], paddle_min), paddle_max);
+		right_ai.paddle_y[i] = (right_player[i] ? player : right_ai.paddle_y[i]);
+	}
+
+	//----- ball update -----
+	//(same rules as PongMode::update, one court at a time)
+	for (uint32_t i = begin; i < end; ++i) {
+		glm::vec2 ball = glm::vec2(ball_x[i], ball_y[i]);
+		glm::vec2 ball_velocity = glm::vec2(ball_vx[i], ball_vy[i]);
+
+		//speed of ball doubles every four points (with a cap, otherwise ball can pass through paddles):
+		float speed_multiplier = 4.0f * std::pow(2.0f, (left_score[i] + right_score[i]) / 4.0f);
+		speed_multiplier = std::min(speed_multiplier, 10.0f);
+
+		ball += elapsed * speed_multiplier * ball_velocity;
+
+		//paddles:
+		auto paddle_vs_ball = [&](glm::vec2 const &paddle) {
+			//compute area of overlap:
+			glm::vec2 min = glm::max(paddle - paddle_radius, ball - ball_radius);
+			glm::vec2 max = glm::min(paddle + paddle_radius, ball + ball_radius);
+
+			//if no overlap, no collision:
+			if (min.x > max.x || min.y > max.y) return;
+
+			if (max.x - min.x > max.y - min.y) {
+				//wider overlap in x => bounce in y direction:
+				if (ball.y > paddle.y) {
+					ball.y = paddle.y + paddle_radius.y + ball_radius.y;
+					ball_velocity.y = std::abs(ball_velocity.y);
+				} else {
+					ball.y = paddle.y - paddle_radius.y - ball_radius.y;
+					ball_velocity.y = -std::abs(ball_velocity.y);
+				}
+			} else {
+				//wider overlap in y => bounce in x direction:
+				if (ball.x > paddle.x) {
+					ball.x = paddle.x + paddle_radius.x + ball_radius.x;
+					ball_velocity.x = std::abs(ball_velocity.x);
+				} else {
+					ball.x = paddle.x - paddle_radius.x - ball_radius.x;
+					ball_velocity.x = -std::abs(ball_velocity.x);
+				}
+				//warp y velocity based on offset from paddle center:
+				float vel = (ball.y - paddle.y) / (paddle_radius.y + ball_radius.y);
+				ball_velocity.y = glm::mix(ball_velocity.y, vel, 0.75f);
+			}
+		};
+		paddle_vs_ball(glm::vec2(-paddle_x, left_ai.paddle_y[i]));
+		paddle_vs_ball(glm::vec2( paddle_x, right_ai.paddle_y[i]));
+
+		//court walls:
+		if (ball.y > court_radius.y - ball_radius.y) {
+			ball.y = court_radius.y - ball_radius.y;
+			if (ball_velocity.y > 0.0f) ball_velocity.y = -ball_velocity.y;
+		}
+		if (ball.y < -court_radius.y + ball_radius.y) {
+			ball.y = -court_radius.y + ball_radius.y;
+			if (ball_velocity.y < 0.0f) ball_velocity.y = -ball_velocity.y;
+		}
+		if (ball.x > court_radius.x - ball_radius.x) {
+			ball.x = court_radius.x - ball_radius.x;
+			if (ball_velocity.x > 0.0f) {
+				ball_velocity.x = -ball_velocity.x;
+				left_score[i] += 1;
+			}
+		}
+		if (ball.x < -court_radius.x + ball_radius.x) {
+			ball.x = -court_radius.x + ball_radius.x;
+			if (ball_velocity.x < 0.0f) {
+				ball_velocity.x = -ball_velocity.x;
+				right_score[i] += 1;
+			}
+		}
+
+		ball_x[i] = ball.x;
+		ball_y[i] = ball.y;
+		ball_vx[i] = ball_velocity.x;
+		ball_vy[i] = ball_velocity.y;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "PongAI.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+struct WorkStealingPool;
+
+/*
+ * PongCourts simulates many independent games of (AI vs AI) Pong, using PongMode's rules.
+ *
+ * Each court's state is a handful of numbers in structure-of-arrays form (court i is
+ *  index i of every array), so thousands of courts fit in a few contiguous arrays and
+ *  update() can stream through them -- in parallel chunks, if given a pool.
+ * Court sizes are shared by all courts.
+ */
+
+struct PongCourts {
+	PongCourts(uint32_t count = 0, uint32_t seed = 0);
+
+	//add or remove courts (new courts start with the ball in the center):
+	void resize(uint32_t count);
+	uint32_t size() const { return uint32_t(ball_x.size()); }
+
+	//start a new game on court i (scores zeroed, ball served from the center):
+	void reset(uint32_t court);
+
+	void update(float elapsed, WorkStealingPool *pool = nullptr);
+
+	//----- shared by all courts -----
+	glm::vec2 court_radius = glm::vec2(7.0f, 5.0f);
+	glm::vec2 paddle_radius = glm::vec2(0.2f, 1.0f);
+	glm::vec2 ball_radius = glm::vec2(0.2f, 0.2f);
+	float paddle_x = 6.5f; //paddles are at x = -paddle_x (left) and x = +paddle_x (right)
+	uint32_t seed;
+
+	//----- per court -----
+	std::vector< float > ball_x, ball_y;
+	std::vector< float > ball_vx, ball_vy;
+	std::vector< uint32_t > left_score, right_score;
+	PongAI left_ai, right_ai; //(paddle y positions are left_ai.paddle_y / right_ai.paddle_y)
+
+	//right paddles can be players' instead (e.g., pong-server's clients):
+	// where right_player[i] is non-zero, update() puts the right paddle at right_input[i] (clamped to the court)
+	std::vector< uint8_t > right_player;
+	std::vector< float > right_input;
+
+	//courts where active[i] is zero are skipped by update() (e.g., pong-server's courts whose clients left):
+	// (new courts start active)
+	std::vector< uint8_t > active;
+
+	//bytes of simulation state per court:
+	static constexpr uint32_t BytesPerCourt = 4 * sizeof(float) + 2 * sizeof(uint32_t) + 2 * (3 * sizeof(float) + sizeof(uint32_t)) + sizeof(uint8_t) + sizeof(float) + sizeof(uint8_t);
+
+	//courts per parallel_for chunk:
+	static constexpr uint32_t Batch = 1024;
+
+private:
+	void serve(uint32_t court);
+	uint32_t serves = 0; //(counter for serve directions)
+	void update_range(uint32_t begin, uint32_t end, float elapsed); //(updates each run of active courts in [begin,end))
+	void update_run(uint32_t begin, uint32_t end, float elapsed); //(updates every court in [begin,end))
+};
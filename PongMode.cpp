@@ -3,10 +3,16 @@
 //for the GL_ERRORS() macro:
 #include "gl_errors.hpp"
 
+//for cached GL state changes:
+#include "GLState.hpp"
+
+//for PROFILE_ZONE():
+#include "Profiler.hpp"
+
 //for glm::value_ptr() :
 #include <glm/gtc/type_ptr.hpp>
 
-#include <random>
+#include <algorithm>
 
 PongMode::PongMode() {
 
@@ -16,139 +22,118 @@ PongMode::PongMode() {
 	ball_trail.emplace_back(ball, 0.0f);
 
 	
-	//----- allocate OpenGL resources -----
-	{ //vertex buffer:
-		glGenBuffers(1, &vertex_buffer);
-		//for now, buffer will be un-filled.
-
-		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
-	}
+	//(OpenGL resources are fetched in load_step(), so this mode can be loaded over several frames)
+}
 
-	{ //vertex array mapping buffer for color_texture_program:
-		//ask OpenGL to fill vertex_buffer_for_color_texture_program with the name of an unused vertex array object:
-		glGenVertexArrays(1, &vertex_buffer_for_color_texture_program);
+bool PongMode::load_step() {
+	//----- get OpenGL resources, one per call -----
+	//(these come from GLResourcePool, so after the first mode is created, switching modes
+	// reuses the compiled program, buffers, vertex array, and texture instead of rebuilding them)
 
-		//set vertex_buffer_for_color_texture_program as the current vertex array object:
-		glBindVertexArray(vertex_buffer_for_color_texture_program);
+	if (!program) { //shader program for the chosen vertex layout:
+		program = GLResourcePool::get< Vertex::Program >();
+		return false;
+	}
 
-		//set vertex_buffer as the source of glVertexAttribPointer() commands:
-		glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+	if (!vertex_buffer) { //vertex + index buffers, re-filled every frame in draw():
+		vertex_buffer = GLResourcePool::get< GLBuffer >("2D stream vertices");
+		index_buffer = GLResourcePool::get< GLBuffer >("2D stream indices");
+		return false;
+	}
 
-		//set up the vertex array object to describe arrays of PongMode::Vertex:
-		glVertexAttribPointer(
-			color_texture_program.Position_vec4, //attribute
-			3, //size
-			GL_FLOAT, //type
-			GL_FALSE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte *)0 + 0 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.Position_vec4);
-		//[Note that it is okay to bind a vec3 input to a vec4 attribute -- the w component will be filled with 1.0 automatically]
-
-		glVertexAttribPointer(
-			color_texture_program.Color_vec4, //attribute
-			4, //size
-			GL_UNSIGNED_BYTE, //type
-			GL_TRUE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte *)0 + 4*3 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.Color_vec4);
-
-		glVertexAttribPointer(
-			color_texture_program.TexCoord_vec2, //attribute
-			2, //size
-			GL_FLOAT, //type
-			GL_FALSE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte *)0 + 4*3 + 4*1 //offset
+	if (!vertex_buffer_for_program) { //vertex array mapping buffer for program:
+		//the layout of Vertex decides which attributes are set up (see Vertex2D.hpp):
+		vertex_buffer_for_program = GLResourcePool::get< GLVertexArray >(
+			std::string("2D stream vertices + indices as ") + typeid(Vertex).name(), [this](){
+				return std::make_shared< GLVertexArray >(make_vertex_array< Vertex >(*program, vertex_buffer->name, index_buffer->name));
+			}
 		);
-		glEnableVertexAttribArray(color_texture_program.TexCoord_vec2);
-
-		//done referring to vertex_buffer, so unbind it:
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-		//done setting up vertex array object, so unbind it:
-		glBindVertexArray(0);
 
 		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+		return false;
 	}
 
-	{ //solid white texture:
-		//ask OpenGL to fill white_tex with the name of an unused texture object:
-		glGenTextures(1, &white_tex);
-
-		//bind that texture object as a GL_TEXTURE_2D-type texture:
-		glBindTexture(GL_TEXTURE_2D, white_tex);
-
-		//upload a 1x1 image of solid white to the texture:
-		glm::uvec2 size = glm::uvec2(1,1);
-		std::vector< glm::u8vec4 > data(size.x*size.y, glm::u8vec4(0xff, 0xff, 0xff, 0xff));
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
-
-		//set filtering and wrapping parameters:
-		//(it's a bit silly to mipmap a 1x1 texture, but I'm doing it because you may want to use this code to load different sizes of texture)
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		//since texture uses a mipmap and we haven't uploaded one, instruct opengl to make one for us:
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		//Okay, texture uploaded, can unbind it:
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+	if (!white_tex) { //solid white texture:
+		white_tex = GLResourcePool::get< Texture >("white 1x1", [](){
+			//upload a 1x1 image of solid white:
+			glm::uvec2 size = glm::uvec2(1, 1);
+			std::vector< glm::u8vec4 > data(size.x*size.y, glm::u8vec4(0xff, 0xff, 0xff, 0xff));
+			//(no mipmaps -- a 1x1 texture doesn't need them; set Texture::Options::mipmaps when loading larger images)
+			return Texture::upload(size, data, Texture::Options());
+		});
 	}
+
+	return true;
 }
 
 PongMode::~PongMode() {
-
-	//----- free OpenGL resources -----
-	glDeleteBuffers(1, &vertex_buffer);
-	vertex_buffer = 0;
-
-	glDeleteVertexArrays(1, &vertex_buffer_for_color_texture_program);
-	vertex_buffer_for_color_texture_program = 0;
-
-	glDeleteTextures(1, &white_tex);
-	white_tex = 0;
+	//OpenGL resources are pooled, so they stay alive for the next mode (see GLResourcePool).
 }
 
-bool PongMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size) {
+void PongMode::handle_input(Input const &input, glm::uvec2 const &window_size) {
 
-	if (evt.type == SDL_MOUSEMOTION) {
+	if (input.mouse_moved) {
 		//convert mouse from window pixels (top-left origin, +y is down) to clip space ([-1,1]x[-1,1], +y is up):
 		glm::vec2 clip_mouse = glm::vec2(
-			(evt.motion.x + 0.5f) / window_size.x * 2.0f - 1.0f,
-			(evt.motion.y + 0.5f) / window_size.y *-2.0f + 1.0f
+			(input.mouse.x + 0.5f) / window_size.x * 2.0f - 1.0f,
+			(input.mouse.y + 0.5f) / window_size.y *-2.0f + 1.0f
 		);
 		left_paddle.y = (clip_to_court * glm::vec3(clip_mouse, 1.0f)).y;
 	}
+}
 
-	return false;
+PongMode::Snapshot PongMode::save() const {
+	Snapshot snapshot{}; //(zeroed, so the unused end of the trail saves as zeros rather than garbage)
+	snapshot.left_paddle = left_paddle;
+	snapshot.right_paddle = right_paddle;
+	snapshot.ball = ball;
+	snapshot.ball_velocity = ball_velocity;
+	snapshot.left_score = left_score;
+	snapshot.right_score = right_score;
+
+	snapshot.ai_offset = ai.offset[0];
+	snapshot.ai_offset_timer = ai.offset_timer[0];
+	snapshot.ai_decisions = ai.decisions[0];
+	snapshot.ai_seed = ai.seed;
+
+	snapshot.trail_count = uint32_t(std::min< size_t >(ball_trail.size(), Snapshot::TrailMax));
+	std::copy(ball_trail.end() - snapshot.trail_count, ball_trail.end(), snapshot.trail);
+	return snapshot;
+}
+
+void PongMode::restore(Snapshot const &snapshot) {
+	left_paddle = snapshot.left_paddle;
+	right_paddle = snapshot.right_paddle;
+	ball = snapshot.ball;
+	ball_velocity = snapshot.ball_velocity;
+	left_score = snapshot.left_score;
+	right_score = snapshot.right_score;
+
+	ai.paddle_y[0] = right_paddle.y;
+	ai.offset[0] = snapshot.ai_offset;
+	ai.offset_timer[0] = snapshot.ai_offset_timer;
+	ai.decisions[0] = snapshot.ai_decisions;
+	ai.seed = snapshot.ai_seed;
+
+	ball_trail.assign(snapshot.trail, snapshot.trail + std::min(snapshot.trail_count, Snapshot::TrailMax));
 }
 
 void PongMode::update(float elapsed) {
+	PROFILE_ZONE("PongMode::update");
 
-	static std::mt19937 mt; //mersenne twister pseudo-random number generator
+	step(elapsed);
+	update_trail(elapsed);
+}
+
+void PongMode::step(float elapsed) {
+	PROFILE_ZONE("PongMode::step");
 
 	//----- paddle update -----
 
-	{ //right player ai:
-		ai_offset_update -= elapsed;
-		if (ai_offset_update < elapsed) {
-			//update again in [0.5,1.0) seconds:
-			ai_offset_update = (mt() / float(mt.max())) * 0.5f + 0.5f;
-			ai_offset = (mt() / float(mt.max())) * 2.5f - 1.25f;
-		}
-		if (right_paddle.y < ball.y + ai_offset) {
-			right_paddle.y = std::min(ball.y + ai_offset, right_paddle.y + 2.0f * elapsed);
-		} else {
-			right_paddle.y = std::max(ball.y + ai_offset, right_paddle.y - 2.0f * elapsed);
-		}
+	if (right_ai) { //right player ai (see PongAI.hpp):
+		ai.paddle_y[0] = right_paddle.y;
+		ai.update(elapsed, &ball.y, -court_radius.y + paddle_radius.y, court_radius.y - paddle_radius.y);
+		right_paddle.y = ai.paddle_y[0];
 	}
 
 	//clamp paddles to court:
@@ -233,8 +218,10 @@ void PongMode::update(float elapsed) {
 			right_score += 1;
 		}
 	}
+}
 
-	//----- rainbow trails -----
+void PongMode::update_trail(float elapsed) {
+	PROFILE_ZONE("PongMode::update_trail");
 
 	//age up all locations in ball trail:
 	for (auto &t : ball_trail) {
@@ -251,6 +238,8 @@ void PongMode::update(float elapsed) {
 }
 
 void PongMode::draw(glm::uvec2 const &drawable_size) {
+	PROFILE_ZONE("PongMode::draw");
+
 	//some nice colors from the course web page:
 	#define HEX_TO_U8VEC4( HX ) (glm::u8vec4( (HX >> 24) & 0xff, (HX >> 16) & 0xff, (HX >> 8) & 0xff, (HX) & 0xff ))
 	const glm::u8vec4 bg_color = HEX_TO_U8VEC4(0x171714ff);
@@ -278,16 +267,23 @@ void PongMode::draw(glm::uvec2 const &drawable_size) {
 	//vertices will be accumulated into this list and then uploaded+drawn at the end of this function:
 	std::vector< Vertex > vertices;
 
+	//shapes are drawn as triangle strips of indices into 'vertices', separated by restart_index:
+	// (shared vertices are stored once, so a rectangle costs 4 vertices instead of 6)
+	std::vector< GLushort > indices;
+	const GLushort restart_index = 0xffff;
+
 	//inline helper function for rectangle drawing:
-	auto draw_rectangle = [&vertices](glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color) {
-		//draw rectangle as two CCW-oriented triangles:
-		vertices.emplace_back(glm::vec3(center.x-radius.x, center.y-radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x+radius.x, center.y-radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x+radius.x, center.y+radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-
-		vertices.emplace_back(glm::vec3(center.x-radius.x, center.y-radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x+radius.x, center.y+radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x-radius.x, center.y+radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+	auto draw_rectangle = [&vertices, &indices, &restart_index](glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color) {
+		//draw rectangle as a four-vertex (two CCW-oriented triangle) strip:
+		if (!indices.empty()) indices.emplace_back(restart_index);
+		GLushort base = GLushort(vertices.size());
+		vertices.emplace_back(glm::vec2(center.x-radius.x, center.y-radius.y), color);
+		vertices.emplace_back(glm::vec2(center.x+radius.x, center.y-radius.y), color);
+		vertices.emplace_back(glm::vec2(center.x-radius.x, center.y+radius.y), color);
+		vertices.emplace_back(glm::vec2(center.x+radius.x, center.y+radius.y), color);
+		for (GLushort i = 0; i < 4; ++i) {
+			indices.emplace_back(base + i);
+		}
 	};
 
 	//shadows for everything (except the trail):
@@ -394,45 +390,43 @@ void PongMode::draw(glm::uvec2 const &drawable_size) {
 	//---- actual drawing ----
 
 	//clear the color buffer:
-	glClearColor(bg_color.r / 255.0f, bg_color.g / 255.0f, bg_color.b / 255.0f, bg_color.a / 255.0f);
+	GLState::clear_color(bg_color.r / 255.0f, bg_color.g / 255.0f, bg_color.b / 255.0f, bg_color.a / 255.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	//use alpha blending:
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLState::enable(GL_BLEND);
+	GLState::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	//don't use the depth test:
-	glDisable(GL_DEPTH_TEST);
+	GLState::disable(GL_DEPTH_TEST);
 
 	//upload vertices to vertex_buffer:
-	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer); //set vertex_buffer as current
+	GLState::bind_buffer(GL_ARRAY_BUFFER, vertex_buffer->name); //set vertex_buffer as current
 	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertices[0]), vertices.data(), GL_STREAM_DRAW); //upload vertices array
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	//set color_texture_program as current program:
-	glUseProgram(color_texture_program.program);
+	//set program as current program:
+	GLState::use_program(program->program);
 
 	//upload OBJECT_TO_CLIP to the proper uniform location:
-	glUniformMatrix4fv(color_texture_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
-
-	//use the mapping vertex_buffer_for_color_texture_program to fetch vertex data:
-	glBindVertexArray(vertex_buffer_for_color_texture_program);
+	glUniformMatrix4fv(program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
 
-	//bind the solid white texture to location zero so things will be drawn just with their colors:
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, white_tex);
+	//use the mapping vertex_buffer_for_program to fetch vertex data:
+	GLState::bind_vertex_array(vertex_buffer_for_program->name);
 
-	//run the OpenGL pipeline:
-	glDrawArrays(GL_TRIANGLES, 0, GLsizei(vertices.size()));
+	//upload indices to index_buffer (already bound as the vertex array object's element array buffer):
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(indices[0]), indices.data(), GL_STREAM_DRAW);
 
-	//unbind the solid white texture:
-	glBindTexture(GL_TEXTURE_2D, 0);
+	//if the layout is textured, bind the solid white texture to location zero so things will be drawn just with their colors:
+	if (Vertex::UsesTexture) {
+		GLState::active_texture(GL_TEXTURE0);
+		GLState::bind_texture(GL_TEXTURE_2D, white_tex->tex);
+	}
 
-	//reset vertex array to none:
-	glBindVertexArray(0);
+	//run the OpenGL pipeline, restarting the triangle strip at every restart_index:
+	GLState::enable(GL_PRIMITIVE_RESTART);
+	GLState::primitive_restart_index(restart_index);
+	glDrawElements(GL_TRIANGLE_STRIP, GLsizei(indices.size()), GL_UNSIGNED_SHORT, (GLbyte *)0);
 
-	//reset current program to none:
-	glUseProgram(0);
-	
+	//(the state set above is left as-is, so next frame's identical calls are skipped -- see GLState.hpp)
 
 	GL_ERRORS(); //PARANOIA: print errors just in case we did something wrong.
 
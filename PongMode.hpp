@@ -1,4 +1,9 @@
-#include "ColorTextureProgram.hpp"
+#pragma once
+
+#include "PongAI.hpp"
+#include "Vertex2D.hpp"
+#include "Texture.hpp"
+#include "GLResourcePool.hpp"
 
 #include "Mode.hpp"
 #include "GL.hpp"
@@ -17,10 +22,17 @@ struct PongMode : Mode {
 	virtual ~PongMode();
 
 	//functions called by main loop:
-	virtual bool handle_event(SDL_Event const &, glm::uvec2 const &window_size) override;
+	virtual bool load_step() override;
+	virtual void handle_input(Input const &, glm::uvec2 const &window_size) override;
 	virtual void update(float elapsed) override;
 	virtual void draw(glm::uvec2 const &drawable_size) override;
 
+	//update() is step() followed by update_trail():
+	//advance paddles (AI, if right_ai) and ball by 'elapsed' seconds:
+	void step(float elapsed);
+	//age the trail and add the ball's current position to it:
+	void update_trail(float elapsed);
+
 	//----- game state -----
 
 	glm::vec2 court_radius = glm::vec2(7.0f, 5.0f);
@@ -36,37 +48,58 @@ struct PongMode : Mode {
 	uint32_t left_score = 0;
 	uint32_t right_score = 0;
 
-	float ai_offset = 0.0f;
-	float ai_offset_update = 0.0f;
+	PongAI ai = PongAI(1); //right player
+	bool right_ai = true; //if false, right_paddle is left alone (e.g., it's a player's)
 
 	//----- pretty rainbow trails -----
 
 	float trail_length = 1.3f;
 	std::deque< glm::vec3 > ball_trail; //stores (x,y,age), oldest elements first
 
-	//----- opengl assets / helpers ------
+	//----- snapshots -----
+	//(trivially copyable, so snapshot_file.hpp can save them; bump Version when the layout changes)
+
+	struct Snapshot {
+		static constexpr uint32_t Version = 1;
+
+		glm::vec2 left_paddle, right_paddle;
+		glm::vec2 ball, ball_velocity;
+		uint32_t left_score, right_score;
 
-	//draw functions will work on vectors of vertices, defined as follows:
-	struct Vertex {
-		Vertex(glm::vec3 const &Position_, glm::u8vec4 const &Color_, glm::vec2 const &TexCoord_) :
-			Position(Position_), Color(Color_), TexCoord(TexCoord_) { }
-		glm::vec3 Position;
-		glm::u8vec4 Color;
-		glm::vec2 TexCoord;
+		//the AI's entry in PongAI (its paddle position is right_paddle.y):
+		float ai_offset, ai_offset_timer;
+		uint32_t ai_decisions, ai_seed;
+
+		//newest part of the trail (at 60 updates per second, all of it):
+		static constexpr uint32_t TrailMax = 96;
+		uint32_t trail_count;
+		glm::vec3 trail[TrailMax];
 	};
-	static_assert(sizeof(Vertex) == 4*3 + 1*4 + 4*2, "PongMode::Vertex should be packed");
+	Snapshot save() const;
+	void restore(Snapshot const &);
+
+	//----- opengl assets / helpers ------
+	//(all shared with other modes through GLResourcePool)
 
-	//Shader program that draws transformed, vertices tinted with vertex colors:
-	ColorTextureProgram color_texture_program;
+	//draw functions will work on vectors of vertices, using one of the layouts from Vertex2D.hpp:
+	// (PosColVertex is 12 bytes; swap in HalfPosColVertex for 8 bytes or PosColTexVertex for textured drawing)
+	typedef PosColVertex Vertex;
+
+	//Shader program that draws transformed vertices in the chosen layout:
+	std::shared_ptr< Vertex::Program > program;
 
 	//Buffer used to hold vertex data during drawing:
-	GLuint vertex_buffer = 0;
+	std::shared_ptr< GLBuffer > vertex_buffer;
+
+	//Buffer used to hold index data (triangle strips separated by a restart index) during drawing:
+	std::shared_ptr< GLBuffer > index_buffer;
 
-	//Vertex Array Object that maps buffer locations to color_texture_program attribute locations:
-	GLuint vertex_buffer_for_color_texture_program = 0;
+	//Vertex Array Object that maps buffer locations to program attribute locations:
+	// (also records index_buffer as its element array buffer)
+	std::shared_ptr< GLVertexArray > vertex_buffer_for_program;
 
-	//Solid white texture:
-	GLuint white_tex = 0;
+	//Solid white texture (bound when Vertex::UsesTexture; shared with other modes):
+	std::shared_ptr< Texture > white_tex;
 
 	//matrix that maps from clip coordinates to court-space coordinates:
 	glm::mat3x2 clip_to_court = glm::mat3x2(1.0f);
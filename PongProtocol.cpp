@@ -0,0 +1,62 @@
+#include "PongProtocol.hpp"
+
+#include <algorithm>
+
+void write_input_packet(PacketWriter &packet, PongInputPacket const &input) {
+	packet.put(PacketInput);
+	packet.put(input.ack_tick);
+	packet.put(input.newest_seq);
+	packet.put(input.count);
+	for (uint32_t i = 0; i < input.count; ++i) {
+		packet.put(input.ys[i]);
+	}
+}
+
+bool read_input_packet(PacketReader &packet, PongInputPacket *input) {
+	if (packet.get< uint8_t >() != PacketInput) return false;
+	input->ack_tick = packet.get< uint32_t >();
+	input->newest_seq = packet.get< uint32_t >();
+	input->count = packet.get< uint8_t >();
+	if (input->count > MaxRepeatedInputs) return false;
+	for (uint32_t i = 0; i < input->count; ++i) {
+		input->ys[i] = packet.get< float >();
+	}
+	return packet.ok;
+}
+
+void write_state_packet(PacketWriter &packet, PongNetState const &state, PongNetState const *baseline, uint32_t ack_seq) {
+	uint8_t mask = 0;
+	for (uint32_t f = 0; f < PongNetState::Fields; ++f) {
+		if (!baseline || baseline->words[f] != state.words[f]) mask |= uint8_t(1 << f);
+	}
+
+	packet.put(PacketState);
+	packet.put(state.tick);
+	packet.put(baseline ? baseline->tick : 0U);
+	packet.put(ack_seq);
+	packet.put(mask);
+	for (uint32_t f = 0; f < PongNetState::Fields; ++f) {
+		if (mask & (1 << f)) packet.put(state.words[f]);
+	}
+}
+
+bool read_state_packet(PacketReader &packet, PongNetHistory const &history, PongNetState *state, uint32_t *ack_seq) {
+	if (packet.get< uint8_t >() != PacketState) return false;
+	state->tick = packet.get< uint32_t >();
+	uint32_t baseline_tick = packet.get< uint32_t >();
+	*ack_seq = packet.get< uint32_t >();
+	uint8_t mask = packet.get< uint8_t >();
+	if (!packet.ok) return false;
+
+	if (baseline_tick != 0) {
+		PongNetState const *baseline = history.find(baseline_tick);
+		if (!baseline) return false;
+		std::copy(baseline->words, baseline->words + PongNetState::Fields, state->words);
+	} else {
+		std::fill(state->words, state->words + PongNetState::Fields, 0U);
+	}
+	for (uint32_t f = 0; f < PongNetState::Fields; ++f) {
+		if (mask & (1 << f)) state->words[f] = packet.get< uint32_t >();
+	}
+	return packet.ok;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+/*
+ * The UDP packets networked Pong sends: NetPongMode (host or client), pong-server,
+ *  and pong-loadgen all speak this, so a game client can join a dedicated server.
+ *
+ * Values are in native byte order, since all ends are expected to be the same build.
+ *
+ * client -> host (every client tick):
+ *  u8 PacketInput, u32 ack_tick (newest state received), u32 newest_seq, u8 count, f32 y[count]
+ *   (y[count-1] is input newest_seq; earlier entries are repeats, in case packets were lost)
+ *
+ * host -> client (every host tick):
+ *  u8 PacketState, u32 tick, u32 baseline_tick (0 = none), u32 ack_seq (newest input used), u8 mask, u32 field[popcount(mask)]
+ *   (fields not in mask are the same as in the baseline state, which the client acknowledged earlier)
+ */
+
+enum : uint8_t {
+	PacketInput = 1,
+	PacketState = 2,
+};
+
+static constexpr uint32_t MaxRepeatedInputs = 8;
+static constexpr size_t MaxPacket = 64;
+
+//appends plain values to a packet buffer:
+struct PacketWriter {
+	uint8_t data[MaxPacket];
+	size_t size = 0;
+	template< typename T >
+	void put(T const &val) {
+		std::memcpy(data + size, &val, sizeof(T));
+		size += sizeof(T);
+	}
+};
+
+//reads plain values from a packet buffer:
+struct PacketReader {
+	PacketReader(uint8_t const *data_, size_t size_) : data(data_), size(size_) { }
+	uint8_t const *data;
+	size_t size;
+	size_t at = 0;
+	bool ok = true; //false after trying to read past the end
+	template< typename T >
+	T get() {
+		T val = T();
+		if (at + sizeof(T) > size) {
+			ok = false;
+			return val;
+		}
+		std::memcpy(&val, data + at, sizeof(T));
+		at += sizeof(T);
+		return val;
+	}
+};
+
+//game state on the wire: left/right paddle y, ball position + velocity, left/right score, as raw 32-bit words:
+struct PongNetState {
+	static constexpr uint32_t Fields = 8;
+	uint32_t tick = 0; //(ticks start at 1, so 0 means "none")
+	uint32_t words[Fields] = { };
+};
+
+//floats travel as their raw bits:
+inline uint32_t float_bits(float f) {
+	uint32_t u;
+	std::memcpy(&u, &f, sizeof(u));
+	return u;
+}
+inline float bits_float(uint32_t u) {
+	float f;
+	std::memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+//recent states (indexed by tick % Size), used as delta baselines:
+struct PongNetHistory {
+	static constexpr uint32_t Size = 64;
+	PongNetState states[Size];
+
+	void store(PongNetState const &state) { states[state.tick % Size] = state; }
+	//returns nullptr if 'tick' is not (or no longer) stored:
+	PongNetState const *find(uint32_t tick) const {
+		PongNetState const &state = states[tick % Size];
+		return (tick != 0 && state.tick == tick ? &state : nullptr);
+	}
+};
+
+struct PongInputPacket {
+	uint32_t ack_tick = 0;
+	uint32_t newest_seq = 0;
+	uint8_t count = 0;
+	float ys[MaxRepeatedInputs];
+};
+void write_input_packet(PacketWriter &packet, PongInputPacket const &input);
+//returns false if the packet isn't a well-formed input packet:
+bool read_input_packet(PacketReader &packet, PongInputPacket *input);
+
+//write a state packet, sending only fields that differ from baseline (if not null):
+void write_state_packet(PacketWriter &packet, PongNetState const &state, PongNetState const *baseline, uint32_t ack_seq);
+//returns false if the packet isn't a well-formed state packet or its baseline isn't in history:
+bool read_state_packet(PacketReader &packet, PongNetHistory const &history, PongNetState *state, uint32_t *ack_seq);
@@ -0,0 +1,117 @@
+#include "Profiler.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+std::atomic< bool > Profiler::capturing{ false };
+
+namespace {
+	struct Event {
+		char const *name;
+		uint64_t begin, end;
+	};
+
+	struct ThreadBuffer {
+		uint32_t id = 0;
+		std::string name;
+		std::vector< Event > events;
+		uint64_t dropped = 0;
+	};
+
+	//bounds memory use for long captures (about 24 MB per thread):
+	const size_t MaxEvents = size_t(1) << 20;
+
+	//every thread's buffer (kept after the thread exits, so its zones can still be written):
+	std::mutex buffers_mutex;
+	std::vector< std::shared_ptr< ThreadBuffer > > buffers;
+
+	thread_local ThreadBuffer *this_thread_buffer = nullptr;
+
+	ThreadBuffer &thread_buffer() {
+		if (!this_thread_buffer) {
+			std::lock_guard< std::mutex > lock(buffers_mutex);
+			buffers.emplace_back(std::make_shared< ThreadBuffer >());
+			buffers.back()->id = uint32_t(buffers.size());
+			this_thread_buffer = buffers.back().get();
+		}
+		return *this_thread_buffer;
+	}
+
+	//for converting timestamps to microseconds:
+	uint64_t start_ticks = 0;
+	std::chrono::steady_clock::time_point start_time;
+}
+
+void Profiler::record(char const *name, uint64_t begin, uint64_t end) {
+	ThreadBuffer &buffer = thread_buffer();
+	if (buffer.events.size() >= MaxEvents) {
+		buffer.dropped += 1;
+		return;
+	}
+	buffer.events.emplace_back(Event{ name, begin, end });
+}
+
+void Profiler::name_thread(std::string const &name) {
+	thread_buffer().name = name;
+}
+
+void Profiler::start() {
+	{
+		std::lock_guard< std::mutex > lock(buffers_mutex);
+		for (auto &buffer : buffers) {
+			buffer->events.clear();
+			buffer->dropped = 0;
+		}
+	}
+	start_time = std::chrono::steady_clock::now();
+	start_ticks = now();
+	capturing = true;
+}
+
+void Profiler::write(std::string const &filename) {
+	capturing = false;
+
+	//timestamp counter rate, measured over the capture:
+	uint64_t end_ticks = now();
+	double elapsed_us = std::chrono::duration< double, std::micro >(std::chrono::steady_clock::now() - start_time).count();
+	double ticks_per_us = (elapsed_us > 0.0 ? (end_ticks - start_ticks) / elapsed_us : 1.0);
+
+	std::ofstream out(filename, std::ios::binary);
+	if (!out) throw std::runtime_error("Failed to open '" + filename + "' for writing.");
+
+	std::lock_guard< std::mutex > lock(buffers_mutex);
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	bool first = true;
+	auto comma = [&]() {
+		if (!first) out << ",\n";
+		first = false;
+	};
+	size_t events = 0;
+	uint64_t dropped = 0;
+	out << std::fixed << std::setprecision(3);
+	for (auto const &buffer : buffers) {
+		if (!buffer->name.empty()) {
+			comma();
+			out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+		}
+		for (Event const &event : buffer->events) {
+			comma();
+			out << "{\"ph\":\"X\",\"name\":\"" << event.name << "\",\"pid\":1,\"tid\":" << buffer->id
+			    << ",\"ts\":" << (int64_t(event.begin - start_ticks) / ticks_per_us)
+			    << ",\"dur\":" << ((event.end - event.begin) / ticks_per_us) << "}";
+		}
+		events += buffer->events.size();
+		dropped += buffer->dropped;
+	}
+	out << "\n]}\n";
+
+	std::cout << "Wrote " << events << " profiler zones to '" << filename << "'";
+	if (dropped) std::cout << " (" << dropped << " more were dropped; buffers were full)";
+	std::cout << "." << std::endl;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+/*
+ * Profiler records named zones -- spans of code, timed with the CPU's timestamp
+ *  counter -- into a buffer per thread, and writes them out as Chrome trace JSON
+ *  (open it in ui.perfetto.dev or chrome://tracing).
+ *
+ * Mark a zone with:
+ *   PROFILE_ZONE("NewMode::draw"); //times the rest of the enclosing scope
+ * Zone names must be string literals (only the pointer is kept).
+ *
+ * Zones only record between start() and write() (main.cpp's --profile <file.json>);
+ *  the rest of the time a zone costs one relaxed load and a branch. Define
+ *  PROFILER_DISABLED to compile zones out entirely.
+ *
+ * write() reads every thread's buffer, so call it once other threads are done
+ *  recording (e.g., after the modes that own them are gone).
+ */
+
+struct Profiler {
+	//start recording (throws away anything recorded before):
+	static void start();
+	//stop recording and save everything recorded to 'filename':
+	static void write(std::string const &filename);
+	//name the calling thread in the trace (otherwise threads are numbered):
+	static void name_thread(std::string const &name);
+
+	static std::atomic< bool > capturing;
+
+	static inline uint64_t now() {
+		#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+		#else
+		return uint64_t(std::chrono::duration_cast< std::chrono::nanoseconds >(std::chrono::steady_clock::now().time_since_epoch()).count());
+		#endif
+	}
+
+	//add one finished zone to the calling thread's buffer:
+	static void record(char const *name, uint64_t begin, uint64_t end);
+
+	struct Zone {
+		Zone(char const *name_) : name(name_), begin(capturing.load(std::memory_order_relaxed) ? now() : 0) { }
+		~Zone() { if (begin) record(name, begin, now()); }
+		Zone(Zone const &) = delete;
+		char const *name;
+		uint64_t begin;
+	};
+};
+
+#ifdef PROFILER_DISABLED
+#define PROFILE_ZONE(NAME)
+#else
+#define PROFILE_ZONE_CONCAT2(A, B) A ## B
+#define PROFILE_ZONE_CONCAT(A, B) PROFILE_ZONE_CONCAT2(A, B)
+#define PROFILE_ZONE(NAME) Profiler::Zone PROFILE_ZONE_CONCAT(profile_zone_, __LINE__)(NAME)
+#endif
@@ -0,0 +1,166 @@
+#include "ShapeProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+#include "GLState.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+ShapeProgram::ShapeProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform mat4 OBJECT_TO_CLIP;\n"
+		"uniform float PIXEL_SIZE;\n"
+		"in vec2 Corner;\n"
+		"in vec2 Center;\n"
+		"in vec2 Axis;\n"
+		"in vec4 Bounds;\n"
+		"in vec4 Params;\n"
+		"in vec4 Color;\n"
+		"in uint Kind;\n"
+		"out vec2 local;\n"
+		"flat out vec4 params;\n"
+		"flat out uint kind;\n"
+		"out vec4 color;\n"
+		"void main() {\n"
+		//grow the quad by a pixel on every side, so the antialiased edge isn't clipped:
+		"	local = mix(Bounds.xy - PIXEL_SIZE, Bounds.zw + PIXEL_SIZE, 0.5 * Corner + 0.5);\n"
+		"	vec2 position = Center + local.x * vec2(Axis.y, -Axis.x) + local.y * Axis;\n"
+		"	gl_Position = OBJECT_TO_CLIP * vec4(position, 0.0, 1.0);\n"
+		"	params = Params;\n"
+		"	kind = Kind;\n"
+		"	color = Color;\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"in vec2 local;\n"
+		"flat in vec4 params;\n"
+		"flat in uint kind;\n"
+		"in vec4 color;\n"
+		"out vec4 fragColor;\n"
+		"void main() {\n"
+		//signed distance to the shape's edge (negative inside):
+		"	float d;\n"
+		"	if (kind == 0u) {\n" //circle
+		"		d = length(local) - params.x;\n"
+		"	} else if (kind == 1u) {\n" //rounded rectangle
+		"		vec2 q = abs(local) - params.xy + params.z;\n"
+		"		d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - params.z;\n"
+		"	} else {\n" //annular sector (rotated so the cut edge lies along x = 0)
+		"		vec2 p = mat2(params.z, params.w, -params.w, params.z) * vec2(abs(local.x), local.y);\n"
+		"		float ring = abs(length(p) - params.x) - 0.5 * params.y;\n"
+		"		float cut = length(vec2(p.x, max(0.0, abs(params.x - p.y) - 0.5 * params.y))) * sign(p.x);\n"
+		"		d = max(ring, cut);\n"
+		"	}\n"
+		//coverage of this pixel, from how fast the distance changes across it:
+		"	float per_pixel = length(vec2(dFdx(d), dFdy(d)));\n"
+		"	float coverage = clamp(0.5 - d / max(per_pixel, 1e-6), 0.0, 1.0);\n"
+		"	fragColor = vec4(color.rgb, color.a * coverage);\n"
+		"}\n"
+	);
+
+	//look up the locations of vertex attributes:
+	Corner_vec2 = glGetAttribLocation(program, "Corner");
+	Center_vec2 = glGetAttribLocation(program, "Center");
+	Axis_vec2 = glGetAttribLocation(program, "Axis");
+	Bounds_vec4 = glGetAttribLocation(program, "Bounds");
+	Params_vec4 = glGetAttribLocation(program, "Params");
+	Color_vec4 = glGetAttribLocation(program, "Color");
+	Kind_uint = glGetAttribLocation(program, "Kind");
+
+	//look up the locations of uniforms:
+	OBJECT_TO_CLIP_mat4 = glGetUniformLocation(program, "OBJECT_TO_CLIP");
+	PIXEL_SIZE_float = glGetUniformLocation(program, "PIXEL_SIZE");
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+ShapeProgram::~ShapeProgram() {
+	GLState::delete_program(program);
+	program = 0;
+}
+
+Shape Shape::circle(glm::vec2 const &center, float radius, glm::u8vec4 const &color) {
+	Shape shape;
+	shape.Center = center;
+	shape.Axis = glm::vec2(0.0f, 1.0f);
+	shape.Bounds = glm::vec4(-radius, -radius, radius, radius);
+	shape.Params = glm::vec4(radius, 0.0f, 0.0f, 0.0f);
+	shape.Color = color;
+	shape.Kind = Circle;
+	return shape;
+}
+
+Shape Shape::rounded_rect(glm::vec2 const &center, glm::vec2 const &radius, float corner_radius, glm::u8vec4 const &color) {
+	Shape shape;
+	shape.Center = center;
+	shape.Axis = glm::vec2(0.0f, 1.0f);
+	shape.Bounds = glm::vec4(-radius.x, -radius.y, radius.x, radius.y);
+	shape.Params = glm::vec4(radius.x, radius.y, std::min(corner_radius, std::min(radius.x, radius.y)), 0.0f);
+	shape.Color = color;
+	shape.Kind = RoundedRect;
+	return shape;
+}
+
+Shape Shape::annular_sector(glm::vec2 const &center, float inner_radius, float outer_radius, float angle, float half_angle, glm::u8vec4 const &color) {
+	float c = std::cos(half_angle);
+	float s = std::sin(half_angle);
+
+	Shape shape;
+	shape.Center = center;
+	shape.Axis = glm::vec2(std::cos(angle), std::sin(angle));
+	//the sector's bounding box in its own frame (where it is centered on +y):
+	float half_width = (c < 0.0f ? outer_radius : outer_radius * s);
+	shape.Bounds = glm::vec4(-half_width, std::min(inner_radius * c, outer_radius * c), half_width, outer_radius);
+	shape.Params = glm::vec4(0.5f * (inner_radius + outer_radius), outer_radius - inner_radius, c, s);
+	shape.Color = color;
+	shape.Kind = AnnularSector;
+	return shape;
+}
+
+void Shape::describe(ShapeProgram const &program) {
+	struct Float {
+		GLuint attribute;
+		GLint size;
+		GLenum type;
+		GLboolean normalized;
+		size_t offset;
+	};
+	for (Float const &f : {
+		Float{ program.Center_vec2, 2, GL_FLOAT, GL_FALSE, offsetof(Shape, Center) },
+		Float{ program.Axis_vec2, 2, GL_FLOAT, GL_FALSE, offsetof(Shape, Axis) },
+		Float{ program.Bounds_vec4, 4, GL_FLOAT, GL_FALSE, offsetof(Shape, Bounds) },
+		Float{ program.Params_vec4, 4, GL_FLOAT, GL_FALSE, offsetof(Shape, Params) },
+		Float{ program.Color_vec4, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Shape, Color) },
+	}) {
+		glVertexAttribPointer(f.attribute, f.size, f.type, f.normalized, sizeof(Shape), (GLbyte *)0 + f.offset);
+		glEnableVertexAttribArray(f.attribute);
+		//advance once per instance (quad) instead of once per vertex:
+		glVertexAttribDivisor(f.attribute, 1);
+	}
+
+	//(Kind is an integer in the shader, so it needs the 'I' variant)
+	glVertexAttribIPointer(program.Kind_uint, 1, GL_UNSIGNED_INT, sizeof(Shape), (GLbyte *)0 + offsetof(Shape, Kind));
+	glEnableVertexAttribArray(program.Kind_uint);
+	glVertexAttribDivisor(program.Kind_uint, 1);
+}
+
+GLuint make_shape_vertex_array(ShapeProgram const &program, GLuint corner_buffer, GLuint shape_buffer) {
+	GLuint vertex_array = 0;
+	glGenVertexArrays(1, &vertex_array);
+	GLState::bind_vertex_array(vertex_array);
+
+	GLState::bind_buffer(GL_ARRAY_BUFFER, corner_buffer);
+	glVertexAttribPointer(program.Corner_vec2, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (GLbyte *)0);
+	glEnableVertexAttribArray(program.Corner_vec2);
+
+	GLState::bind_buffer(GL_ARRAY_BUFFER, shape_buffer);
+	Shape::describe(program);
+
+	GLState::bind_vertex_array(0);
+	return vertex_array;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+/*
+ * ShapeProgram draws circles, rounded rectangles, and annular sectors (arcs)
+ *  from their signed distance functions, one instanced quad per shape.
+ *
+ * Edges are antialiased analytically: coverage is the signed distance divided by
+ *  how much it changes per pixel, so shapes stay smooth at any size without
+ *  adding vertices (or needing multisampling).
+ *
+ * Per-vertex Corner is in [-1,1]^2 (e.g., square_corners_buffer(), drawn
+ *  as a 4-vertex triangle strip); each instance is a Shape (below).
+ *
+ * Usage:
+ *   std::vector< Shape > shapes = { Shape::circle(at, 0.1f, color), ... };
+ *   (upload shapes; bind a vertex array from make_shape_vertex_array())
+ *   glUniform1f(program.PIXEL_SIZE_float, 2.0f / (scale * drawable_size.y));
+ *   glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(shapes.size()));
+ */
+
+struct ShapeProgram {
+	ShapeProgram();
+	~ShapeProgram();
+
+	GLuint program = 0;
+
+	//Attribute (per-vertex variable) locations:
+	GLuint Corner_vec2 = -1U;
+
+	//Attribute (per-instance variable) locations:
+	GLuint Center_vec2 = -1U;
+	GLuint Axis_vec2 = -1U;
+	GLuint Bounds_vec4 = -1U;
+	GLuint Params_vec4 = -1U;
+	GLuint Color_vec4 = -1U;
+	GLuint Kind_uint = -1U;
+
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+	GLuint PIXEL_SIZE_float = -1U; //size of a pixel in object units (quads are grown by this much to fit the antialiased edge)
+};
+
+//56 bytes -- one shape, drawn with ShapeProgram:
+struct Shape {
+	enum Kind : uint32_t {
+		Circle = 0,        //Params = (radius, -, -, -)
+		RoundedRect = 1,   //Params = (half width, half height, corner radius, -)
+		AnnularSector = 2, //Params = (middle radius, thickness, cos(half angle), sin(half angle)); centered on +y
+	};
+
+	static Shape circle(glm::vec2 const &center, float radius, glm::u8vec4 const &color);
+	static Shape rounded_rect(glm::vec2 const &center, glm::vec2 const &radius, float corner_radius, glm::u8vec4 const &color);
+	//the part of the ring between inner_radius and outer_radius within half_angle (radians, up to pi) of direction 'angle':
+	static Shape annular_sector(glm::vec2 const &center, float inner_radius, float outer_radius, float angle, float half_angle, glm::u8vec4 const &color);
+
+	glm::vec2 Center; //origin of the shape's frame, in object space
+	glm::vec2 Axis; //the shape frame's +y axis in object space (unit length); its +x axis is Axis rotated clockwise
+	glm::vec4 Bounds; //quad to draw, in the shape's frame: (min.x, min.y, max.x, max.y)
+	glm::vec4 Params; //see Kind
+	glm::u8vec4 Color;
+	uint32_t Kind;
+
+	//set up (per-instance) attribute pointers for the buffer currently bound to GL_ARRAY_BUFFER:
+	static void describe(ShapeProgram const &program);
+};
+static_assert(sizeof(Shape) == 4*2 + 4*2 + 4*4 + 4*4 + 1*4 + 4, "Shape should be packed");
+
+//make a vertex array object that reads Corner from corner_buffer (four glm::vec2's) and Shape-s from shape_buffer:
+GLuint make_shape_vertex_array(ShapeProgram const &program, GLuint corner_buffer, GLuint shape_buffer);
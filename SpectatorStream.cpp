@@ -0,0 +1,273 @@
+#include "SpectatorStream.hpp"
+
+#include <chrono>
+#include <stdexcept>
+
+#ifdef __linux__
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+static double now_seconds() {
+	return std::chrono::duration< double >(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t now_ns() {
+	return uint64_t(std::chrono::duration_cast< std::chrono::nanoseconds >(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+struct SpectatorSendList {
+	SpectatorHeader header;
+	iovec iov[2]; //header, payload (shared by every message)
+	std::vector< sockaddr_un > addresses;
+	std::vector< mmsghdr > messages;
+	bool dirty = true; //(viewers changed since messages was built)
+};
+
+//"@name" -> abstract address, anything else -> filesystem path:
+static socklen_t make_address(std::string const &str, sockaddr_un *addr) {
+	std::string raw = str;
+	if (!raw.empty() && raw[0] == '@') raw[0] = '\0';
+	if (raw.empty() || raw.size() >= sizeof(addr->sun_path)) {
+		throw std::runtime_error("Spectator address '" + str + "' is empty or too long.");
+	}
+	*addr = sockaddr_un();
+	addr->sun_family = AF_UNIX;
+	std::memcpy(addr->sun_path, raw.data(), raw.size());
+	return socklen_t(offsetof(sockaddr_un, sun_path) + raw.size());
+}
+
+//----- server -----
+
+SpectatorServer::SpectatorServer(std::string const &address_) : address(address_), send_list(new SpectatorSendList) {
+	sockaddr_un addr;
+	socklen_t len = make_address(address, &addr);
+
+	int s = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (s < 0) throw std::runtime_error("Failed to create spectator socket.");
+	if (address[0] != '@') unlink(address.c_str()); //(left behind by an earlier run)
+	if (bind(s, reinterpret_cast< sockaddr * >(&addr), len) != 0) {
+		close(s);
+		throw std::runtime_error("Failed to bind spectator socket '" + address + "': " + std::strerror(errno));
+	}
+
+	//every datagram in a viewer's queue counts against the sender's buffer, so make room for a tick's worth:
+	int sndbuf = 4 << 20;
+	setsockopt(s, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+	handle = s;
+}
+
+SpectatorServer::~SpectatorServer() {
+	close(int(handle));
+	if (address[0] != '@') unlink(address.c_str());
+}
+
+void SpectatorServer::forget(size_t index) {
+	viewer_index.erase(viewers[index]);
+	if (index + 1 != viewers.size()) {
+		viewers[index] = std::move(viewers.back());
+		viewer_index[viewers[index]] = index;
+	}
+	viewers.pop_back();
+	send_list->dirty = true;
+}
+
+void SpectatorServer::poll() {
+	std::lock_guard< std::mutex > lock(mutex);
+
+	SpectatorHeader header;
+	sockaddr_un from;
+	socklen_t from_len = sizeof(from);
+	ssize_t got;
+	while ((got = recvfrom(int(handle), &header, sizeof(header), 0, reinterpret_cast< sockaddr * >(&from), &from_len)) >= 0) {
+		std::string key(from.sun_path, from_len - offsetof(sockaddr_un, sun_path));
+		from_len = sizeof(from);
+		if (size_t(got) != sizeof(header) || header.magic != SpectatorHeader::Magic || key.empty()) continue;
+
+		auto f = viewer_index.find(key);
+		if (header.type == SpectatorHeader::Hello && f == viewer_index.end()) {
+			viewer_index.emplace(key, viewers.size());
+			viewers.emplace_back(key);
+			send_list->dirty = true;
+			need_key = true; //(so the new viewer can start right away)
+		} else if (header.type == SpectatorHeader::Bye && f != viewer_index.end()) {
+			forget(f->second);
+		}
+	}
+}
+
+void SpectatorServer::broadcast(BallDefender::Snapshot const &state) {
+	std::lock_guard< std::mutex > lock(mutex);
+	uint64_t before = now_ns();
+
+	//encode once:
+	tick += 1;
+	bool key = need_key || (tick % KeyInterval == 0);
+	payload.clear();
+	codec.write(payload, state, key ? nullptr : &previous);
+	payload.flush();
+	previous = state;
+
+	SpectatorSendList &list = *send_list;
+	list.header = SpectatorHeader();
+	list.header.type = (key ? SpectatorHeader::KeyFrame : SpectatorHeader::DeltaFrame);
+	list.header.tick = tick;
+	list.header.baseline_tick = (key ? 0 : tick - 1);
+	list.iov[0].iov_base = &list.header;
+	list.iov[0].iov_len = sizeof(list.header);
+	list.iov[1].iov_base = payload.bytes.data();
+	list.iov[1].iov_len = payload.bytes.size();
+
+	frames += 1;
+	key_frames += (key ? 1 : 0);
+	need_key = false;
+
+	uint64_t encoded = now_ns();
+	encode_ns += encoded - before;
+	if (viewers.empty()) return;
+
+	//(re)build one message per viewer, all pointing at the same two buffers:
+	if (list.dirty) {
+		list.addresses.resize(viewers.size());
+		list.messages.resize(viewers.size());
+		for (size_t v = 0; v < viewers.size(); ++v) {
+			sockaddr_un &addr = list.addresses[v];
+			addr = sockaddr_un();
+			addr.sun_family = AF_UNIX;
+			std::memcpy(addr.sun_path, viewers[v].data(), viewers[v].size());
+			mmsghdr &message = list.messages[v];
+			message = mmsghdr();
+			message.msg_hdr.msg_name = &addr;
+			message.msg_hdr.msg_namelen = socklen_t(offsetof(sockaddr_un, sun_path) + viewers[v].size());
+			message.msg_hdr.msg_iov = list.iov;
+			message.msg_hdr.msg_iovlen = 2;
+		}
+		list.dirty = false;
+	}
+
+	//send many (a failed message stops the call, so skip past it and carry on):
+	list.header.sent_ns = now_ns();
+	size_t frame_bytes = sizeof(list.header) + payload.bytes.size();
+	std::vector< size_t > gone;
+	size_t at = 0;
+	while (at < list.messages.size()) {
+		unsigned int count = unsigned(std::min< size_t >(list.messages.size() - at, 1024));
+		int sent = sendmmsg(int(handle), &list.messages[at], count, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (sent > 0) {
+			packets_sent += sent;
+			bytes_sent += sent * frame_bytes;
+			at += sent;
+			continue;
+		}
+		if (errno == EINTR) continue;
+		if (errno == EAGAIN || errno == EWOULDBLOCK) packets_dropped += 1;
+		else gone.emplace_back(at); //(viewer's socket is closed)
+		at += 1;
+	}
+	for (auto g = gone.rbegin(); g != gone.rend(); ++g) {
+		forget(*g);
+	}
+
+	send_ns += now_ns() - encoded;
+}
+
+//----- viewer -----
+
+SpectatorViewer::SpectatorViewer(std::string const &server_address_) : server_address(server_address_) {
+	sockaddr_un addr;
+	make_address(server_address, &addr); //(just to check it)
+
+	int s = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (s < 0) throw std::runtime_error("Failed to create spectator socket.");
+	//bind to an unused abstract address picked by the kernel (so the server has somewhere to send to):
+	sockaddr_un any = sockaddr_un();
+	any.sun_family = AF_UNIX;
+	if (bind(s, reinterpret_cast< sockaddr * >(&any), sizeof(sa_family_t)) != 0) {
+		close(s);
+		throw std::runtime_error(std::string("Failed to bind spectator socket: ") + std::strerror(errno));
+	}
+	handle = s;
+	hello_jitter.seed(uint32_t(s) * 2654435761U + uint32_t(now_ns()));
+}
+
+SpectatorViewer::~SpectatorViewer() {
+	SpectatorHeader bye;
+	bye.type = SpectatorHeader::Bye;
+	sockaddr_un addr;
+	socklen_t len = make_address(server_address, &addr);
+	sendto(int(handle), &bye, sizeof(bye), MSG_DONTWAIT | MSG_NOSIGNAL, reinterpret_cast< sockaddr * >(&addr), len);
+	close(int(handle));
+}
+
+bool SpectatorViewer::poll() {
+	double now = now_seconds();
+	if (now >= hello_at && now - received_at > 1.0) {
+		//(fails harmlessly if the server isn't up yet or its queue is full; joined viewers stay quiet)
+		SpectatorHeader hello;
+		sockaddr_un addr;
+		socklen_t len = make_address(server_address, &addr);
+		sendto(int(handle), &hello, sizeof(hello), MSG_DONTWAIT | MSG_NOSIGNAL, reinterpret_cast< sockaddr * >(&addr), len);
+		hello_at = now + std::uniform_real_distribution< double >(0.05, 0.25)(hello_jitter);
+	}
+
+	bool changed = false;
+	uint8_t data[2048];
+	ssize_t got;
+	while ((got = recv(int(handle), data, sizeof(data), 0)) >= 0) {
+		SpectatorHeader header;
+		if (size_t(got) < sizeof(header)) continue;
+		std::memcpy(&header, data, sizeof(header));
+		if (header.magic != SpectatorHeader::Magic) continue;
+		bytes_received += got;
+		received_at = now;
+
+		BitReader in(data + sizeof(header), size_t(got) - sizeof(header));
+		BallDefender::Snapshot decoded;
+		if (header.type == SpectatorHeader::KeyFrame) {
+			codec.read(in, &decoded);
+		} else if (header.type == SpectatorHeader::DeltaFrame && tick != 0 && header.baseline_tick == tick) {
+			codec.read(in, &decoded, &state);
+		} else {
+			skipped += 1;
+			continue;
+		}
+		if (in.overrun) continue;
+
+		state = decoded;
+		tick = header.tick;
+		changed = true;
+
+		double latency = (now_ns() - header.sent_ns) * 1e-9;
+		frames += 1;
+		latency_sum += latency;
+		latency_max = std::max(latency_max, latency);
+	}
+	return changed;
+}
+
+#else //----- not linux -----
+
+struct SpectatorSendList { };
+
+SpectatorServer::SpectatorServer(std::string const &address_) : address(address_) {
+	throw std::runtime_error("Spectator streams are only supported on Linux.");
+}
+SpectatorServer::~SpectatorServer() { }
+void SpectatorServer::forget(size_t) { }
+void SpectatorServer::poll() { }
+void SpectatorServer::broadcast(BallDefender::Snapshot const &) { }
+
+SpectatorViewer::SpectatorViewer(std::string const &server_address_) : server_address(server_address_) {
+	throw std::runtime_error("Spectator streams are only supported on Linux.");
+}
+SpectatorViewer::~SpectatorViewer() { }
+bool SpectatorViewer::poll() { return false; }
+
+#endif
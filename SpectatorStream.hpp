@@ -0,0 +1,112 @@
+#pragma once
+
+#include "BallDefender.hpp"
+#include "StateCodec.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * SpectatorServer / SpectatorViewer stream a live game of Ball Defender to
+ *  viewers on the same machine over UNIX datagram sockets (Linux only; elsewhere
+ *  the constructors throw).
+ *
+ * Addresses are socket paths; a leading '@' means Linux's abstract namespace
+ *  (no file is created), e.g., "@ball-defender".
+ *
+ * Each tick the server encodes the state once (StateCodec: a key frame, or a
+ *  delta against the previous tick) and hands the same header + payload buffers
+ *  to every viewer with one sendmmsg() call per 1024 viewers, so per-viewer cost
+ *  is just the kernel copy. Viewers that fall behind lose frames (the server
+ *  never blocks); a viewer that misses a delta waits for the next key frame.
+ *
+ * Viewers join by sending a hello datagram (repeated until frames arrive, since
+ *  the server's queue only holds a few at a time) and leave by sending a bye;
+ *  the server also forgets viewers whose sockets have closed.
+ */
+
+//one frame's header (host byte order -- both ends are on the same machine):
+struct SpectatorHeader {
+	static constexpr uint32_t Magic = 0x76637073; //'spcv'
+	enum Type : uint32_t { Hello = 1, Bye = 2, KeyFrame = 3, DeltaFrame = 4 };
+	uint32_t magic = Magic;
+	uint32_t type = Hello;
+	uint32_t tick = 0;
+	uint32_t baseline_tick = 0; //(DeltaFrame: the tick it is relative to)
+	uint64_t sent_ns = 0; //steady_clock time when sent, for measuring latency
+};
+
+struct SpectatorSendList; //(the sendmmsg() arrays; defined in SpectatorStream.cpp)
+
+struct SpectatorServer {
+	SpectatorServer(std::string const &address);
+	~SpectatorServer();
+	SpectatorServer(SpectatorServer const &) = delete;
+
+	static constexpr uint32_t KeyInterval = 60; //ticks between key frames (also sent whenever a viewer joins)
+
+	//handle hellos and byes:
+	void poll();
+	//encode 'state' as the next tick and send it to every viewer:
+	void broadcast(BallDefender::Snapshot const &state);
+
+	size_t viewer_count() const { return viewers.size(); }
+
+	std::string address;
+	StateCodec codec;
+
+	std::vector< std::string > viewers; //addresses (raw sun_path bytes; abstract addresses start with '\0')
+	std::unordered_map< std::string, size_t > viewer_index; //address -> index in viewers
+
+	//----- statistics -----
+	uint64_t frames = 0, key_frames = 0; //broadcast() calls
+	uint64_t packets_sent = 0, bytes_sent = 0;
+	uint64_t packets_dropped = 0; //(viewer's queue was full)
+	uint64_t encode_ns = 0, send_ns = 0; //time spent in broadcast()
+
+	//(poll() and broadcast() lock this, so the server can be shared between modes and threads)
+	std::mutex mutex;
+
+private:
+	void forget(size_t index);
+	intptr_t handle = -1;
+	uint32_t tick = 0;
+	bool need_key = true;
+	BallDefender::Snapshot previous;
+	BitWriter payload;
+	std::unique_ptr< SpectatorSendList > send_list;
+};
+
+struct SpectatorViewer {
+	SpectatorViewer(std::string const &server_address);
+	~SpectatorViewer();
+	SpectatorViewer(SpectatorViewer const &) = delete;
+
+	//receive everything waiting (and say hello, if not receiving); returns true if 'state' changed:
+	bool poll();
+	//the OS socket (e.g., to wait on it with epoll):
+	intptr_t native_handle() const { return handle; }
+
+	std::string server_address;
+	StateCodec codec;
+
+	BallDefender::Snapshot state; //newest decoded frame
+	uint32_t tick = 0; //...and its tick (0 = nothing received yet)
+
+	//----- statistics -----
+	uint64_t frames = 0; //decoded
+	uint64_t skipped = 0; //deltas that couldn't be decoded (missed their baseline)
+	uint64_t bytes_received = 0;
+	double latency_sum = 0.0, latency_max = 0.0; //seconds from server send to decode, over 'frames'
+
+private:
+	intptr_t handle = -1;
+	double hello_at = 0.0;
+	double received_at = 0.0;
+	std::minstd_rand hello_jitter; //(spreads out retries, so a crowd of viewers doesn't keep colliding)
+};
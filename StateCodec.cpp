@@ -0,0 +1,190 @@
+#include "StateCodec.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+StateCodec::StateCodec(glm::vec2 const &court_radius_) : court_radius(court_radius_) {
+}
+
+uint32_t StateCodec::quantize(float value, float range, uint32_t bits) const {
+	float max = float((1U << bits) - 1U);
+	float t = (value / range * 0.5f + 0.5f) * max;
+	return uint32_t(std::min(std::max(std::round(t), 0.0f), max));
+}
+
+float StateCodec::dequantize(uint32_t q, float range, uint32_t bits) const {
+	float max = float((1U << bits) - 1U);
+	return (q / max * 2.0f - 1.0f) * range;
+}
+
+//----- one quantized value, relative to a baseline if there is one -----
+
+static inline void write_value(BitWriter &out, uint32_t q, uint32_t const *base, uint32_t bits) {
+	if (!base) {
+		out.write(q, bits);
+		return;
+	}
+	int32_t diff = int32_t(q) - int32_t(*base);
+	uint32_t zz = (uint32_t(diff) << 1) ^ uint32_t(diff >> 31); //(zig-zag: small magnitudes -> small numbers)
+	//prefix bits come first (lowest) in each code:
+	if (zz == 0) out.write(0x0, 1);
+	else if (zz < (1U << 5)) out.write((zz << 2) | 0x1, 2 + 5);
+	else if (zz < (1U << 10)) out.write((zz << 3) | 0x3, 3 + 10);
+	else out.write((q << 3) | 0x7, 3 + bits);
+}
+
+static inline uint32_t read_value(BitReader &in, uint32_t const *base, uint32_t bits) {
+	if (!base) return in.read(bits);
+	if (!in.read_bool()) return *base;
+	uint32_t zz;
+	if (!in.read_bool()) zz = in.read(5);
+	else if (!in.read_bool()) zz = in.read(10);
+	else return in.read(bits);
+	int32_t diff = int32_t(zz >> 1) ^ -int32_t(zz & 1);
+	return uint32_t(int32_t(*base) + diff);
+}
+
+//----- balls -----
+
+void StateCodec::write_balls(BitWriter &out, glm::vec4 const *balls, uint32_t count, glm::vec4 const *baseline) const {
+	glm::vec4 range = glm::vec4(2.0f * court_radius, MaxVelocity, MaxVelocity);
+	const uint32_t bits[4] = { PositionBits, PositionBits, VelocityBits, VelocityBits };
+	for (uint32_t i = 0; i < count; ++i) {
+		for (uint32_t c = 0; c < 4; ++c) {
+			uint32_t q = quantize(balls[i][c], range[c], bits[c]);
+			if (baseline) {
+				uint32_t base = quantize(baseline[i][c], range[c], bits[c]);
+				write_value(out, q, &base, bits[c]);
+			} else {
+				write_value(out, q, nullptr, bits[c]);
+			}
+		}
+	}
+}
+
+void StateCodec::read_balls(BitReader &in, glm::vec4 *balls, uint32_t count, glm::vec4 const *baseline) const {
+	glm::vec4 range = glm::vec4(2.0f * court_radius, MaxVelocity, MaxVelocity);
+	const uint32_t bits[4] = { PositionBits, PositionBits, VelocityBits, VelocityBits };
+	for (uint32_t i = 0; i < count; ++i) {
+		for (uint32_t c = 0; c < 4; ++c) {
+			uint32_t q;
+			if (baseline) {
+				uint32_t base = quantize(baseline[i][c], range[c], bits[c]);
+				q = read_value(in, &base, bits[c]);
+			} else {
+				q = read_value(in, nullptr, bits[c]);
+			}
+			balls[i][c] = dequantize(q, range[c], bits[c]);
+		}
+	}
+}
+
+//----- Ball Defender -----
+
+static const uint32_t HealthBits = 8;
+static const uint32_t CollisionBits = 16;
+
+//angles wrap around (so -pi and pi quantize to the same value):
+static uint32_t quantize_angle(glm::vec2 const &direction) {
+	float turns = std::atan2(direction.y, direction.x) / (2.0f * 3.14159265f);
+	return uint32_t(int32_t(std::round(turns * (1U << StateCodec::AngleBits)))) & ((1U << StateCodec::AngleBits) - 1U);
+}
+static glm::vec2 dequantize_angle(uint32_t q) {
+	float angle = q * (2.0f * 3.14159265f) / (1U << StateCodec::AngleBits);
+	return glm::vec2(std::cos(angle), std::sin(angle));
+}
+
+void StateCodec::write(BitWriter &out, BallDefender::Snapshot const &state, BallDefender::Snapshot const *baseline) const {
+	uint32_t angle = quantize_angle(state.arc_paddle);
+	uint32_t base_angle = (baseline ? quantize_angle(baseline->arc_paddle) : 0);
+	write_value(out, angle, baseline ? &base_angle : nullptr, AngleBits);
+	write_value(out, state.health, baseline ? &baseline->health : nullptr, HealthBits);
+	write_value(out, state.num_collisions, baseline ? &baseline->num_collisions : nullptr, CollisionBits);
+
+	//parked balls (x == 12, which BallDefender checks for exactly) are just a flag:
+	for (uint32_t i = 0; i < 7; ++i) {
+		bool parked = (state.balls[i].x == 12.0f);
+		out.write_bool(parked);
+		if (parked) continue;
+		glm::vec4 ball = glm::vec4(state.balls[i], state.ball_velocities[i]);
+		if (baseline && baseline->balls[i].x != 12.0f) {
+			glm::vec4 base = glm::vec4(baseline->balls[i], baseline->ball_velocities[i]);
+			write_balls(out, &ball, 1, &base);
+		} else {
+			write_balls(out, &ball, 1);
+		}
+	}
+}
+
+void StateCodec::read(BitReader &in, BallDefender::Snapshot *state, BallDefender::Snapshot const *baseline) const {
+	uint32_t base_angle = (baseline ? quantize_angle(baseline->arc_paddle) : 0);
+	state->arc_paddle = dequantize_angle(read_value(in, baseline ? &base_angle : nullptr, AngleBits));
+	state->health = read_value(in, baseline ? &baseline->health : nullptr, HealthBits);
+	state->num_collisions = read_value(in, baseline ? &baseline->num_collisions : nullptr, CollisionBits);
+
+	for (uint32_t i = 0; i < 7; ++i) {
+		if (in.read_bool()) {
+			state->balls[i] = glm::vec2(12.0f, 0.0f);
+			state->ball_velocities[i] = glm::vec2(0.0f);
+			continue;
+		}
+		glm::vec4 ball;
+		if (baseline && baseline->balls[i].x != 12.0f) {
+			glm::vec4 base = glm::vec4(baseline->balls[i], baseline->ball_velocities[i]);
+			read_balls(in, &ball, 1, &base);
+		} else {
+			read_balls(in, &ball, 1);
+		}
+		state->balls[i] = glm::vec2(ball.x, ball.y);
+		state->ball_velocities[i] = glm::vec2(ball.z, ball.w);
+	}
+}
+
+//----- Pong -----
+
+static const uint32_t ScoreBits = 16;
+
+//PongNetState's words, as (value range, bits); scores (range 0) are sent as-is:
+static void pong_fields(glm::vec2 const &court_radius, float range[PongNetState::Fields], uint32_t bits[PongNetState::Fields]) {
+	const float r[PongNetState::Fields] = {
+		2.0f * court_radius.y, 2.0f * court_radius.y, //paddles
+		2.0f * court_radius.x, 2.0f * court_radius.y, //ball
+		StateCodec::MaxVelocity, StateCodec::MaxVelocity, //ball velocity
+		0.0f, 0.0f, //scores
+	};
+	const uint32_t b[PongNetState::Fields] = {
+		StateCodec::PositionBits, StateCodec::PositionBits,
+		StateCodec::PositionBits, StateCodec::PositionBits,
+		StateCodec::VelocityBits, StateCodec::VelocityBits,
+		ScoreBits, ScoreBits,
+	};
+	std::copy(r, r + PongNetState::Fields, range);
+	std::copy(b, b + PongNetState::Fields, bits);
+}
+
+void StateCodec::write(BitWriter &out, PongNetState const &state, PongNetState const *baseline) const {
+	float range[PongNetState::Fields];
+	uint32_t bits[PongNetState::Fields];
+	pong_fields(court_radius, range, bits);
+	for (uint32_t f = 0; f < PongNetState::Fields; ++f) {
+		auto q = [&](PongNetState const &s) {
+			return (range[f] > 0.0f ? quantize(bits_float(s.words[f]), range[f], bits[f]) : std::min(s.words[f], (1U << bits[f]) - 1U));
+		};
+		uint32_t base = (baseline ? q(*baseline) : 0);
+		write_value(out, q(state), baseline ? &base : nullptr, bits[f]);
+	}
+}
+
+void StateCodec::read(BitReader &in, PongNetState *state, PongNetState const *baseline) const {
+	float range[PongNetState::Fields];
+	uint32_t bits[PongNetState::Fields];
+	pong_fields(court_radius, range, bits);
+	for (uint32_t f = 0; f < PongNetState::Fields; ++f) {
+		uint32_t base = 0;
+		if (baseline) {
+			base = (range[f] > 0.0f ? quantize(bits_float(baseline->words[f]), range[f], bits[f]) : std::min(baseline->words[f], (1U << bits[f]) - 1U));
+		}
+		uint32_t q = read_value(in, baseline ? &base : nullptr, bits[f]);
+		state->words[f] = (range[f] > 0.0f ? float_bits(dequantize(q, range[f], bits[f])) : q);
+	}
+}
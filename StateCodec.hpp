@@ -0,0 +1,59 @@
+#pragma once
+
+#include "BitPacker.hpp"
+#include "BallDefender.hpp"
+#include "PongProtocol.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+/*
+ * StateCodec writes game state as compact bit-packed snapshots (see BitPacker.hpp)
+ *  and reads it back, for saving or sending over the network.
+ *
+ * Values are quantized:
+ *  - positions to PositionBits over [-2,2] x court_radius (room for balls that
+ *    have just left the court),
+ *  - velocities to VelocityBits over [-MaxVelocity, MaxVelocity],
+ *  - Ball Defender's paddle to an angle (AngleBits; it reads back as a unit vector),
+ *    and its parked balls (x = 12) to a single bit.
+ *
+ * Given a baseline state that the reader already has, each quantized value is
+ *  written as its change from the baseline's, in as few bits as fit:
+ *   0               unchanged
+ *   10  + 5 bits    small change (zig-zag encoded)
+ *   110 + 10 bits   medium change
+ *   111 + raw       anything else
+ * Both ends quantize the baseline themselves, and quantizing a decoded value gives
+ *  back the same number, so the writer can pass its own exact state as the baseline.
+ *
+ * Readers don't check for errors; check BitReader::overrun afterward.
+ */
+
+struct StateCodec {
+	StateCodec(glm::vec2 const &court_radius = glm::vec2(7.0f, 5.0f));
+
+	static constexpr uint32_t PositionBits = 16;
+	static constexpr uint32_t VelocityBits = 12;
+	static constexpr uint32_t AngleBits = 12;
+	static constexpr float MaxVelocity = 2.0f;
+
+	glm::vec2 court_radius;
+
+	//balls as (x, y, vx, vy) (StressMode's layout):
+	void write_balls(BitWriter &out, glm::vec4 const *balls, uint32_t count, glm::vec4 const *baseline = nullptr) const;
+	void read_balls(BitReader &in, glm::vec4 *balls, uint32_t count, glm::vec4 const *baseline = nullptr) const;
+
+	//Ball Defender (NewMode):
+	void write(BitWriter &out, BallDefender::Snapshot const &state, BallDefender::Snapshot const *baseline = nullptr) const;
+	void read(BitReader &in, BallDefender::Snapshot *state, BallDefender::Snapshot const *baseline = nullptr) const;
+
+	//Pong (NetPongMode / pong-server), without the tick number:
+	void write(BitWriter &out, PongNetState const &state, PongNetState const *baseline = nullptr) const;
+	void read(BitReader &in, PongNetState *state, PongNetState const *baseline = nullptr) const;
+
+	//----- quantization -----
+	uint32_t quantize(float value, float range, uint32_t bits) const; //(value in [-range,range])
+	float dequantize(uint32_t q, float range, uint32_t bits) const;
+};
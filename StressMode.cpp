@@ -0,0 +1,352 @@
+#include "StressMode.hpp"
+
+//for the GL_ERRORS() macro:
+#include "gl_errors.hpp"
+
+//for cached GL state changes:
+#include "GLState.hpp"
+
+//for glm::value_ptr() :
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+StressMode::StressMode(uint32_t ball_count_, bool gpu_balls_) : ball_count(ball_count_), gpu_balls(gpu_balls_) {
+	//(ball state is built in prepare() and OpenGL resources are created in load_step())
+}
+
+void StressMode::prepare() {
+	//----- initial ball state -----
+	{ //scatter balls around the court, outside the paddle's reach, moving in random directions:
+		std::mt19937 mt(0x15466);
+		auto rand01 = [&mt]() { return mt() / float(mt.max()); };
+		balls.reserve(ball_count);
+		while (balls.size() < ball_count) {
+			glm::vec2 at = glm::vec2(
+				(rand01() * 2.0f - 1.0f) * (court_radius.x - ball_radius.x),
+				(rand01() * 2.0f - 1.0f) * (court_radius.y - ball_radius.y)
+			);
+			if (glm::length(at) < 2.0f) continue;
+			float angle = rand01() * 6.2831853f;
+			balls.emplace_back(at.x, at.y, std::cos(angle), std::sin(angle));
+		}
+	}
+}
+
+bool StressMode::load_step() {
+	//----- get shared OpenGL resources -----
+	//(pooled, so the court's program and buffers are the same ones NewMode uses)
+	if (!program) {
+		program = GLResourcePool::get< Vertex::Program >();
+		vertex_buffer = GLResourcePool::get< GLBuffer >("2D stream vertices");
+		index_buffer = GLResourcePool::get< GLBuffer >("2D stream indices");
+		vertex_buffer_for_program = GLResourcePool::get< GLVertexArray >(
+			std::string("2D stream vertices + indices as ") + typeid(Vertex).name(), [this](){
+				return std::make_shared< GLVertexArray >(make_vertex_array< Vertex >(*program, vertex_buffer->name, index_buffer->name));
+			}
+		);
+
+		ball_instance_program = GLResourcePool::get< BallInstanceProgram >();
+		ball_sim_program = GLResourcePool::get< BallSimProgram >();
+
+		corner_buffer = square_corners_buffer();
+
+		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+		return false;
+	}
+
+	//----- allocate per-mode OpenGL resources -----
+	//(ball state depends on ball_count, so it isn't shared)
+	if (ball_buffers[0] == 0) { //ball buffers:
+		glGenBuffers(2, ball_buffers);
+		for (uint32_t i = 0; i < 2; ++i) {
+			GLState::bind_buffer(GL_ARRAY_BUFFER, ball_buffers[i]);
+			//the GPU path starts from the initial state in both buffers; the CPU path re-uploads every frame:
+			glBufferData(GL_ARRAY_BUFFER, balls.size() * sizeof(balls[0]), balls.data(), gpu_balls ? GL_DYNAMIC_COPY : GL_STREAM_DRAW);
+		}
+
+		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+		return false;
+	}
+
+	if (ball_buffer_for_sim[0] == 0) { //vertex array objects for stepping and drawing from each ball buffer:
+		glGenVertexArrays(2, ball_buffer_for_sim);
+		glGenVertexArrays(2, ball_buffer_for_instances);
+		for (uint32_t i = 0; i < 2; ++i) {
+			GLState::bind_vertex_array(ball_buffer_for_sim[i]);
+			GLState::bind_buffer(GL_ARRAY_BUFFER, ball_buffers[i]);
+			glVertexAttribPointer(ball_sim_program->Ball_vec4, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (GLbyte *)0);
+			glEnableVertexAttribArray(ball_sim_program->Ball_vec4);
+
+			GLState::bind_vertex_array(ball_buffer_for_instances[i]);
+			GLState::bind_buffer(GL_ARRAY_BUFFER, corner_buffer->name);
+			glVertexAttribPointer(ball_instance_program->Corner_vec2, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (GLbyte *)0);
+			glEnableVertexAttribArray(ball_instance_program->Corner_vec2);
+			GLState::bind_buffer(GL_ARRAY_BUFFER, ball_buffers[i]);
+			glVertexAttribPointer(ball_instance_program->Ball_vec4, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (GLbyte *)0);
+			glEnableVertexAttribArray(ball_instance_program->Ball_vec4);
+			//advance Ball once per instance (square) instead of once per vertex:
+			glVertexAttribDivisor(ball_instance_program->Ball_vec4, 1);
+		}
+		GLState::bind_vertex_array(0);
+
+		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+	}
+
+	//on the GPU path the CPU copy is no longer needed:
+	if (gpu_balls) {
+		balls.clear();
+		balls.shrink_to_fit();
+	}
+
+	return true;
+}
+
+StressMode::~StressMode() {
+
+	//----- free OpenGL resources -----
+	GLState::delete_vertex_arrays(2, ball_buffer_for_instances);
+	GLState::delete_vertex_arrays(2, ball_buffer_for_sim);
+	GLState::delete_buffers(2, ball_buffers);
+	//(shared resources are pooled -- see GLResourcePool)
+}
+
+void StressMode::handle_input(Input const &input, glm::uvec2 const &window_size) {
+
+	if (input.mouse_moved) {
+		//convert mouse from window pixels (top-left origin, +y is down) to clip space ([-1,1]x[-1,1], +y is up):
+		glm::vec2 clip_mouse = glm::vec2(
+			(input.mouse.x + 0.5f) / window_size.x * 2.0f - 1.0f,
+			(input.mouse.y + 0.5f) / window_size.y *-2.0f + 1.0f
+		);
+		arc_paddle = clip_to_court * glm::vec3(clip_mouse, 1.0f);
+	}
+}
+
+void StressMode::step_balls(float step, float paddle_theta) {
+	glm::vec2 lim = court_radius - ball_radius;
+	for (auto &ball : balls) {
+		glm::vec2 at = glm::vec2(ball.x, ball.y) + step * glm::vec2(ball.z, ball.w);
+		glm::vec2 vel = glm::vec2(ball.z, ball.w);
+
+		//arc paddle: reflect inward-moving balls off the arc's radial normal:
+		float r = glm::length(at);
+		if (r >= 1.0f - ball_radius.x && r <= 1.35f + ball_radius.x) {
+			float d = std::atan2(at.y, at.x) - paddle_theta;
+			d -= 6.2831853f * std::floor((d + 3.1415927f) / 6.2831853f);
+			if (d >= -0.5f && d <= 0.5f) {
+				glm::vec2 n = at / r;
+				float vn = glm::dot(vel, n);
+				if (vn < 0.0f) vel -= 2.0f * vn * n;
+			}
+		}
+
+		//court walls:
+		if (at.x >  lim.x) { at.x =  lim.x; vel.x = -std::abs(vel.x); }
+		if (at.x < -lim.x) { at.x = -lim.x; vel.x =  std::abs(vel.x); }
+		if (at.y >  lim.y) { at.y =  lim.y; vel.y = -std::abs(vel.y); }
+		if (at.y < -lim.y) { at.y = -lim.y; vel.y =  std::abs(vel.y); }
+
+		//center square:
+		if (std::abs(at.x) <= 2.0f * ball_radius.x && std::abs(at.y) <= 2.0f * ball_radius.y) {
+			at.x = (at.x < 0.0f ? 1.0f : -1.0f) * (court_radius.x - 1.0f);
+			vel = -vel;
+		}
+
+		ball = glm::vec4(at.x, at.y, vel.x, vel.y);
+	}
+}
+
+void StressMode::update(float elapsed) {
+	auto before = std::chrono::high_resolution_clock::now();
+
+	float paddle_theta = std::atan2(arc_paddle.y, arc_paddle.x);
+	float step = elapsed * speed_multiplier;
+
+	if (gpu_balls) {
+		//step ball_buffers[current] into ball_buffers[next] without rasterizing anything:
+		uint32_t next_ball_buffer = 1 - current_ball_buffer;
+
+		GLState::use_program(ball_sim_program->program);
+		glUniform1f(ball_sim_program->STEP_float, step);
+		glUniform2fv(ball_sim_program->COURT_RADIUS_vec2, 1, glm::value_ptr(court_radius));
+		glUniform2fv(ball_sim_program->BALL_RADIUS_vec2, 1, glm::value_ptr(ball_radius));
+		glUniform1f(ball_sim_program->PADDLE_THETA_float, paddle_theta);
+
+		GLState::enable(GL_RASTERIZER_DISCARD);
+		GLState::bind_vertex_array(ball_buffer_for_sim[current_ball_buffer]);
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, ball_buffers[next_ball_buffer]);
+
+		glBeginTransformFeedback(GL_POINTS);
+		glDrawArrays(GL_POINTS, 0, GLsizei(ball_count));
+		glEndTransformFeedback();
+
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+		GLState::disable(GL_RASTERIZER_DISCARD);
+
+		current_ball_buffer = next_ball_buffer;
+
+		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+	} else {
+		step_balls(step, paddle_theta);
+	}
+
+	auto after = std::chrono::high_resolution_clock::now();
+	report_update_seconds += std::chrono::duration< double >(after - before).count();
+
+	//print timing every couple of seconds:
+	report_timer += elapsed;
+	report_frames += 1;
+	if (report_timer > 2.0f) {
+		std::cout << "StressMode: " << ball_count << " balls (" << (gpu_balls ? "gpu" : "cpu") << "), "
+		          << "update " << (report_update_seconds / report_frames * 1000.0) << " ms, "
+		          << "draw " << (report_draw_seconds / report_frames * 1000.0) << " ms per frame." << std::endl;
+		report_timer = 0.0f;
+		report_frames = 0;
+		report_update_seconds = 0.0;
+		report_draw_seconds = 0.0;
+	}
+}
+
+void StressMode::draw(glm::uvec2 const &drawable_size) {
+	auto before = std::chrono::high_resolution_clock::now();
+
+	//some nice colors from the course web page:
+#define HEX_TO_U8VEC4( HX ) (glm::u8vec4( (HX >> 24) & 0xff, (HX >> 16) & 0xff, (HX >> 8) & 0xff, (HX) & 0xff ))
+	const glm::u8vec4 bg_color = HEX_TO_U8VEC4(0x171714ff);
+	const glm::u8vec4 fg_color = HEX_TO_U8VEC4(0xd1bb54ff);
+	const glm::u8vec4 shadow_color = HEX_TO_U8VEC4(0x604d29ff);
+#undef HEX_TO_U8VEC4
+
+	//other useful drawing constants:
+	const float wall_radius = 0.05f;
+	const float shadow_offset = 0.07f;
+	const float padding = 0.14f; //padding between outside of walls and edge of window
+
+	//---- compute court vertices to draw ----
+
+	std::vector< Vertex > vertices;
+	std::vector< GLushort > indices;
+	const GLushort restart_index = 0xffff;
+
+	auto begin_strip = [&indices, &restart_index]() {
+		if (!indices.empty()) indices.emplace_back(restart_index);
+	};
+
+	auto draw_rectangle = [&vertices, &indices, &begin_strip](glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color) {
+		begin_strip();
+		GLushort base = GLushort(vertices.size());
+		vertices.emplace_back(glm::vec2(center.x - radius.x, center.y - radius.y), color);
+		vertices.emplace_back(glm::vec2(center.x + radius.x, center.y - radius.y), color);
+		vertices.emplace_back(glm::vec2(center.x - radius.x, center.y + radius.y), color);
+		vertices.emplace_back(glm::vec2(center.x + radius.x, center.y + radius.y), color);
+		for (GLushort i = 0; i < 4; ++i) {
+			indices.emplace_back(base + i);
+		}
+	};
+
+	auto draw_arc = [&vertices, &indices, &begin_strip](glm::vec2 const &center, glm::u8vec4 const &color) {
+		float theta = std::atan2(center.y, center.x);
+		begin_strip();
+		GLushort base = GLushort(vertices.size());
+		for (int i = -2; i <= 2; i++) {
+			float c = std::cos(theta + 0.25f * i);
+			float s = std::sin(theta + 0.25f * i);
+			vertices.emplace_back(glm::vec2(1.0f * c,  1.0f * s),  color);
+			vertices.emplace_back(glm::vec2(1.35f * c, 1.35f * s), color);
+		}
+		for (GLushort i = 0; i < 10; ++i) {
+			indices.emplace_back(base + i);
+		}
+	};
+
+	glm::vec2 s = glm::vec2(0.0f, -shadow_offset);
+
+	draw_arc(arc_paddle + s, shadow_color);
+	draw_rectangle(glm::vec2(-court_radius.x - wall_radius, 0.0f) + s, glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), shadow_color);
+	draw_rectangle(glm::vec2(court_radius.x + wall_radius, 0.0f) + s, glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), shadow_color);
+	draw_rectangle(glm::vec2(0.0f, -court_radius.y - wall_radius) + s, glm::vec2(court_radius.x, wall_radius), shadow_color);
+	draw_rectangle(glm::vec2(0.0f, court_radius.y + wall_radius) + s, glm::vec2(court_radius.x, wall_radius), shadow_color);
+
+	draw_rectangle(glm::vec2(0.0f, 0.0f), ball_radius, fg_color);
+	draw_arc(arc_paddle, fg_color);
+	draw_rectangle(glm::vec2(-court_radius.x - wall_radius, 0.0f), glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), fg_color);
+	draw_rectangle(glm::vec2(court_radius.x + wall_radius, 0.0f), glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), fg_color);
+	draw_rectangle(glm::vec2(0.0f, -court_radius.y - wall_radius), glm::vec2(court_radius.x, wall_radius), fg_color);
+	draw_rectangle(glm::vec2(0.0f, court_radius.y + wall_radius), glm::vec2(court_radius.x, wall_radius), fg_color);
+
+	//------ compute court-to-window transform ------
+
+	glm::vec2 scene_min = -court_radius - glm::vec2(2.0f * wall_radius + padding);
+	glm::vec2 scene_max =  court_radius + glm::vec2(2.0f * wall_radius + padding);
+
+	float aspect = drawable_size.x / float(drawable_size.y);
+	float scale = std::min(
+		(2.0f * aspect) / (scene_max.x - scene_min.x),
+		(2.0f) / (scene_max.y - scene_min.y)
+	);
+	glm::vec2 center = 0.5f * (scene_max + scene_min);
+
+	glm::mat4 court_to_clip = glm::mat4(
+		glm::vec4(scale / aspect, 0.0f, 0.0f, 0.0f),
+		glm::vec4(0.0f, scale, 0.0f, 0.0f),
+		glm::vec4(0.0f, 0.0f, 1.0f, 0.0f),
+		glm::vec4(-center.x * (scale / aspect), -center.y * scale, 0.0f, 1.0f)
+	);
+
+	clip_to_court = glm::mat3x2(
+		glm::vec2(aspect / scale, 0.0f),
+		glm::vec2(0.0f, 1.0f / scale),
+		glm::vec2(center.x, center.y)
+	);
+
+	//---- actual drawing ----
+
+	GLState::clear_color(bg_color.r / 255.0f, bg_color.g / 255.0f, bg_color.b / 255.0f, bg_color.a / 255.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	GLState::enable(GL_BLEND);
+	GLState::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLState::disable(GL_DEPTH_TEST);
+
+	{ //court, center, and paddle:
+		GLState::bind_buffer(GL_ARRAY_BUFFER, vertex_buffer->name);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertices[0]), vertices.data(), GL_STREAM_DRAW);
+
+		GLState::use_program(program->program);
+		glUniformMatrix4fv(program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
+
+		GLState::bind_vertex_array(vertex_buffer_for_program->name);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(indices[0]), indices.data(), GL_STREAM_DRAW);
+
+		//(left enabled; the instanced draw below doesn't index, so restarting can't affect it)
+		GLState::enable(GL_PRIMITIVE_RESTART);
+		GLState::primitive_restart_index(restart_index);
+		glDrawElements(GL_TRIANGLE_STRIP, GLsizei(indices.size()), GL_UNSIGNED_SHORT, (GLbyte *)0);
+	}
+
+	{ //balls, as one instanced draw:
+		if (!gpu_balls) {
+			//orphan + refill the ball buffer with this frame's CPU state:
+			GLState::bind_buffer(GL_ARRAY_BUFFER, ball_buffers[0]);
+			glBufferData(GL_ARRAY_BUFFER, balls.size() * sizeof(balls[0]), balls.data(), GL_STREAM_DRAW);
+		}
+
+		GLState::use_program(ball_instance_program->program);
+		glUniformMatrix4fv(ball_instance_program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
+		glUniform2fv(ball_instance_program->BALL_RADIUS_vec2, 1, glm::value_ptr(ball_radius));
+		glm::vec4 color = glm::vec4(fg_color) / 255.0f;
+		glUniform4fv(ball_instance_program->COLOR_vec4, 1, glm::value_ptr(color));
+
+		GLState::bind_vertex_array(ball_buffer_for_instances[gpu_balls ? current_ball_buffer : 0]);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(ball_count));
+	}
+
+	GL_ERRORS(); //PARANOIA: print errors just in case we did something wrong.
+
+	auto after = std::chrono::high_resolution_clock::now();
+	report_draw_seconds += std::chrono::duration< double >(after - before).count();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Vertex2D.hpp"
+#include "BallInstanceProgram.hpp"
+#include "BallSimProgram.hpp"
+#include "GLResourcePool.hpp"
+
+#include "Mode.hpp"
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/*
+ * StressMode fills NewMode's court with a very large number of balls for profiling.
+ * Balls move, bounce off the walls and the arc paddle, and are sent back out when they
+ *  reach the center square (no ball-vs-ball collisions and no health, so it runs forever).
+ *
+ * With gpu_balls, ball state lives in a pair of GL buffers that BallSimProgram steps
+ *  via transform feedback; the instanced ball draw reads the result directly, so ball
+ *  data never round-trips through the CPU. Otherwise balls are stepped on the CPU
+ *  (step_balls) and uploaded for the same instanced draw.
+ */
+
+struct StressMode : Mode {
+	StressMode(uint32_t ball_count, bool gpu_balls);
+	virtual ~StressMode();
+
+	//functions called by main loop:
+	virtual void prepare() override;
+	virtual bool load_step() override;
+	virtual void handle_input(Input const &, glm::uvec2 const &window_size) override;
+	virtual void update(float elapsed) override;
+	virtual void draw(glm::uvec2 const &drawable_size) override;
+
+	//----- game state -----
+
+	glm::vec2 court_radius = glm::vec2(7.0f, 5.0f);
+	glm::vec2 ball_radius = glm::vec2(0.05f, 0.05f);
+
+	glm::vec2 arc_paddle = glm::vec2(1.0f, 0.0f);
+
+	float speed_multiplier = 2.0f;
+
+	uint32_t ball_count = 0;
+	bool gpu_balls = false;
+
+	//balls as (x, y, vx, vy); only kept up to date on the CPU when !gpu_balls:
+	std::vector< glm::vec4 > balls;
+
+	//advance all balls by 'step' (elapsed time * speed multiplier) using the same rules as BallSimProgram:
+	void step_balls(float step, float paddle_theta);
+
+	//----- timing report -----
+
+	//time spent in update() and draw() (CPU side), printed every couple of seconds:
+	float report_timer = 0.0f;
+	uint32_t report_frames = 0;
+	double report_update_seconds = 0.0;
+	double report_draw_seconds = 0.0;
+
+	//----- opengl assets / helpers ------
+
+	//court, center, and paddle are drawn with the same layout (and pooled resources) as NewMode:
+	typedef PosColVertex Vertex;
+	std::shared_ptr< Vertex::Program > program;
+	std::shared_ptr< GLBuffer > vertex_buffer;
+	std::shared_ptr< GLBuffer > index_buffer;
+	std::shared_ptr< GLVertexArray > vertex_buffer_for_program;
+
+	//Shader programs for drawing and (with gpu_balls) stepping balls:
+	std::shared_ptr< BallInstanceProgram > ball_instance_program;
+	std::shared_ptr< BallSimProgram > ball_sim_program;
+
+	//The four corners of a square, as a triangle strip:
+	std::shared_ptr< GLBuffer > corner_buffer;
+
+	//Ball state buffers; the CPU path only uses ball_buffers[0], the GPU path ping-pongs between them:
+	GLuint ball_buffers[2] = {0, 0};
+	uint32_t current_ball_buffer = 0;
+
+	//Vertex Array Objects reading ball_buffers[i] as BallSimProgram input:
+	GLuint ball_buffer_for_sim[2] = {0, 0};
+
+	//Vertex Array Objects reading corner_buffer per-vertex and ball_buffers[i] per-instance for BallInstanceProgram:
+	GLuint ball_buffer_for_instances[2] = {0, 0};
+
+	//matrix that maps from clip coordinates to court-space coordinates:
+	glm::mat3x2 clip_to_court = glm::mat3x2(1.0f);
+	// computed in draw() as the inverse of OBJECT_TO_CLIP
+	// (stored here so that the mouse handling code can use it to position the paddle)
+};
@@ -0,0 +1,158 @@
+#include "Texture.hpp"
+
+#include "gl_errors.hpp"
+#include "GLState.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+uint32_t Texture::uploads_created = 0;
+uint32_t Texture::uploads_shared = 0;
+
+//static textures that are on the GPU, keyed by size + options + pixel hash:
+// (each keeps a copy of its pixels, so a hash collision can't hand back the wrong texture;
+//  entries are erased when their texture is destroyed)
+struct SharedTexture {
+	std::weak_ptr< Texture > texture;
+	std::vector< glm::u8vec4 > pixels;
+};
+static std::unordered_multimap< std::string, SharedTexture > &shared_textures() {
+	static std::unordered_multimap< std::string, SharedTexture > textures;
+	return textures;
+}
+
+static std::string texture_key(glm::uvec2 const &size, glm::u8vec4 const *data, Texture::Options const &options) {
+	//64-bit FNV-1a over the pixel bytes:
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	uint8_t const *bytes = reinterpret_cast< uint8_t const * >(data);
+	for (size_t i = 0; i < size_t(size.x) * size.y * 4; ++i) {
+		hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+	}
+	return std::to_string(size.x) + "x" + std::to_string(size.y)
+		+ " m" + std::to_string(options.mipmaps)
+		+ " f" + std::to_string(options.filter)
+		+ " w" + std::to_string(options.wrap)
+		+ " #" + std::to_string(hash);
+}
+
+//copy pixels into the (bound) GL_PIXEL_UNPACK_BUFFER, orphaning its old contents so we never wait on a previous upload:
+static void stage_pixels(glm::uvec2 const &size, glm::u8vec4 const *data) {
+	GLsizeiptr bytes = GLsizeiptr(size.x) * size.y * sizeof(glm::u8vec4);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+	void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (!mapped) {
+		throw std::runtime_error("Failed to map texture staging buffer.");
+	}
+	std::memcpy(mapped, data, bytes);
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+}
+
+std::shared_ptr< Texture > Texture::upload(glm::uvec2 const &size, glm::u8vec4 const *data, Options const &options) {
+	//look for an identical static texture that is already uploaded:
+	std::string key;
+	if (!options.dynamic) {
+		key = texture_key(size, data, options);
+		size_t bytes = size_t(size.x) * size.y * sizeof(glm::u8vec4);
+		auto range = shared_textures().equal_range(key);
+		for (auto f = range.first; f != range.second; ++f) {
+			std::shared_ptr< Texture > existing = f->second.texture.lock();
+			if (existing && std::memcmp(f->second.pixels.data(), data, bytes) == 0) {
+				uploads_shared += 1;
+				return existing;
+			}
+		}
+	}
+
+	std::shared_ptr< Texture > texture(new Texture);
+	texture->size = size;
+	texture->options = options;
+
+	//stage the pixels in a pixel buffer object:
+	glGenBuffers(1, &texture->staging_buffer);
+	GLState::bind_buffer(GL_PIXEL_UNPACK_BUFFER, texture->staging_buffer);
+	stage_pixels(size, data);
+
+	//allocate the texture and fill it from the staging buffer (the data pointer is an offset into the bound buffer):
+	glGenTextures(1, &texture->tex);
+	GLState::bind_texture(GL_TEXTURE_2D, texture->tex);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLbyte *)0);
+	//(unbind: while a buffer is bound here, other pixel uploads would read from it instead of client memory)
+	GLState::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	//set filtering and wrapping parameters:
+	if (options.mipmaps) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, options.filter == GL_NEAREST ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR);
+	} else {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, options.filter);
+		//without this, the texture would be incomplete (and sample as black) until a mip chain existed:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, options.filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, options.wrap);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, options.wrap);
+
+	if (options.mipmaps) {
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+
+	//static textures won't be updated, so their staging buffer can go:
+	if (!options.dynamic) {
+		GLState::delete_buffers(1, &texture->staging_buffer);
+		texture->staging_buffer = 0;
+		texture->shared_key = key;
+		shared_textures().emplace(key, SharedTexture{ texture, std::vector< glm::u8vec4 >(data, data + size_t(size.x) * size.y) });
+	}
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+
+	uploads_created += 1;
+	return texture;
+}
+
+std::shared_ptr< Texture > Texture::upload(glm::uvec2 const &size, std::vector< glm::u8vec4 > const &data, Options const &options) {
+	if (data.size() != size_t(size.x) * size.y) {
+		throw std::runtime_error("Texture data has " + std::to_string(data.size()) + " pixels, expected " + std::to_string(size.x) + "x" + std::to_string(size.y) + ".");
+	}
+	return upload(size, data.data(), options);
+}
+
+void Texture::update(glm::uvec2 const &offset, glm::uvec2 const &update_size, glm::u8vec4 const *data) {
+	if (!options.dynamic) {
+		throw std::runtime_error("Texture::update() called on a static (possibly shared) texture.");
+	}
+	if (offset.x + update_size.x > size.x || offset.y + update_size.y > size.y) {
+		throw std::runtime_error("Texture::update() rectangle is outside the texture.");
+	}
+
+	GLState::bind_buffer(GL_PIXEL_UNPACK_BUFFER, staging_buffer);
+	stage_pixels(update_size, data);
+
+	GLState::bind_texture(GL_TEXTURE_2D, tex);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, offset.x, offset.y, update_size.x, update_size.y, GL_RGBA, GL_UNSIGNED_BYTE, (GLbyte *)0);
+	GLState::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (options.mipmaps) {
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+Texture::~Texture() {
+	//forget this texture's shared entry (its weak_ptr has already expired):
+	if (!shared_key.empty()) {
+		auto range = shared_textures().equal_range(shared_key);
+		for (auto f = range.first; f != range.second; ) {
+			if (f->second.texture.expired()) f = shared_textures().erase(f);
+			else ++f;
+		}
+	}
+
+	GLState::delete_buffers(1, &staging_buffer);
+	staging_buffer = 0;
+
+	GLState::delete_textures(1, &tex);
+	tex = 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Texture wraps an RGBA8 GL_TEXTURE_2D:
+ *  - pixels are staged through a pixel buffer object (GL_PIXEL_UNPACK_BUFFER)
+ *  - mipmaps are only built when Options::mipmaps is set
+ *  - static textures are shared: upload() with the same size, pixels, and options
+ *    returns the texture that is already on the GPU (as long as someone still holds it)
+ *  - dynamic textures are never shared and can be streamed into with update()
+ */
+
+struct Texture {
+	struct Options {
+		bool mipmaps = false; //build a mip chain (and use it for minification)
+		bool dynamic = false; //contents will change via update(); never shared
+		GLenum filter = GL_LINEAR; //GL_LINEAR or GL_NEAREST
+		GLenum wrap = GL_REPEAT; //GL_REPEAT or GL_CLAMP_TO_EDGE
+	};
+
+	//upload size.x * size.y pixels (rows bottom-to-top, as OpenGL expects):
+	static std::shared_ptr< Texture > upload(glm::uvec2 const &size, glm::u8vec4 const *data, Options const &options);
+	static std::shared_ptr< Texture > upload(glm::uvec2 const &size, std::vector< glm::u8vec4 > const &data, Options const &options);
+
+	//replace the pixels in [offset, offset + size) with data (dynamic textures only):
+	void update(glm::uvec2 const &offset, glm::uvec2 const &size, glm::u8vec4 const *data);
+
+	~Texture();
+
+	GLuint tex = 0;
+	glm::uvec2 size = glm::uvec2(0);
+	Options options;
+
+	//pixel buffer object kept around for dynamic textures' update() calls:
+	GLuint staging_buffer = 0;
+
+	//counts of upload() calls that created a texture vs. returned a shared one:
+	static uint32_t uploads_created;
+	static uint32_t uploads_shared;
+
+private:
+	std::string shared_key; //(static textures: key in the table of shared textures)
+
+	Texture() = default;
+	Texture(Texture const &) = delete;
+	Texture &operator=(Texture const &) = delete;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * TripleBuffer hands values of type T from one writer thread to one reader thread
+ *  without locks and without either side ever waiting for the other.
+ *
+ * The writer fills back() and calls publish(); the reader calls fetch() and then
+ *  reads front(), which always holds the most recently published value (older
+ *  unread values are simply skipped). A third slot sits between the two, so
+ *  neither thread ever touches the slot the other one is using.
+ *
+ * Usage:
+ *   //writer thread:                 //reader thread:
+ *   buffer.back() = state;           buffer.fetch();
+ *   buffer.publish();                draw(buffer.front());
+ */
+
+template< typename T >
+struct TripleBuffer {
+	//----- writer side -----
+	T &back() { return slots[back_index]; }
+	void publish() {
+		//swap back with middle, marking middle as fresh:
+		back_index = middle.exchange(uint8_t(back_index | Fresh), std::memory_order_acq_rel) & IndexMask;
+	}
+
+	//----- reader side -----
+	//returns true if front() changed:
+	bool fetch() {
+		if (!(middle.load(std::memory_order_acquire) & Fresh)) return false;
+		//swap front with middle (which is now stale):
+		front_index = middle.exchange(front_index, std::memory_order_acq_rel) & IndexMask;
+		return true;
+	}
+	T const &front() const { return slots[front_index]; }
+
+private:
+	enum : uint8_t { IndexMask = 0x3, Fresh = 0x4 };
+	T slots[3];
+	uint8_t back_index = 0; //(only touched by the writer)
+	std::atomic< uint8_t > middle{ 1 }; //index of the middle slot + Fresh if it hasn't been fetched
+	uint8_t front_index = 2; //(only touched by the reader)
+};
@@ -0,0 +1,140 @@
+#include "UdpSocket.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+typedef SOCKET NativeSocket;
+static void close_socket(NativeSocket s) { closesocket(s); WSACleanup(); }
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int NativeSocket;
+static void close_socket(NativeSocket s) { close(s); }
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+static double now_seconds() {
+	return std::chrono::duration< double >(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string UdpSocket::Address::to_string() const {
+	return std::to_string((ip >> 24) & 0xff) + "." + std::to_string((ip >> 16) & 0xff) + "."
+	     + std::to_string((ip >> 8) & 0xff) + "." + std::to_string(ip & 0xff) + ":" + std::to_string(port);
+}
+
+UdpSocket::Address UdpSocket::Address::parse(std::string const &str) {
+	Address address;
+	auto colon = str.rfind(':');
+	try {
+		if (colon != std::string::npos) {
+			in_addr addr;
+			if (inet_pton(AF_INET, str.substr(0, colon).c_str(), &addr) != 1) throw std::invalid_argument("ip");
+			address.ip = ntohl(addr.s_addr);
+		}
+		unsigned long port = std::stoul(str.substr(colon == std::string::npos ? 0 : colon + 1));
+		if (port == 0 || port > 0xffff) throw std::out_of_range("port");
+		address.port = uint16_t(port);
+	} catch (std::logic_error const &) {
+		throw std::runtime_error("Expected an address like '127.0.0.1:15466' or a port number, got '" + str + "'.");
+	}
+	return address;
+}
+
+UdpSocket::UdpSocket(uint16_t port) {
+	#ifdef _WIN32
+	WSADATA wsa_data;
+	if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) throw std::runtime_error("Failed to start winsock.");
+	#endif
+
+	NativeSocket s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (intptr_t(s) < 0) throw std::runtime_error("Failed to create UDP socket.");
+
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+	if (bind(s, reinterpret_cast< sockaddr * >(&addr), sizeof(addr)) != 0) {
+		close_socket(s);
+		throw std::runtime_error("Failed to bind UDP port " + std::to_string(port) + ".");
+	}
+
+	socklen_t len = sizeof(addr);
+	getsockname(s, reinterpret_cast< sockaddr * >(&addr), &len);
+	bound_port = ntohs(addr.sin_port);
+
+	//non-blocking, so receive() returns immediately when nothing is waiting:
+	#ifdef _WIN32
+	u_long non_blocking = 1;
+	ioctlsocket(s, FIONBIO, &non_blocking);
+	#else
+	fcntl(s, F_SETFL, fcntl(s, F_GETFL) | O_NONBLOCK);
+	#endif
+
+	handle = intptr_t(s);
+}
+
+UdpSocket::~UdpSocket() {
+	if (handle >= 0) close_socket(NativeSocket(handle));
+}
+
+void UdpSocket::send(Address const &to, void const *data, size_t size) {
+	packets_sent += 1;
+	bytes_sent += size;
+
+	if (conditions.loss > 0.0f && std::uniform_real_distribution< float >(0.0f, 1.0f)(link_rng) < conditions.loss) {
+		packets_dropped += 1;
+		return;
+	}
+
+	if (conditions.latency <= 0.0f && conditions.jitter <= 0.0f) {
+		send_now(to, data, size);
+		return;
+	}
+
+	InFlight packet;
+	packet.send_at = now_seconds() + conditions.latency + std::uniform_real_distribution< float >(0.0f, conditions.jitter)(link_rng);
+	packet.to = to;
+	packet.data.assign(reinterpret_cast< uint8_t const * >(data), reinterpret_cast< uint8_t const * >(data) + size);
+	//keep in_flight sorted by send time (jitter can reorder packets):
+	auto at = std::upper_bound(in_flight.begin(), in_flight.end(), packet.send_at, [](double t, InFlight const &p){ return t < p.send_at; });
+	in_flight.insert(at, std::move(packet));
+}
+
+void UdpSocket::poll() {
+	double now = now_seconds();
+	while (!in_flight.empty() && in_flight.front().send_at <= now) {
+		send_now(in_flight.front().to, in_flight.front().data.data(), in_flight.front().data.size());
+		in_flight.pop_front();
+	}
+}
+
+void UdpSocket::send_now(Address const &to, void const *data, size_t size) {
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(to.ip);
+	addr.sin_port = htons(to.port);
+	sendto(NativeSocket(handle), reinterpret_cast< char const * >(data), int(size), 0, reinterpret_cast< sockaddr * >(&addr), sizeof(addr));
+}
+
+size_t UdpSocket::receive(void *data, size_t capacity, Address *from) {
+	sockaddr_in addr = {};
+	socklen_t len = sizeof(addr);
+	auto got = recvfrom(NativeSocket(handle), reinterpret_cast< char * >(data), int(capacity), 0, reinterpret_cast< sockaddr * >(&addr), &len);
+	if (got <= 0) return 0;
+
+	if (from) {
+		from->ip = ntohl(addr.sin_addr.s_addr);
+		from->port = ntohs(addr.sin_port);
+	}
+	packets_received += 1;
+	bytes_received += size_t(got);
+	return size_t(got);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * UdpSocket is a non-blocking IPv4 UDP socket, plus an optional simulated bad link.
+ *
+ * Set 'conditions' to delay, jitter, and drop outgoing packets (so networked
+ *  modes can be tested over localhost as if over a real network); delayed
+ *  packets are held in 'in_flight' and actually sent by a later poll().
+ *
+ * Counts packets and bytes in each direction (headers not included), so callers
+ *  can report bandwidth.
+ *
+ * Errors opening the socket are reported by throwing std::runtime_error;
+ *  send/receive failures just drop the packet (it's UDP, after all).
+ */
+
+struct UdpSocket {
+	struct Address {
+		uint32_t ip = 0x7f000001; //host byte order; default is 127.0.0.1
+		uint16_t port = 0;
+		bool operator==(Address const &o) const { return ip == o.ip && port == o.port; }
+		bool operator!=(Address const &o) const { return !(*this == o); }
+		std::string to_string() const;
+		//parse "a.b.c.d:port" or just "port" (meaning localhost):
+		static Address parse(std::string const &str);
+	};
+
+	//bind to 'port' on all interfaces (port 0 picks any free port):
+	UdpSocket(uint16_t port = 0);
+	~UdpSocket();
+	UdpSocket(UdpSocket const &) = delete;
+
+	//the port actually bound:
+	uint16_t port() const { return bound_port; }
+	//the OS socket (e.g., to wait on it with epoll):
+	intptr_t native_handle() const { return handle; }
+
+	//send a packet (possibly via the simulated link):
+	void send(Address const &to, void const *data, size_t size);
+	//receive one packet if one is waiting; returns its size (0 if none):
+	size_t receive(void *data, size_t capacity, Address *from);
+
+	//send any simulated in-flight packets whose time has come (call every frame):
+	void poll();
+
+	//----- simulated link -----
+	struct LinkConditions {
+		float latency = 0.0f; //seconds of one-way delay added to every packet
+		float jitter = 0.0f; //plus up to this many more seconds, at random (packets may arrive out of order)
+		float loss = 0.0f; //fraction of packets dropped
+	} conditions;
+
+	struct InFlight {
+		double send_at;
+		Address to;
+		std::vector< uint8_t > data;
+	};
+	std::deque< InFlight > in_flight; //ordered by send_at
+	std::mt19937 link_rng = std::mt19937(0x0dd1ce);
+
+	//----- statistics -----
+	uint64_t packets_sent = 0, bytes_sent = 0;
+	uint64_t packets_received = 0, bytes_received = 0;
+	uint64_t packets_dropped = 0; //(by the simulated link)
+
+private:
+	void send_now(Address const &to, void const *data, size_t size);
+	intptr_t handle = -1;
+	uint16_t bound_port = 0;
+};
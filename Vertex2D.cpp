@@ -0,0 +1,85 @@
+#include "Vertex2D.hpp"
+
+#include <glm/gtc/packing.hpp>
+
+void PosColTexVertex::describe(Program const &program) {
+	glVertexAttribPointer(
+		program.Position_vec4, //attribute
+		3, //size
+		GL_FLOAT, //type
+		GL_FALSE, //normalized
+		sizeof(PosColTexVertex), //stride
+		(GLbyte *)0 + 0 //offset
+	);
+	glEnableVertexAttribArray(program.Position_vec4);
+	//[Note that it is okay to bind a vec3 input to a vec4 attribute -- the w component will be filled with 1.0 automatically]
+
+	glVertexAttribPointer(
+		program.Color_vec4, //attribute
+		4, //size
+		GL_UNSIGNED_BYTE, //type
+		GL_TRUE, //normalized
+		sizeof(PosColTexVertex), //stride
+		(GLbyte *)0 + 4*3 //offset
+	);
+	glEnableVertexAttribArray(program.Color_vec4);
+
+	glVertexAttribPointer(
+		program.TexCoord_vec2, //attribute
+		2, //size
+		GL_FLOAT, //type
+		GL_FALSE, //normalized
+		sizeof(PosColTexVertex), //stride
+		(GLbyte *)0 + 4*3 + 4*1 //offset
+	);
+	glEnableVertexAttribArray(program.TexCoord_vec2);
+}
+
+void PosColVertex::describe(Program const &program) {
+	glVertexAttribPointer(
+		program.Position_vec4, //attribute
+		2, //size
+		GL_FLOAT, //type
+		GL_FALSE, //normalized
+		sizeof(PosColVertex), //stride
+		(GLbyte *)0 + 0 //offset
+	);
+	glEnableVertexAttribArray(program.Position_vec4);
+	//[a vec2 input to a vec4 attribute gets z = 0.0 and w = 1.0 filled in automatically]
+
+	glVertexAttribPointer(
+		program.Color_vec4, //attribute
+		4, //size
+		GL_UNSIGNED_BYTE, //type
+		GL_TRUE, //normalized
+		sizeof(PosColVertex), //stride
+		(GLbyte *)0 + 4*2 //offset
+	);
+	glEnableVertexAttribArray(program.Color_vec4);
+}
+
+HalfPosColVertex::HalfPosColVertex(glm::vec2 const &Position_, glm::u8vec4 const &Color_) :
+	Position(glm::packHalf1x16(Position_.x), glm::packHalf1x16(Position_.y)), Color(Color_) {
+}
+
+void HalfPosColVertex::describe(Program const &program) {
+	glVertexAttribPointer(
+		program.Position_vec4, //attribute
+		2, //size
+		GL_HALF_FLOAT, //type
+		GL_FALSE, //normalized
+		sizeof(HalfPosColVertex), //stride
+		(GLbyte *)0 + 0 //offset
+	);
+	glEnableVertexAttribArray(program.Position_vec4);
+
+	glVertexAttribPointer(
+		program.Color_vec4, //attribute
+		4, //size
+		GL_UNSIGNED_BYTE, //type
+		GL_TRUE, //normalized
+		sizeof(HalfPosColVertex), //stride
+		(GLbyte *)0 + 2*2 //offset
+	);
+	glEnableVertexAttribArray(program.Color_vec4);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ColorTextureProgram.hpp"
+#include "ColorProgram.hpp"
+#include "GL.hpp"
+#include "GLState.hpp"
+
+#include <glm/glm.hpp>
+
+/*
+ * Vertex layouts for the 2D modes.
+ *
+ * Each layout names the shader program that draws it, can be built from a
+ *  (court-space position, color) pair, and knows how to describe itself to a vertex array object.
+ * A mode picks its layout at compile time with a typedef, e.g.:
+ *   typedef PosColVertex Vertex;
+ *   Vertex::Program program;
+ *   vao = make_vertex_array< Vertex >(program, vertex_buffer, index_buffer);
+ */
+
+//24 bytes -- full position, color, and texture coordinate; drawn with ColorTextureProgram:
+struct PosColTexVertex {
+	typedef ColorTextureProgram Program;
+	static constexpr bool UsesTexture = true;
+
+	PosColTexVertex(glm::vec3 const &Position_, glm::u8vec4 const &Color_, glm::vec2 const &TexCoord_) :
+		Position(Position_), Color(Color_), TexCoord(TexCoord_) { }
+	PosColTexVertex(glm::vec2 const &Position_, glm::u8vec4 const &Color_) :
+		Position(Position_, 0.0f), Color(Color_), TexCoord(0.5f, 0.5f) { }
+	glm::vec3 Position;
+	glm::u8vec4 Color;
+	glm::vec2 TexCoord;
+
+	//set up attribute pointers for the buffer currently bound to GL_ARRAY_BUFFER:
+	static void describe(Program const &program);
+};
+static_assert(sizeof(PosColTexVertex) == 4*3 + 1*4 + 4*2, "PosColTexVertex should be packed");
+
+//12 bytes -- 2D float position and color; drawn with ColorProgram:
+struct PosColVertex {
+	typedef ColorProgram Program;
+	static constexpr bool UsesTexture = false;
+
+	PosColVertex(glm::vec2 const &Position_, glm::u8vec4 const &Color_) :
+		Position(Position_), Color(Color_) { }
+	glm::vec2 Position;
+	glm::u8vec4 Color;
+
+	//set up attribute pointers for the buffer currently bound to GL_ARRAY_BUFFER:
+	static void describe(Program const &program);
+};
+static_assert(sizeof(PosColVertex) == 4*2 + 1*4, "PosColVertex should be packed");
+
+//8 bytes -- 2D half-float position and color; drawn with ColorProgram:
+// (halves are exact to about 1/256 of a unit for coordinates in [-8,8], which is plenty for the courts)
+struct HalfPosColVertex {
+	typedef ColorProgram Program;
+	static constexpr bool UsesTexture = false;
+
+	HalfPosColVertex(glm::vec2 const &Position_, glm::u8vec4 const &Color_);
+	glm::u16vec2 Position; //IEEE half-float bit patterns
+	glm::u8vec4 Color;
+
+	//set up attribute pointers for the buffer currently bound to GL_ARRAY_BUFFER:
+	static void describe(Program const &program);
+};
+static_assert(sizeof(HalfPosColVertex) == 2*2 + 1*4, "HalfPosColVertex should be packed");
+
+//make a vertex array object that reads Vertex-s from vertex_buffer using Vertex's program;
+// if index_buffer is non-zero, it is also recorded as the element array buffer:
+template< typename Vertex >
+GLuint make_vertex_array(typename Vertex::Program const &program, GLuint vertex_buffer, GLuint index_buffer = 0) {
+	GLuint vertex_array = 0;
+	glGenVertexArrays(1, &vertex_array);
+	GLState::bind_vertex_array(vertex_array);
+
+	//set vertex_buffer as the source of glVertexAttribPointer() commands:
+	GLState::bind_buffer(GL_ARRAY_BUFFER, vertex_buffer);
+	Vertex::describe(program);
+
+	//the element array buffer binding is part of vertex array object state:
+	if (index_buffer != 0) {
+		GLState::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+	}
+
+	//(unbind, so later GL_ELEMENT_ARRAY_BUFFER changes can't land in this vertex array by accident)
+	GLState::bind_vertex_array(0);
+	return vertex_array;
+}
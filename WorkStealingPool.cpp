@@ -0,0 +1,107 @@
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(uint32_t count) {
+	if (count == 0) count = std::max(1U, std::thread::hardware_concurrency());
+	for (uint32_t i = 0; i < count; ++i) {
+		queues.emplace_back(new Queue);
+	}
+	for (uint32_t worker = 1; worker < count; ++worker) {
+		threads.emplace_back([this, worker](){
+			uint64_t seen = 0;
+			while (true) {
+				{ //wait for a new job:
+					std::unique_lock< std::mutex > lock(job_mutex);
+					wake.wait(lock, [&](){ return quit || generation != seen; });
+					if (quit) return;
+					seen = generation;
+					workers_busy += 1;
+				}
+				work(worker);
+				{
+					std::unique_lock< std::mutex > lock(job_mutex);
+					workers_busy -= 1;
+				}
+				done.notify_all();
+			}
+		});
+	}
+}
+
+WorkStealingPool::~WorkStealingPool() {
+	{
+		std::unique_lock< std::mutex > lock(job_mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for (auto &thread : threads) {
+		thread.join();
+	}
+}
+
+void WorkStealingPool::parallel_for(uint32_t count, uint32_t grain, Task const &task_) {
+	if (count == 0) return;
+	grain = std::max(1U, grain);
+
+	//deal out chunks round-robin:
+	uint32_t chunks = 0;
+	for (uint32_t begin = 0; begin < count; begin += grain) {
+		Queue &queue = *queues[chunks % queues.size()];
+		std::unique_lock< std::mutex > lock(queue.mutex);
+		queue.chunks.emplace_back(begin, std::min(count, begin + grain));
+		chunks += 1;
+	}
+
+	{ //start the job:
+		std::unique_lock< std::mutex > lock(job_mutex);
+		task = &task_;
+		chunks_left = chunks;
+		generation += 1;
+	}
+	wake.notify_all();
+
+	//this thread is worker zero:
+	work(0);
+
+	//wait for the other workers to finish their last chunks:
+	std::unique_lock< std::mutex > lock(job_mutex);
+	done.wait(lock, [this](){ return chunks_left == 0 && workers_busy == 0; });
+	task = nullptr;
+}
+
+void WorkStealingPool::work(uint32_t worker) {
+	uint32_t const count = thread_count();
+	while (chunks_left != 0) {
+		std::pair< uint32_t, uint32_t > chunk;
+		bool found = false;
+
+		{ //own queue first (from the back):
+			Queue &queue = *queues[worker];
+			std::unique_lock< std::mutex > lock(queue.mutex);
+			if (!queue.chunks.empty()) {
+				chunk = queue.chunks.back();
+				queue.chunks.pop_back();
+				found = true;
+			}
+		}
+
+		//...then steal (from the front of the others):
+		for (uint32_t offset = 1; offset < count && !found; ++offset) {
+			Queue &queue = *queues[(worker + offset) % count];
+			std::unique_lock< std::mutex > lock(queue.mutex);
+			if (!queue.chunks.empty()) {
+				chunk = queue.chunks.front();
+				queue.chunks.pop_front();
+				found = true;
+				steals += 1;
+			}
+		}
+
+		//nothing left to take (the remaining chunks are already running elsewhere):
+		if (!found) break;
+
+		(*task)(chunk.first, chunk.second, worker);
+		chunks_left -= 1;
+	}
+}
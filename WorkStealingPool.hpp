@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * WorkStealingPool runs parallel loops over a fixed set of worker threads.
+ *
+ * parallel_for(count, grain, task) splits [0,count) into chunks of 'grain'
+ *  indices and deals them out round-robin to per-worker queues. Each worker
+ *  takes chunks from the back of its own queue; when that runs dry it steals
+ *  from the front of another worker's queue. So if some chunks take much longer
+ *  than others (e.g., games that last longer), idle workers pick up the slack.
+ *
+ * The calling thread works as worker zero, so a pool of N threads starts N-1
+ *  extra threads. Tasks must not call parallel_for on the same pool.
+ */
+
+struct WorkStealingPool {
+	//threads = 0 means one per hardware thread:
+	WorkStealingPool(uint32_t threads = 0);
+	~WorkStealingPool();
+	WorkStealingPool(WorkStealingPool const &) = delete;
+
+	//call task(begin, end, worker) for chunks covering [0,count); returns when all are done:
+	// ('worker' is in [0,thread_count()), handy for per-thread scratch space or statistics)
+	typedef std::function< void(uint32_t begin, uint32_t end, uint32_t worker) > Task;
+	void parallel_for(uint32_t count, uint32_t grain, Task const &task);
+
+	uint32_t thread_count() const { return uint32_t(queues.size()); }
+
+	//chunks that were run by a worker other than the one they were dealt to:
+	std::atomic< uint64_t > steals{ 0 };
+
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque< std::pair< uint32_t, uint32_t > > chunks;
+	};
+	std::vector< std::unique_ptr< Queue > > queues;
+	std::vector< std::thread > threads;
+
+	//work until no chunks are left anywhere:
+	void work(uint32_t worker);
+
+	//current job (threads wait on 'wake' for 'generation' to change):
+	std::mutex job_mutex;
+	std::condition_variable wake, done;
+	uint64_t generation = 0;
+	Task const *task = nullptr;
+	std::atomic< uint32_t > chunks_left{ 0 };
+	uint32_t workers_busy = 0; //(protected by job_mutex)
+	bool quit = false;
+};
@@ -0,0 +1,235 @@
+//batch_sim runs many headless games of Ball Defender in parallel and reports how long they last.
+// (useful for tuning the difficulty curve without playing hundreds of games by hand)
+
+#include "BallDefender.hpp"
+#include "PaddleController.hpp"
+#include "WorkStealingPool.hpp"
+#include "snapshot_file.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//paddle controllers (see PaddleController.hpp):
+enum PaddleKind {
+	PaddleBot, //aims at the ball that will reach the paddle first (with reaction time + turn rate limits)
+	PaddleSweep, //spins at a constant rate (a scripted baseline)
+	PaddleScript, //plays back a script file
+	PaddleStill, //never moves
+};
+
+struct Settings {
+	uint32_t games = 1000;
+	uint32_t threads = 0; //0 = all hardware threads
+	uint32_t seed = 0;
+	float step_rate = 60.0f; //simulation steps per second of game time
+	float max_time = 600.0f; //games still running after this long are stopped (and counted as survivors)
+	PaddleKind paddle = PaddleBot;
+	std::vector< ScriptPaddle::Key > script; //(for PaddleScript)
+
+	//bot skill:
+	float reaction = 0.15f; //seconds between the bot re-picking a target (randomized +/-50% per decision)
+	float turn_rate = 6.0f; //radians per second the bot can turn the paddle
+	float aim_error = 0.15f; //radians of random aim error per decision
+
+	BallDefender rules; //(difficulty fields are copied into every game)
+	bool from_snapshot = false; //start games from rules' state (loaded with --from) instead of a fresh game
+};
+
+struct GameResult {
+	float survived = 0.0f; //seconds of game time
+	uint32_t steps = 0;
+	uint32_t collisions = 0;
+	bool timed_out = false;
+};
+
+//play one game to the end (or to max_time):
+static GameResult play(Settings const &settings, uint32_t index) {
+	BallDefender game = settings.rules;
+	if (!settings.from_snapshot) game.restart();
+
+	std::unique_ptr< PaddleController > controller;
+	if (settings.paddle == PaddleBot) {
+		//each game seeds its own bot, so results don't depend on which thread runs it:
+		BotPaddle *bot = new BotPaddle(settings.seed * 0x9e3779b9U + index);
+		bot->reaction = settings.reaction;
+		bot->turn_rate = settings.turn_rate;
+		bot->aim_error = settings.aim_error;
+		controller.reset(bot);
+	} else if (settings.paddle == PaddleSweep) {
+		controller.reset(new ScriptPaddle({ {0.0f, 0.0f}, {3.1415927f, 6.2831853f} })); //one turn every pi seconds
+	} else if (settings.paddle == PaddleScript) {
+		controller.reset(new ScriptPaddle(settings.script));
+	}
+
+	const float step = 1.0f / settings.step_rate;
+
+	GameResult result;
+	while (game.health > 0 && result.survived < settings.max_time) {
+		if (controller) game.arc_paddle = controller->paddle(game, step);
+
+		//(BallDefender resets itself on the update after health hits zero, so the loop stops before that)
+		game.update(step);
+		result.steps += 1;
+		result.survived += step;
+	}
+	result.collisions = game.num_collisions;
+	result.timed_out = (game.health > 0);
+	return result;
+}
+
+static void usage(char const *argv0) {
+	std::cerr << "Usage:\n\t" << argv0 << " [options]\n"
+		"Options:\n"
+		"\t--games <n>                number of games to run (default 1000)\n"
+		"\t--threads <n>              worker threads (default: one per hardware thread)\n"
+		"\t--seed <n>                 random seed for the bot (default 0)\n"
+		"\t--paddle bot|sweep|still   paddle controller (default bot)\n"
+		"\t--script <file>            play back a paddle script (e.g., recorded with the game's --record-paddle)\n"
+		"\t--reaction <s>             bot reaction time (default 0.15)\n"
+		"\t--turn-rate <rad/s>        bot paddle turn rate (default 6)\n"
+		"\t--aim-error <rad>          bot aim error (default 0.15)\n"
+		"\t--step-rate <hz>           simulation steps per game second (default 60)\n"
+		"\t--max-time <s>             stop games that last this long (default 600)\n"
+		"\t--health <n>               health per game (default 5)\n"
+		"\t--spawn-interval <n>       wall collisions between new balls (default 12)\n"
+		"\t--base-speed <x>           starting speed multiplier (default 2)\n"
+		"\t--speed-per-collision <x>  speed multiplier increase per wall collision (default 1/12)\n"
+		"\t--max-speed <x>            speed multiplier cap (default 7.5)\n"
+	;
+}
+
+int main(int argc, char **argv) {
+	Settings settings;
+
+	//------------ command line ------------
+	try {
+		for (int argi = 1; argi < argc; ++argi) {
+			std::string arg = argv[argi];
+			if (arg == "--help") {
+				usage(argv[0]);
+				return 0;
+			}
+			if (argi + 1 >= argc) throw std::runtime_error("missing value for '" + arg + "'");
+			std::string val = argv[++argi];
+			if (arg == "--games") settings.games = uint32_t(std::stoul(val));
+			else if (arg == "--threads") settings.threads = uint32_t(std::stoul(val));
+			else if (arg == "--seed") settings.seed = uint32_t(std::stoul(val));
+			else if (arg == "--paddle") {
+				if (val == "bot") settings.paddle = PaddleBot;
+				else if (val == "sweep") settings.paddle = PaddleSweep;
+				else if (val == "still") settings.paddle = PaddleStill;
+				else throw std::runtime_error("unknown paddle '" + val + "'");
+			}
+			else if (arg == "--script") {
+				settings.paddle = PaddleScript;
+				settings.script = ScriptPaddle::load(val);
+			}
+			else if (arg == "--from") {
+				settings.rules.restore(load_snapshot< BallDefender::Snapshot >(val));
+				settings.from_snapshot = true;
+			}
+			else if (arg == "--reaction") settings.reaction = std::stof(val);
+			else if (arg == "--turn-rate") settings.turn_rate = std::stof(val);
+			else if (arg == "--aim-error") settings.aim_error = std::stof(val);
+			else if (arg == "--step-rate") settings.step_rate = std::stof(val);
+			else if (arg == "--max-time") settings.max_time = std::stof(val);
+			else if (arg == "--health") settings.rules.max_health = uint32_t(std::stoul(val));
+			else if (arg == "--spawn-interval") settings.rules.spawn_interval = std::max(1U, uint32_t(std::stoul(val)));
+			else if (arg == "--base-speed") settings.rules.base_speed = std::stof(val);
+			else if (arg == "--speed-per-collision") settings.rules.speed_per_collision = std::stof(val);
+			else if (arg == "--max-speed") settings.rules.max_speed = std::stof(val);
+			else throw std::runtime_error("unknown option '" + arg + "'");
+		}
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << std::endl;
+		usage(argv[0]);
+		return 1;
+	}
+
+	//------------ run ------------
+	WorkStealingPool pool(settings.threads);
+	std::vector< GameResult > results(settings.games);
+	std::vector< uint64_t > worker_steps(pool.thread_count(), 0);
+
+	std::cout << "Running " << settings.games << " games on " << pool.thread_count() << " threads..." << std::endl;
+	auto before = std::chrono::steady_clock::now();
+	//(small chunks, since game lengths vary a lot)
+	pool.parallel_for(settings.games, 4, [&](uint32_t begin, uint32_t end, uint32_t worker) {
+		for (uint32_t i = begin; i < end; ++i) {
+			results[i] = play(settings, i);
+			worker_steps[worker] += results[i].steps;
+		}
+	});
+	double seconds = std::chrono::duration< double >(std::chrono::steady_clock::now() - before).count();
+
+	//------------ report ------------
+	if (results.empty()) return 0;
+
+	std::vector< float > survived;
+	survived.reserve(results.size());
+	uint64_t steps = 0;
+	uint32_t timed_out = 0;
+	double sum = 0.0, sum2 = 0.0;
+	for (auto const &result : results) {
+		survived.emplace_back(result.survived);
+		steps += result.steps;
+		timed_out += (result.timed_out ? 1 : 0);
+		sum += result.survived;
+		sum2 += double(result.survived) * result.survived;
+	}
+	std::sort(survived.begin(), survived.end());
+	double mean = sum / survived.size();
+	double stddev = std::sqrt(std::max(0.0, sum2 / survived.size() - mean * mean));
+	auto percentile = [&survived](float p) {
+		return survived[std::min(survived.size() - 1, size_t(p * survived.size()))];
+	};
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Survival time (seconds of game time):\n";
+	std::cout << "  mean " << mean << ", std dev " << stddev << "\n";
+	std::cout << "  min " << survived.front()
+		<< ", p10 " << percentile(0.10f)
+		<< ", p25 " << percentile(0.25f)
+		<< ", median " << percentile(0.50f)
+		<< ", p75 " << percentile(0.75f)
+		<< ", p90 " << percentile(0.90f)
+		<< ", p99 " << percentile(0.99f)
+		<< ", max " << survived.back() << "\n";
+	if (timed_out) {
+		std::cout << "  (" << timed_out << " games were still going at --max-time " << settings.max_time << ")\n";
+	}
+
+	//histogram, in twenty equal-width buckets:
+	{
+		const uint32_t buckets = 20;
+		float width = std::max(1e-3f, survived.back() / buckets);
+		std::vector< uint32_t > counts(buckets, 0);
+		for (float s : survived) {
+			counts[std::min(buckets - 1, uint32_t(s / width))] += 1;
+		}
+		uint32_t most = *std::max_element(counts.begin(), counts.end());
+		for (uint32_t b = 0; b < buckets; ++b) {
+			std::cout << "  " << std::setw(8) << b * width << "s - " << std::setw(8) << (b + 1) * width << "s "
+				<< std::setw(7) << counts[b] << " " << std::string(size_t(50.0f * counts[b] / most), '#') << "\n";
+		}
+	}
+
+	std::cout << "Simulated " << steps << " steps in " << seconds << " s: "
+		<< std::setprecision(0) << (steps / seconds) << " steps/s ("
+		<< (steps / seconds / settings.step_rate) << "x real time); "
+		<< pool.steals << " chunks stolen\n";
+	std::cout << "  steps per thread:";
+	for (auto s : worker_steps) std::cout << " " << s;
+	std::cout << std::endl;
+
+	return 0;
+}
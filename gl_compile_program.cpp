@@ -27,6 +27,23 @@ static GLuint gl_compile_shader(GLenum type, std::string const &source) {
 	return shader;
 }
 
+static void gl_link_program(GLuint program) {
+	//link the shader program and throw errors if linking fails:
+	glLinkProgram(program);
+	GLint link_status = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &link_status);
+	if (link_status != GL_TRUE) {
+		std::cerr << "Failed to link shader program." << std::endl;
+		GLint info_log_length = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &info_log_length);
+		std::vector< GLchar > info_log(info_log_length, 0);
+		GLsizei length = 0;
+		glGetProgramInfoLog(program, GLint(info_log.size()), &length, &info_log[0]);
+		std::cerr << "Info log: " << std::string(info_log.begin(), info_log.begin() + length);
+		throw std::runtime_error("failed to link program");
+	}
+}
+
 GLuint gl_compile_program(
 	std::string const &vertex_shader_source,
 	std::string const &fragment_shader_source
@@ -43,20 +60,32 @@ GLuint gl_compile_program(
 	glDeleteShader(vertex_shader);
 	glDeleteShader(fragment_shader);
 
-	//link the shader program and throw errors if linking fails:
-	glLinkProgram(program);
-	GLint link_status = GL_FALSE;
-	glGetProgramiv(program, GL_LINK_STATUS, &link_status);
-	if (link_status != GL_TRUE) {
-		std::cerr << "Failed to link shader program." << std::endl;
-		GLint info_log_length = 0;
-		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &info_log_length);
-		std::vector< GLchar > info_log(info_log_length, 0);
-		GLsizei length = 0;
-		glGetProgramInfoLog(program, GLint(info_log.size()), &length, &info_log[0]);
-		std::cerr << "Info log: " << std::string(info_log.begin(), info_log.begin() + length);
-		throw std::runtime_error("failed to link program");
+	gl_link_program(program);
+
+	return program;
+}
+
+GLuint gl_compile_transform_feedback_program(
+	std::string const &vertex_shader_source,
+	std::vector< std::string > const &varyings
+	) {
+
+	GLuint vertex_shader = gl_compile_shader(GL_VERTEX_SHADER, vertex_shader_source);
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, vertex_shader);
+
+	//shaders are reference counted so this makes sure they are freed after program is deleted:
+	glDeleteShader(vertex_shader);
+
+	//captured outputs must be named before linking:
+	std::vector< GLchar const * > names;
+	for (auto const &v : varyings) {
+		names.emplace_back(v.c_str());
 	}
+	glTransformFeedbackVaryings(program, GLsizei(names.size()), names.data(), GL_INTERLEAVED_ATTRIBS);
+
+	gl_link_program(program);
 
 	return program;
 }
@@ -3,9 +3,17 @@
 #include "GL.hpp"
 
 #include <string>
+#include <vector>
 
 //compiles+links an OpenGL shader program from source.
 // throws on compilation error.
 GLuint gl_compile_program(
 	std::string const &vertex_shader_source,
 	std::string const &fragment_shader_source);
+
+//compiles+links a vertex-only OpenGL shader program whose 'varyings' outputs are
+// captured (interleaved, in the order given) by transform feedback.
+// throws on compilation error.
+GLuint gl_compile_transform_feedback_program(
+	std::string const &vertex_shader_source,
+	std::vector< std::string > const &varyings);
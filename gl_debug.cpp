@@ -0,0 +1,148 @@
+#include "gl_debug.hpp"
+
+#include "GL.hpp"
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+bool gl_debug_output_active = false;
+
+//GL.hpp stops at 3.3, so the debug output parts of the 4.3 / KHR_debug API are declared here:
+#ifndef GL_DEBUG_OUTPUT
+#define GL_DEBUG_OUTPUT                   0x92E0
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS       0x8242
+#define GL_CONTEXT_FLAG_DEBUG_BIT         0x00000002
+#define GL_DEBUG_SOURCE_API               0x8246
+#define GL_DEBUG_SOURCE_WINDOW_SYSTEM     0x8247
+#define GL_DEBUG_SOURCE_SHADER_COMPILER   0x8248
+#define GL_DEBUG_SOURCE_THIRD_PARTY       0x8249
+#define GL_DEBUG_SOURCE_APPLICATION       0x824A
+#define GL_DEBUG_SOURCE_OTHER             0x824B
+#define GL_DEBUG_TYPE_ERROR               0x824C
+#define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR 0x824D
+#define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR  0x824E
+#define GL_DEBUG_TYPE_PORTABILITY         0x824F
+#define GL_DEBUG_TYPE_PERFORMANCE         0x8250
+#define GL_DEBUG_TYPE_OTHER               0x8251
+#define GL_DEBUG_TYPE_MARKER              0x8268
+#define GL_DEBUG_TYPE_PUSH_GROUP          0x8269
+#define GL_DEBUG_TYPE_POP_GROUP           0x826A
+#define GL_DEBUG_SEVERITY_HIGH            0x9146
+#define GL_DEBUG_SEVERITY_MEDIUM          0x9147
+#define GL_DEBUG_SEVERITY_LOW             0x9148
+#define GL_DEBUG_SEVERITY_NOTIFICATION    0x826B
+#endif
+
+//(ARB_debug_output uses the same values and callback, with _ARB / ARB names)
+typedef void (APIENTRY *DebugCallback)(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, GLchar const *message, void const *user);
+typedef void (APIENTRY *DebugMessageCallbackFn)(DebugCallback callback, void const *user);
+typedef void (APIENTRY *DebugMessageControlFn)(GLenum source, GLenum type, GLenum severity, GLsizei count, GLuint const *ids, GLboolean enabled);
+
+//print this many copies of any one message before going quiet about it:
+static const uint32_t MaxRepeats = 5;
+
+static char const *source_name(GLenum source) {
+	switch (source) {
+		case GL_DEBUG_SOURCE_API: return "api";
+		case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+		case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+		case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+		case GL_DEBUG_SOURCE_APPLICATION: return "application";
+		default: return "other";
+	}
+}
+
+static char const *type_name(GLenum type) {
+	switch (type) {
+		case GL_DEBUG_TYPE_ERROR: return "error";
+		case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated behavior";
+		case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+		case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+		case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+		case GL_DEBUG_TYPE_MARKER: return "marker";
+		case GL_DEBUG_TYPE_PUSH_GROUP: return "push group";
+		case GL_DEBUG_TYPE_POP_GROUP: return "pop group";
+		default: return "other";
+	}
+}
+
+static char const *severity_name(GLenum severity) {
+	switch (severity) {
+		case GL_DEBUG_SEVERITY_HIGH: return "high";
+		case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+		case GL_DEBUG_SEVERITY_LOW: return "low";
+		default: return "notification";
+	}
+}
+
+static void APIENTRY debug_callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, GLchar const *message, void const *) {
+	if (severity == GL_DEBUG_SEVERITY_NOTIFICATION) return;
+	if (type == GL_DEBUG_TYPE_PUSH_GROUP || type == GL_DEBUG_TYPE_POP_GROUP) return;
+
+	//(without GL_DEBUG_OUTPUT_SYNCHRONOUS the driver may call from its own threads)
+	static std::mutex mutex;
+	static std::map< std::tuple< GLenum, GLenum, GLuint >, uint32_t > repeats;
+	std::lock_guard< std::mutex > lock(mutex);
+
+	uint32_t &count = repeats[std::make_tuple(source, type, id)];
+	count += 1;
+	if (count > MaxRepeats) return;
+
+	std::string text = (length >= 0 ? std::string(message, length) : std::string(message));
+	while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) text.pop_back();
+
+	std::cerr << "WARNING: gl " << type_name(type) << " (" << source_name(source) << ", " << severity_name(severity) << " severity, id " << id << "): " << text;
+	if (count == MaxRepeats) std::cerr << " [repeated " << MaxRepeats << " times; ignoring it from now on]";
+	std::cerr << std::endl;
+}
+
+bool gl_debug_init() {
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+	DebugMessageCallbackFn debug_message_callback = nullptr;
+	DebugMessageControlFn debug_message_control = nullptr;
+	bool khr = false;
+	if (major > 4 || (major == 4 && minor >= 3) || SDL_GL_ExtensionSupported("GL_KHR_debug")) {
+		debug_message_callback = (DebugMessageCallbackFn)SDL_GL_GetProcAddress("glDebugMessageCallback");
+		debug_message_control = (DebugMessageControlFn)SDL_GL_GetProcAddress("glDebugMessageControl");
+		khr = true;
+	} else if (SDL_GL_ExtensionSupported("GL_ARB_debug_output")) {
+		debug_message_callback = (DebugMessageCallbackFn)SDL_GL_GetProcAddress("glDebugMessageCallbackARB");
+		debug_message_control = (DebugMessageControlFn)SDL_GL_GetProcAddress("glDebugMessageControlARB");
+	}
+	if (!debug_message_callback || !debug_message_control) {
+		std::cerr << "NOTE: OpenGL debug output isn't available; GL_ERRORS() will poll glGetError() instead." << std::endl;
+		return false;
+	}
+
+	#ifndef NDEBUG
+	//(release builds don't ask for a debug context, so only mention this in debug builds)
+	GLint flags = 0;
+	glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+	if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) {
+		std::cerr << "NOTE: not a debug context; the driver may report few OpenGL debug messages." << std::endl;
+	}
+	#endif
+
+	debug_message_callback(debug_callback, nullptr);
+	if (khr) {
+		//(notifications -- e.g., "buffer will use video memory" -- are just noise)
+		debug_message_control(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+		glEnable(GL_DEBUG_OUTPUT);
+	}
+	#ifndef NDEBUG
+	//report messages from within the offending call, so a breakpoint in debug_callback shows who made it:
+	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	#endif
+
+	gl_debug_output_active = true;
+	return true;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+//Hooks up OpenGL's debug output (KHR_debug, or ARB_debug_output on older drivers),
+// so the driver reports errors, performance warnings, and the like -- with its own
+// description of what went wrong -- the moment they happen, instead of code having
+// to poll glGetError().
+//
+//Call after creating the context (and after init_GL()). Returns false if the
+// driver has neither extension (e.g., MacOS), in which case GL_ERRORS() keeps
+// polling glGetError().
+//
+//Messages are printed to std::cerr as "WARNING: gl ..." lines; notifications are
+// ignored, and each distinct message is printed at most a few times.
+bool gl_debug_init();
+
+//true once gl_debug_init() has installed its callback:
+extern bool gl_debug_output_active;
@@ -1,12 +1,19 @@
 #pragma once
 
 #include "GL.hpp"
+#include "gl_debug.hpp"
 #include <iostream>
 
 #define STR2(X) # X
 #define STR(X) STR2(X)
 
+//GL_ERRORS() prints any errors OpenGL has flagged since the last check.
+// Each glGetError() call makes the driver catch up with the commands queued so far,
+// so once gl_debug_init() has the driver reporting errors itself this doesn't poll,
+// and in release builds (NDEBUG) the macro compiles to nothing.
+
 inline void gl_errors(std::string const &where) {
+	if (gl_debug_output_active) return;
 	GLenum err = 0;
 	while ((err = glGetError()) != GL_NO_ERROR) {
 		#define CHECK( ERR ) \
@@ -27,5 +34,9 @@ inline void gl_errors(std::string const &where) {
 		#undef CHECK
 	}
 }
+#ifdef NDEBUG
+#define GL_ERRORS()
+#else
 #define GL_ERRORS() gl_errors(__FILE__  ":" STR(__LINE__) )
+#endif
 
@@ -4,21 +4,51 @@
 //The 'NewMode' mode plays the game:
 #include "NewMode.hpp"
 
+//The 'StressMode' mode fills the court with balls for profiling:
+#include "StressMode.hpp"
+
+//The 'MultiCourtMode' mode runs many AI-vs-AI Pong courts at once:
+#include "MultiCourtMode.hpp"
+
+//The 'NetPongMode' mode plays two-player Pong over UDP:
+#include "NetPongMode.hpp"
+
+//Input.hpp batches up each frame's events:
+#include "Input.hpp"
+
 //GL.hpp will include a non-namespace-polluting set of opengl prototypes:
 #include "GL.hpp"
 
+//frame pacing when not using vsync:
+#include "FramePacer.hpp"
+
+//shared GL objects (freed before the context is destroyed):
+#include "GLResourcePool.hpp"
+
 //for screenshots:
 #include "load_save_png.hpp"
 
+//for gl_debug_init():
+#include "gl_debug.hpp"
+
+//for --gl-stats and --gl-validate:
+#include "GLState.hpp"
+#include "BatchRenderer.hpp"
+
+//for PROFILE_ZONE() and --profile:
+#include "Profiler.hpp"
+
 //Includes for libSDL:
 #include <SDL.h>
 
 //...and for c++ standard library functions:
 #include <chrono>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <memory>
 #include <algorithm>
+#include <string>
 
 int main(int argc, char **argv) {
 #ifdef _WIN32
@@ -26,12 +56,122 @@ int main(int argc, char **argv) {
 	try {
 #endif
 
+	//------------ command line ------------
+
+	uint32_t stress_balls = 0; //if non-zero, run StressMode with this many balls instead of the game
+	bool gpu_balls = false; //step StressMode's balls on the GPU via transform feedback
+	uint32_t courts = 0; //if non-zero, run MultiCourtMode with this many Pong courts instead of the game
+	std::string net_host; //if non-empty, host a NetPongMode game on this port
+	std::string net_join; //if non-empty, join the NetPongMode game at this address
+	double target_fps = 0.0; //if non-zero, pace frames with a FramePacer at this rate instead of vsync
+	bool pace_spin = true; //let the FramePacer spin for the last fraction of a millisecond (more precise, more CPU)
+	bool pace_stats = false; //print frame pacing statistics every few seconds
+	bool gl_stats = false; //print GL state calls (made and skipped as redundant) per frame every few seconds
+	std::string latency_log; //if non-empty, write per-frame input-to-swap timestamps to this file
+	std::string broadcast; //if non-empty, stream the game to spectators at this socket address
+	std::string spectate; //if non-empty, watch the game streamed at this socket address instead of playing
+	std::string profile; //if non-empty, record profiler zones and write them to this file (Chrome trace JSON) on exit
+
+	for (int argi = 1; argi < argc; ++argi) {
+		std::string arg = argv[argi];
+		if (arg == "--stress" && argi + 1 < argc) {
+			stress_balls = uint32_t(std::stoul(argv[argi+1]));
+			argi += 1;
+		} else if (arg == "--gpu-balls") {
+			gpu_balls = true;
+		} else if (arg == "--courts" && argi + 1 < argc) {
+			courts = uint32_t(std::stoul(argv[argi+1]));
+			argi += 1;
+		} else if (arg == "--host" && argi + 1 < argc) {
+			net_host = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--join" && argi + 1 < argc) {
+			net_join = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--net-latency" && argi + 1 < argc) {
+			NetPongMode::link_conditions.latency = std::stof(argv[argi+1]) / 1000.0f;
+			argi += 1;
+		} else if (arg == "--net-jitter" && argi + 1 < argc) {
+			NetPongMode::link_conditions.jitter = std::stof(argv[argi+1]) / 1000.0f;
+			argi += 1;
+		} else if (arg == "--net-loss" && argi + 1 < argc) {
+			NetPongMode::link_conditions.loss = std::stof(argv[argi+1]);
+			argi += 1;
+		} else if (arg == "--fps" && argi + 1 < argc) {
+			target_fps = std::stod(argv[argi+1]);
+			argi += 1;
+		} else if (arg == "--no-spin") {
+			pace_spin = false;
+		} else if (arg == "--pace-stats") {
+			pace_stats = true;
+		} else if (arg == "--gl-stats") {
+			gl_stats = true;
+		} else if (arg == "--gl-validate") {
+			GLState::validate = true;
+		} else if (arg == "--sim-thread" && argi + 1 < argc) {
+			NewMode::sim_thread_rate = std::stof(argv[argi+1]);
+			argi += 1;
+		} else if (arg == "--bot") {
+			//a strong bot, so the game keeps going (and keeps its balls) for long unattended runs:
+			NewMode::make_controller = [](){
+				std::shared_ptr< BotPaddle > bot = std::make_shared< BotPaddle >();
+				bot->reaction = 0.02f;
+				bot->turn_rate = 30.0f;
+				bot->aim_error = 0.0f;
+				return bot;
+			};
+		} else if (arg == "--script-paddle" && argi + 1 < argc) {
+			std::vector< ScriptPaddle::Key > keys = ScriptPaddle::load(argv[argi+1]);
+			NewMode::make_controller = [keys](){
+				return std::make_shared< ScriptPaddle >(keys);
+			};
+			argi += 1;
+		} else if (arg == "--record-paddle" && argi + 1 < argc) {
+			NewMode::record_paddle = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--snapshot" && argi + 1 < argc) {
+			NewMode::snapshot_file = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--broadcast" && argi + 1 < argc) {
+			broadcast = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--spectate" && argi + 1 < argc) {
+			spectate = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--profile" && argi + 1 < argc) {
+			profile = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--no-motion-blur") {
+			NewMode::motion_blur = false;
+		} else if (arg == "--late-latch") {
+			Input::late_latch = true;
+		} else if (arg == "--latency-log" && argi + 1 < argc) {
+			latency_log = argv[argi+1];
+			argi += 1;
+		} else {
+			std::cerr << "Usage:\n\t" << argv[0] << " [--stress <balls> [--gpu-balls] | --courts <count> | --host <port> | --join <address:port>] [--net-latency <ms>] [--net-jitter <ms>] [--net-loss <fraction>] [--fps <hz> [--no-spin]] [--pace-stats] [--gl-stats] [--gl-validate] [--sim-thread <steps/s>] [--bot | --script-paddle <file>] [--record-paddle <file>] [--snapshot <file>] [--broadcast <address> | --spectate <address>] [--profile <file.json>] [--late-latch] [--no-motion-blur] [--latency-log <file.csv>]" << std::endl;
+			return 1;
+		}
+	}
+
+	//spectator sockets (set up before the window, so a bad address fails fast):
+	try {
+		if (!broadcast.empty()) {
+			NewMode::spectator_server = std::make_shared< SpectatorServer >(broadcast);
+			std::cout << "Broadcasting the game to spectators at '" << broadcast << "'." << std::endl;
+		}
+		if (!spectate.empty()) NewMode::spectator_source = std::make_shared< SpectatorViewer >(spectate);
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
 	//------------  initialization ------------
 
 	//Initialize SDL library:
 	SDL_Init(SDL_INIT_VIDEO);
 
-	//Ask for an OpenGL context version 3.3, core profile, enable debug:
+	//Ask for an OpenGL context version 3.3, core profile, enable debug (except in release builds):
 	SDL_GL_ResetAttributes();
 	SDL_GL_SetAttribute(SDL_GL_RED_SIZE, 8);
 	SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, 8);
@@ -41,7 +181,9 @@ int main(int argc, char **argv) {
 	SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
 	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+	#ifndef NDEBUG
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
+	#endif
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
 
@@ -75,22 +217,62 @@ int main(int argc, char **argv) {
 	//On windows, load OpenGL entrypoints: (does nothing on other platforms)
 	init_GL();
 
-	//Set VSYNC + Late Swap (prevents crazy FPS):
-	if (SDL_GL_SetSwapInterval(-1) != 0) {
-		std::cerr << "NOTE: couldn't set vsync + late swap tearing (" << SDL_GetError() << ")." << std::endl;
-		if (SDL_GL_SetSwapInterval(1) != 0) {
-			std::cerr << "NOTE: couldn't set vsync (" << SDL_GetError() << ")." << std::endl;
+	//Have the driver report errors and performance warnings as they happen:
+	gl_debug_init();
+
+	if (target_fps > 0.0) {
+		//frames will be paced by a FramePacer, so don't also wait for vsync:
+		SDL_GL_SetSwapInterval(0);
+	} else {
+		//Set VSYNC + Late Swap (prevents crazy FPS):
+		if (SDL_GL_SetSwapInterval(-1) != 0) {
+			std::cerr << "NOTE: couldn't set vsync + late swap tearing (" << SDL_GetError() << ")." << std::endl;
+			if (SDL_GL_SetSwapInterval(1) != 0) {
+				std::cerr << "NOTE: couldn't set vsync (" << SDL_GetError() << "); pacing frames at 60 Hz instead." << std::endl;
+				//(otherwise the main loop would spin at 100% CPU)
+				target_fps = 60.0;
+			}
 		}
 	}
+	std::unique_ptr< FramePacer > pacer;
+	if (target_fps > 0.0) {
+		pacer.reset(new FramePacer(target_fps, pace_spin));
+	}
 
 	//Hide mouse cursor (note: showing can be useful for debugging):
 	//SDL_ShowCursor(SDL_DISABLE);
 
 	//------------ create game mode + make current --------------
-	Mode::set_current(std::make_shared< NewMode >());
+	if (stress_balls > 0) {
+		Mode::set_current(std::make_shared< StressMode >(stress_balls, gpu_balls));
+	} else if (courts > 0) {
+		Mode::set_current(std::make_shared< MultiCourtMode >(courts));
+	} else if (!net_host.empty()) {
+		Mode::set_current(std::make_shared< NetPongMode >(NetPongMode::Host, UdpSocket::Address::parse(net_host)));
+	} else if (!net_join.empty()) {
+		Mode::set_current(std::make_shared< NetPongMode >(NetPongMode::Client, UdpSocket::Address::parse(net_join)));
+	} else {
+		Mode::set_current(std::make_shared< NewMode >());
+	}
 
 	//------------ main loop ------------
 
+	//per-frame latency log (times in milliseconds):
+	// event_to_swap -- from the OS timestamp of this frame's newest mouse motion to SwapWindow returning
+	// sample_to_swap -- from when the mouse position used for drawing was read to SwapWindow returning
+	//(with vsync, SwapWindow returns about when the frame is handed to the display, so these approximate input-to-photon latency)
+	std::ofstream latency_out;
+	if (!latency_log.empty()) {
+		latency_out.open(latency_log);
+		if (!latency_out) {
+			std::cerr << "Failed to open '" << latency_log << "' for writing." << std::endl;
+			return 1;
+		}
+		latency_out << "frame,event_to_swap,sample_to_swap,late_latched\n";
+	}
+	uint64_t frame = 0;
+	Input input;
+
 	//this inline function will be called whenever the window is resized,
 	// and will update the window_size and drawable_size variables:
 	glm::uvec2 window_size; //size of window (layout pixels)
@@ -103,23 +285,42 @@ int main(int argc, char **argv) {
 		SDL_GL_GetDrawableSize(window, &w, &h);
 		drawable_size = glm::uvec2(w, h);
 		glViewport(0, 0, drawable_size.x, drawable_size.y);
+		//let the current mode (and any overlays) know:
+		Mode::set_window_size(window_size, drawable_size);
 	};
 	on_resize();
 
+	if (!profile.empty()) {
+		Profiler::name_thread("main");
+		Profiler::start();
+	}
+
 	//This will loop until the current mode is set to null:
 	while (Mode::current) {
+		PROFILE_ZONE("frame");
+
 		//every pass through the game loop creates one frame of output
 		//  by performing three steps:
 
 		{ //(1) process any events that are pending
-			static SDL_Event evt;
-			while (SDL_PollEvent(&evt) == 1) {
+			PROFILE_ZONE("events");
+			//collect this frame's events (runs of mouse motion get merged into one event):
+			input.poll();
+			for (SDL_Event const &evt : input.events) {
 				//handle resizing:
 				if (evt.type == SDL_WINDOWEVENT && evt.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
 					on_resize();
 				}
-				//handle input:
-				if (Mode::current && Mode::current->handle_event(evt, window_size)) {
+				//handle input (overlays get first pick, topmost first):
+				bool handled = false;
+				std::vector< std::shared_ptr< Mode > > overlays = Mode::overlays; //(copy, since handlers may push/pop)
+				for (auto o = overlays.rbegin(); o != overlays.rend() && !handled; ++o) {
+					handled = (*o)->handle_event(evt, window_size);
+				}
+				if (!handled && Mode::current) {
+					handled = Mode::current->handle_event(evt, window_size);
+				}
+				if (handled) {
 					// mode handled it; great
 				} else if (evt.type == SDL_QUIT) {
 					Mode::set_current(nullptr);
@@ -141,9 +342,24 @@ int main(int argc, char **argv) {
 				}
 			}
 			if (!Mode::current) break;
+
+			//hand the resulting input state to the modes (topmost first, stopping below a pausing overlay):
+			bool paused = false;
+			std::vector< std::shared_ptr< Mode > > overlays = Mode::overlays;
+			for (auto o = overlays.rbegin(); o != overlays.rend() && !paused; ++o) {
+				(*o)->handle_input(input, window_size);
+				paused = (*o)->pauses_below();
+			}
+			if (!paused) {
+				Mode::current->handle_input(input, window_size);
+			}
 		}
 
+		//advance any asynchronous mode switch (may swap in a new Mode::current):
+		Mode::advance_loading();
+
 		{ //(2) call the current mode's "update" function to deal with elapsed time:
+			PROFILE_ZONE("update");
 			auto current_time = std::chrono::high_resolution_clock::now();
 			static auto previous_time = current_time;
 			float elapsed = std::chrono::duration< float >(current_time - previous_time).count();
@@ -153,22 +369,84 @@ int main(int argc, char **argv) {
 			//lag to avoid spiral of death:
 			elapsed = std::min(0.1f, elapsed);
 
-			Mode::current->update(elapsed);
+			//update overlays topmost first; an overlay that pauses_below() stops the rest from updating:
+			bool paused = false;
+			std::vector< std::shared_ptr< Mode > > overlays = Mode::overlays; //(copy, since updates may push/pop)
+			for (auto o = overlays.rbegin(); o != overlays.rend() && !paused; ++o) {
+				(*o)->update(elapsed);
+				paused = (*o)->pauses_below();
+			}
+			if (!paused) {
+				Mode::current->update(elapsed);
+			}
 			if (!Mode::current) break;
 		}
 
 		{ //(3) call the current mode's "draw" function to produce output:
-		
+			PROFILE_ZONE("draw");
+			Input::latched_at = 0;
+
 			Mode::current->draw(drawable_size);
+
+			//overlays draw on top, bottom-most first:
+			std::vector< std::shared_ptr< Mode > > overlays = Mode::overlays;
+			for (auto const &overlay : overlays) {
+				overlay->draw(drawable_size);
+			}
+
+			GLState::end_frame();
+			if (gl_stats && GLState::frames >= 300) {
+				std::cout << GLState::stats() << "; " << BatchRenderer::stats(GLState::frames) << std::endl;
+				GLState::reset_stats();
+				BatchRenderer::reset_stats();
+			}
 		}
 
 		//Wait until the recently-drawn frame is shown before doing it all again:
-		SDL_GL_SwapWindow(window);
+		{
+			PROFILE_ZONE("swap");
+			SDL_GL_SwapWindow(window);
+		}
+
+		if (latency_out) {
+			uint64_t swapped_at = SDL_GetPerformanceCounter();
+			uint32_t swapped_ticks = SDL_GetTicks();
+			bool late_latched = (Input::latched_at != 0);
+			uint64_t sampled_at = (late_latched ? Input::latched_at : input.polled_at);
+			latency_out << frame << ',';
+			if (input.mouse_moved) latency_out << (swapped_ticks - input.newest_motion_ticks); //(blank if the mouse didn't move)
+			latency_out << ','
+			            << (swapped_at - sampled_at) * 1000.0 / SDL_GetPerformanceFrequency() << ','
+			            << (late_latched ? 1 : 0) << '\n';
+		}
+		frame += 1;
+
+		//if not using vsync, wait until it's time for the next frame:
+		if (pacer) {
+			PROFILE_ZONE("pace");
+			pacer->wait();
+			if (pace_stats && pacer->frames >= uint32_t(5.0 * pacer->target_hz)) {
+				std::cout << pacer->stats() << std::endl;
+				pacer->reset_stats();
+			}
+		}
 	}
 
 
 	//------------  teardown ------------
 
+	//(modes, and any threads they ran, are gone by now)
+	if (!profile.empty()) {
+		try {
+			Profiler::write(profile);
+		} catch (std::exception const &e) {
+			std::cerr << e.what() << std::endl;
+		}
+	}
+
+	//free pooled GL objects while the context still exists:
+	GLResourcePool::clear();
+
 	SDL_GL_DeleteContext(context);
 	context = 0;
 
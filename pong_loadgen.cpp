@@ -0,0 +1,157 @@
+//pong_loadgen pretends to be many NetPongMode clients at once, to load-test pong_server.
+// Each fake client has its own socket, sends an input packet every tick (a paddle sweeping up and
+// down), and decodes the state packets that come back, tracking how many arrive, how big they are,
+// and how far behind the server's acknowledged input is.
+
+#include "PongProtocol.hpp"
+#include "UdpSocket.hpp"
+#include "FramePacer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct Settings {
+	UdpSocket::Address server = UdpSocket::Address::parse("15466");
+	uint32_t clients = 100;
+	float seconds = 30.0f; //how long to run
+	float tick_rate = 60.0f;
+	UdpSocket::LinkConditions conditions;
+};
+
+struct FakeClient {
+	std::unique_ptr< UdpSocket > socket;
+	float phase = 0.0f; //(so paddles don't all move together)
+	uint32_t seq = 0; //newest input sent
+	float ys[MaxRepeatedInputs] = { }; //newest inputs, oldest first
+	uint32_t newest_state = 0;
+	uint32_t ack_seq = 0; //newest input the server says it has used
+	PongNetHistory history;
+};
+
+static void usage(char const *argv0) {
+	std::cerr << "Usage:\n\t" << argv0 << " [options]\n"
+		"Options:\n"
+		"\t--server <address:port>  server to load (default 127.0.0.1:15466)\n"
+		"\t--clients <n>            fake clients (default 100)\n"
+		"\t--seconds <s>            how long to run (default 30)\n"
+		"\t--tick-rate <hz>         inputs per second per client (default 60)\n"
+		"\t--latency <ms>           simulated one-way latency on sent inputs\n"
+		"\t--jitter <ms>            simulated jitter on sent inputs\n"
+		"\t--loss <fraction>        simulated loss of sent inputs\n"
+	;
+}
+
+int main(int argc, char **argv) {
+	Settings settings;
+
+	//------------ command line ------------
+	try {
+		for (int argi = 1; argi < argc; ++argi) {
+			std::string arg = argv[argi];
+			if (arg == "--help") {
+				usage(argv[0]);
+				return 0;
+			}
+			if (argi + 1 >= argc) throw std::runtime_error("missing value for '" + arg + "'");
+			std::string val = argv[++argi];
+			if (arg == "--server") settings.server = UdpSocket::Address::parse(val);
+			else if (arg == "--clients") settings.clients = uint32_t(std::stoul(val));
+			else if (arg == "--seconds") settings.seconds = std::stof(val);
+			else if (arg == "--tick-rate") settings.tick_rate = std::stof(val);
+			else if (arg == "--latency") settings.conditions.latency = std::stof(val) / 1000.0f;
+			else if (arg == "--jitter") settings.conditions.jitter = std::stof(val) / 1000.0f;
+			else if (arg == "--loss") settings.conditions.loss = std::stof(val);
+			else throw std::runtime_error("unknown option '" + arg + "'");
+		}
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << std::endl;
+		usage(argv[0]);
+		return 1;
+	}
+
+	//------------ set up ------------
+	std::vector< FakeClient > clients(settings.clients);
+	for (uint32_t c = 0; c < clients.size(); ++c) {
+		clients[c].socket.reset(new UdpSocket());
+		clients[c].socket->conditions = settings.conditions;
+		clients[c].socket->link_rng.seed(c);
+		clients[c].phase = 0.61803f * c;
+	}
+
+	std::cout << "pong_loadgen: " << clients.size() << " clients -> " << settings.server.to_string()
+		<< " for " << settings.seconds << " s." << std::endl;
+
+	//------------ run ------------
+	FramePacer pacer(settings.tick_rate, false);
+	uint32_t ticks = uint32_t(settings.seconds * settings.tick_rate);
+
+	uint64_t states = 0, state_bytes = 0, undecodable = 0;
+	uint64_t lag_sum = 0; //(input ticks between newest sent and newest acknowledged, summed over states received)
+	uint32_t lag_max = 0;
+
+	for (uint32_t tick = 1; tick <= ticks; ++tick) {
+		for (auto &client : clients) {
+			client.socket->poll();
+
+			//receive states:
+			uint8_t data[MaxPacket];
+			UdpSocket::Address from;
+			while (size_t size = client.socket->receive(data, sizeof(data), &from)) {
+				PacketReader packet(data, size);
+				PongNetState state;
+				uint32_t ack_seq;
+				if (!read_state_packet(packet, client.history, &state, &ack_seq)) {
+					undecodable += 1;
+					continue;
+				}
+				states += 1;
+				state_bytes += size;
+				if (state.tick <= client.newest_state) continue;
+				client.history.store(state);
+				client.newest_state = state.tick;
+				client.ack_seq = std::max(client.ack_seq, ack_seq);
+				lag_sum += client.seq - client.ack_seq;
+				lag_max = std::max(lag_max, client.seq - client.ack_seq);
+			}
+
+			//send input:
+			client.seq += 1;
+			std::copy(client.ys + 1, client.ys + MaxRepeatedInputs, client.ys);
+			client.ys[MaxRepeatedInputs - 1] = 4.0f * std::sin(client.seq / settings.tick_rate * 2.0f + client.phase);
+
+			PongInputPacket input;
+			input.ack_tick = client.newest_state;
+			input.newest_seq = client.seq;
+			input.count = uint8_t(std::min(client.seq, MaxRepeatedInputs));
+			std::copy(client.ys + MaxRepeatedInputs - input.count, client.ys + MaxRepeatedInputs, input.ys);
+			PacketWriter packet;
+			write_input_packet(packet, input);
+			client.socket->send(settings.server, packet.data, packet.size);
+		}
+		pacer.wait();
+	}
+
+	//------------ report ------------
+	uint64_t bytes_sent = 0;
+	for (auto const &client : clients) bytes_sent += client.socket->bytes_sent;
+	double seconds = ticks / settings.tick_rate;
+	double expected = double(ticks) * clients.size();
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Received " << states << " states (" << (states / expected * 100.0) << "% of ticks), "
+		<< (states ? double(state_bytes) / states : 0.0) << " bytes each on average; "
+		<< undecodable << " could not be decoded (baseline missing).\n";
+	std::cout << "Per client: " << (state_bytes / seconds / clients.size()) << " B/s down, "
+		<< (bytes_sent / seconds / clients.size()) << " B/s up.\n";
+	std::cout << "Input acknowledged " << (states ? double(lag_sum) / states : 0.0) << " ticks after sending on average ("
+		<< ((states ? double(lag_sum) / states : 0.0) / settings.tick_rate * 1e3) << " ms), at most " << lag_max << " ticks.\n";
+	std::cout << "Pacing: " << pacer.stats() << std::endl;
+
+	return 0;
+}
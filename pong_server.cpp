@@ -0,0 +1,351 @@
+//pong_server hosts many games of networked Pong at once, without a window.
+// Every client (a NetPongMode started with --join, or pong_loadgen) gets its own court, playing
+// the right paddle against the server's AI. All courts are stepped together, in parallel, at a
+// fixed tick rate; state packets go out after every tick (see PongProtocol.hpp).
+//
+// The server waits on its socket and a tick timer together with epoll, so it is Linux-only.
+
+#include "PongCourts.hpp"
+#include "PongProtocol.hpp"
+#include "UdpSocket.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Settings {
+	uint16_t port = 15466;
+	uint32_t threads = 0; //0 = all hardware threads
+	uint32_t max_matches = 4096;
+	float tick_rate = 60.0f; //ticks per second (should match NetPongMode::Tick for prediction to line up)
+	float timeout = 5.0f; //seconds without input before a client's court is freed
+	float report_interval = 5.0f;
+};
+
+//per-court connection state (the game itself lives in PongCourts):
+struct Match {
+	bool active = false;
+	UdpSocket::Address client;
+	double last_heard = 0.0;
+
+	struct PaddleInput {
+		uint32_t seq;
+		float y;
+	};
+	std::deque< PaddleInput > input_queue; //inputs not yet used
+	uint32_t client_seq = 0; //newest input received
+	uint32_t applied_seq = 0; //newest input used
+	uint32_t acked_tick = 0; //newest state the client says it has
+	PongNetHistory history; //states sent
+};
+
+static double now_seconds() {
+	return std::chrono::duration< double >(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t address_key(UdpSocket::Address const &address) {
+	return (uint64_t(address.ip) << 16) | address.port;
+}
+
+static void usage(char const *argv0) {
+	std::cerr << "Usage:\n\t" << argv0 << " [options]\n"
+		"Options:\n"
+		"\t--port <n>            UDP port to listen on (default 15466)\n"
+		"\t--threads <n>         simulation threads (default: one per hardware thread)\n"
+		"\t--max-matches <n>     most clients served at once (default 4096)\n"
+		"\t--tick-rate <hz>      simulation ticks per second (default 60)\n"
+		"\t--timeout <s>         drop clients silent this long (default 5)\n"
+		"\t--report <s>          seconds between metrics reports (default 5)\n"
+	;
+}
+
+int main(int argc, char **argv) {
+	Settings settings;
+
+	//------------ command line ------------
+	try {
+		for (int argi = 1; argi < argc; ++argi) {
+			std::string arg = argv[argi];
+			if (arg == "--help") {
+				usage(argv[0]);
+				return 0;
+			}
+			if (argi + 1 >= argc) throw std::runtime_error("missing value for '" + arg + "'");
+			std::string val = argv[++argi];
+			if (arg == "--port") settings.port = UdpSocket::Address::parse(val).port;
+			else if (arg == "--threads") settings.threads = uint32_t(std::stoul(val));
+			else if (arg == "--max-matches") settings.max_matches = uint32_t(std::stoul(val));
+			else if (arg == "--tick-rate") settings.tick_rate = std::stof(val);
+			else if (arg == "--timeout") settings.timeout = std::stof(val);
+			else if (arg == "--report") settings.report_interval = std::stof(val);
+			else throw std::runtime_error("unknown option '" + arg + "'");
+		}
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << std::endl;
+		usage(argv[0]);
+		return 1;
+	}
+
+	//------------ set up ------------
+	std::unique_ptr< UdpSocket > socket;
+	int socket_fd = -1, timer_fd = -1, epoll_fd = -1;
+	try {
+		socket.reset(new UdpSocket(settings.port));
+		socket_fd = int(socket->native_handle());
+		{ //a big receive buffer, since every client's input arrives in the same few milliseconds each tick:
+			int bytes = 4 << 20;
+			setsockopt(socket_fd, SOL_SOCKET, SO_RCVBUF, &bytes, sizeof(bytes));
+		}
+
+		timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+		if (timer_fd < 0) throw std::runtime_error("Failed to create tick timer.");
+		{
+			long period_ns = long(1e9 / settings.tick_rate);
+			itimerspec spec = {};
+			spec.it_interval.tv_sec = period_ns / 1000000000L;
+			spec.it_interval.tv_nsec = period_ns % 1000000000L;
+			spec.it_value = spec.it_interval;
+			if (timerfd_settime(timer_fd, 0, &spec, nullptr) != 0) throw std::runtime_error("Failed to start tick timer.");
+		}
+
+		epoll_fd = epoll_create1(0);
+		if (epoll_fd < 0) throw std::runtime_error("Failed to create epoll instance.");
+		for (int fd : { socket_fd, timer_fd }) {
+			epoll_event event = {};
+			event.events = EPOLLIN;
+			event.data.fd = fd;
+			if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) throw std::runtime_error("Failed to watch socket and tick timer.");
+		}
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	WorkStealingPool pool(settings.threads);
+	PongCourts courts;
+	std::vector< Match > matches;
+	std::vector< uint32_t > free_matches;
+	std::unordered_map< uint64_t, uint32_t > match_of_client;
+	uint32_t active_matches = 0;
+
+	const float tick_seconds = 1.0f / settings.tick_rate;
+	uint32_t tick = 0;
+
+	std::cout << "pong_server: listening on port " << socket->port() << ", " << settings.tick_rate << " ticks/s, "
+		<< pool.thread_count() << " threads." << std::endl;
+
+	//------------ metrics ------------
+	struct {
+		uint32_t ticks = 0;
+		uint64_t missed_ticks = 0; //timer expirations that happened while the previous tick was still running
+		double receive = 0.0, simulate = 0.0, encode = 0.0, send = 0.0; //seconds, summed over ticks
+		double tick_max = 0.0;
+		uint64_t bytes_sent = 0, bytes_received = 0;
+		double started = now_seconds();
+		std::clock_t cpu_started = std::clock();
+	} metrics;
+
+	auto report = [&]() {
+		double wall = now_seconds() - metrics.started;
+		double cpu = double(std::clock() - metrics.cpu_started) / CLOCKS_PER_SEC;
+		uint32_t ticks = std::max(1U, metrics.ticks);
+		double per_tick = (metrics.receive + metrics.simulate + metrics.encode + metrics.send) / ticks;
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< "pong_server: " << active_matches << " matches, " << metrics.ticks << " ticks (" << metrics.missed_ticks << " missed); "
+			<< "per tick " << per_tick * 1e3 << " ms (receive " << metrics.receive / ticks * 1e3
+			<< ", simulate " << metrics.simulate / ticks * 1e3
+			<< ", encode " << metrics.encode / ticks * 1e3
+			<< ", send " << metrics.send / ticks * 1e3 << "), max " << metrics.tick_max * 1e3 << " ms; "
+			<< std::setprecision(1)
+			<< "out " << (socket->bytes_sent - metrics.bytes_sent) / wall / 1e3 << " kB/s, "
+			<< "in " << (socket->bytes_received - metrics.bytes_received) / wall / 1e3 << " kB/s; "
+			<< "CPU " << cpu / wall * 100.0 << "%";
+		//(CPU time is process-wide, so this counts every thread, including time spent in the kernel sending)
+		if (active_matches > 0 && cpu > 0.0) {
+			std::cout << " => about " << std::setprecision(0) << active_matches / (cpu / wall) << " matches per core";
+		}
+		std::cout << std::endl;
+
+		metrics.ticks = 0;
+		metrics.missed_ticks = 0;
+		metrics.receive = metrics.simulate = metrics.encode = metrics.send = metrics.tick_max = 0.0;
+		metrics.bytes_sent = socket->bytes_sent;
+		metrics.bytes_received = socket->bytes_received;
+		metrics.started = now_seconds();
+		metrics.cpu_started = std::clock();
+	};
+
+	//------------ receive ------------
+	auto receive = [&]() {
+		double now = now_seconds();
+		uint8_t data[MaxPacket];
+		UdpSocket::Address from;
+		while (size_t size = socket->receive(data, sizeof(data), &from)) {
+			PacketReader packet(data, size);
+			PongInputPacket input;
+			if (!read_input_packet(packet, &input)) continue;
+
+			//find (or start) this client's match:
+			uint32_t index;
+			auto found = match_of_client.find(address_key(from));
+			if (found != match_of_client.end()) {
+				index = found->second;
+			} else {
+				if (active_matches >= settings.max_matches) continue;
+				if (!free_matches.empty()) {
+					index = free_matches.back();
+					free_matches.pop_back();
+				} else {
+					index = uint32_t(matches.size());
+					matches.emplace_back();
+					courts.resize(index + 1);
+				}
+				matches[index] = Match();
+				matches[index].active = true;
+				matches[index].client = from;
+				courts.reset(index);
+				courts.right_player[index] = 1;
+				courts.active[index] = 1;
+				match_of_client[address_key(from)] = index;
+				active_matches += 1;
+			}
+
+			Match &match = matches[index];
+			match.last_heard = now;
+			match.acked_tick = std::max(match.acked_tick, input.ack_tick);
+			//queue inputs the server hasn't seen yet, oldest first:
+			for (uint32_t i = 0; i < input.count; ++i) {
+				uint32_t seq = input.newest_seq - (input.count - 1 - i);
+				if (seq > match.client_seq) {
+					match.input_queue.push_back(Match::PaddleInput{ seq, input.ys[i] });
+					match.client_seq = seq;
+				}
+			}
+		}
+	};
+
+	//------------ tick ------------
+	std::vector< PacketWriter > packets;
+	float since_timeouts = 0.0f;
+	float since_report = 0.0f;
+
+	auto run_tick = [&]() {
+		auto t0 = std::chrono::steady_clock::now();
+
+		//use one input per client per tick (as NetPongMode's host does), so clients' predictions line up:
+		for (uint32_t i = 0; i < matches.size(); ++i) {
+			Match &match = matches[i];
+			if (!match.active) continue;
+			while (match.input_queue.size() > 3) match.input_queue.pop_front();
+			if (!match.input_queue.empty()) {
+				courts.right_input[i] = match.input_queue.front().y;
+				match.applied_seq = match.input_queue.front().seq;
+				match.input_queue.pop_front();
+			}
+		}
+
+		courts.update(tick_seconds, &pool);
+		tick += 1;
+
+		auto t1 = std::chrono::steady_clock::now();
+
+		//encode everyone's state packet (in parallel):
+		packets.resize(matches.size());
+		pool.parallel_for(uint32_t(matches.size()), 256, [&](uint32_t begin, uint32_t end, uint32_t) {
+			for (uint32_t i = begin; i < end; ++i) {
+				Match &match = matches[i];
+				if (!match.active) continue;
+				PongNetState state;
+				state.tick = tick;
+				state.words[0] = float_bits(courts.left_ai.paddle_y[i]);
+				state.words[1] = float_bits(courts.right_ai.paddle_y[i]);
+				state.words[2] = float_bits(courts.ball_x[i]);
+				state.words[3] = float_bits(courts.ball_y[i]);
+				state.words[4] = float_bits(courts.ball_vx[i]);
+				state.words[5] = float_bits(courts.ball_vy[i]);
+				state.words[6] = courts.left_score[i];
+				state.words[7] = courts.right_score[i];
+				match.history.store(state);
+
+				packets[i].size = 0;
+				write_state_packet(packets[i], state, match.history.find(match.acked_tick), match.applied_seq);
+			}
+		});
+
+		auto t2 = std::chrono::steady_clock::now();
+
+		for (uint32_t i = 0; i < matches.size(); ++i) {
+			if (!matches[i].active) continue;
+			socket->send(matches[i].client, packets[i].data, packets[i].size);
+		}
+
+		auto t3 = std::chrono::steady_clock::now();
+
+		metrics.ticks += 1;
+		metrics.simulate += std::chrono::duration< double >(t1 - t0).count();
+		metrics.encode += std::chrono::duration< double >(t2 - t1).count();
+		metrics.send += std::chrono::duration< double >(t3 - t2).count();
+		metrics.tick_max = std::max(metrics.tick_max, std::chrono::duration< double >(t3 - t0).count());
+
+		//free courts of clients that went quiet:
+		since_timeouts += tick_seconds;
+		if (since_timeouts > 1.0f) {
+			since_timeouts = 0.0f;
+			double now = now_seconds();
+			for (uint32_t i = 0; i < matches.size(); ++i) {
+				Match &match = matches[i];
+				if (match.active && now - match.last_heard > settings.timeout) {
+					match.active = false;
+					match.input_queue.clear();
+					courts.right_player[i] = 0;
+					courts.active[i] = 0; //(the court stops being simulated until it is reused)
+					match_of_client.erase(address_key(match.client));
+					free_matches.emplace_back(i);
+					active_matches -= 1;
+				}
+			}
+		}
+
+		since_report += tick_seconds;
+		if (since_report > settings.report_interval) {
+			since_report = 0.0f;
+			report();
+		}
+	};
+
+	//------------ main loop ------------
+	epoll_event events[2];
+	while (true) {
+		int count = epoll_wait(epoll_fd, events, 2, -1);
+		for (int e = 0; e < count; ++e) {
+			if (events[e].data.fd == socket_fd) {
+				auto before = std::chrono::steady_clock::now();
+				receive();
+				metrics.receive += std::chrono::duration< double >(std::chrono::steady_clock::now() - before).count();
+			} else if (events[e].data.fd == timer_fd) {
+				uint64_t expirations = 0;
+				if (read(timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations) || expirations == 0) continue;
+				//(if ticks were missed, the game just runs late rather than trying to catch up)
+				metrics.missed_ticks += expirations - 1;
+				run_tick();
+			}
+		}
+	}
+
+	return 0;
+}
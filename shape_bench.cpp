@@ -0,0 +1,323 @@
+//shape_bench draws the same scene of circles, rounded rectangles, and annular sectors
+// two ways into an offscreen framebuffer and compares them:
+//  - "tessellated": triangles (PosColVertex + ColorProgram), with enough segments that no
+//    curved edge is more than --tolerance pixels off (and no antialiasing);
+//  - "sdf": one quad per shape (Shape + ShapeProgram), antialiased analytically.
+// It reports the vertices and bytes uploaded per frame and the GPU time per frame
+// (GL_TIME_ELAPSED queries around upload + draw), for 1,000 / 10,000 / 100,000 shapes.
+
+#include "ShapeProgram.hpp"
+#include "ColorProgram.hpp"
+#include "Vertex2D.hpp"
+#include "GLState.hpp"
+#include "gl_errors.hpp"
+#include "gl_debug.hpp"
+#include "GL.hpp"
+
+#include <SDL.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct Settings {
+	glm::uvec2 size = glm::uvec2(1920, 1080); //offscreen framebuffer size
+	uint32_t frames = 100; //frames timed per case (after a few warm-up frames)
+	float tolerance = 0.25f; //pixels; worst distance from a tessellated edge to the true curve
+	std::vector< uint32_t > counts = { 1000, 10000, 100000 };
+	uint32_t seed = 0;
+};
+
+//----- scene -----
+
+//random shapes in pixel coordinates, roughly ball-to-paddle sized:
+static std::vector< Shape > make_scene(Settings const &settings, uint32_t count) {
+	std::mt19937 mt(settings.seed);
+	std::uniform_real_distribution< float > x(0.0f, float(settings.size.x));
+	std::uniform_real_distribution< float > y(0.0f, float(settings.size.y));
+	std::uniform_real_distribution< float > radius(4.0f, 40.0f);
+	std::uniform_real_distribution< float > unit(0.0f, 1.0f);
+	std::uniform_int_distribution< uint32_t > byte(0, 255);
+
+	std::vector< Shape > shapes;
+	shapes.reserve(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		glm::vec2 at = glm::vec2(x(mt), y(mt));
+		glm::u8vec4 color = glm::u8vec4(byte(mt), byte(mt), byte(mt), 0xff);
+		float r = radius(mt);
+		if (i % 3 == 0) {
+			shapes.emplace_back(Shape::circle(at, r, color));
+		} else if (i % 3 == 1) {
+			shapes.emplace_back(Shape::rounded_rect(at, glm::vec2(r, r * (0.5f + unit(mt))), 0.3f * r, color));
+		} else {
+			shapes.emplace_back(Shape::annular_sector(at, 0.75f * r, r, 6.2831853f * unit(mt), 0.25f + unit(mt), color));
+		}
+	}
+	return shapes;
+}
+
+//----- tessellation -----
+
+//segments needed for 'angle' radians of a circle of radius r, so no chord strays more than 'tolerance' from it:
+static uint32_t segments(float r, float angle, float tolerance) {
+	float step = 2.0f * std::acos(std::max(-1.0f, 1.0f - tolerance / std::max(r, 1e-6f)));
+	return std::max(1U, uint32_t(std::ceil(angle / std::max(step, 1e-3f))));
+}
+
+struct Mesh {
+	std::vector< PosColVertex > vertices;
+	std::vector< uint32_t > indices; //GL_TRIANGLES
+};
+
+static void tessellate(Shape const &shape, float tolerance, Mesh &mesh) {
+	//shape frame -> pixels:
+	glm::vec2 x_axis = glm::vec2(shape.Axis.y, -shape.Axis.x);
+	auto to_pixels = [&shape, &x_axis](glm::vec2 const &local) {
+		return shape.Center + local.x * x_axis + local.y * shape.Axis;
+	};
+	uint32_t base = uint32_t(mesh.vertices.size());
+
+	if (shape.Kind == Shape::Circle || shape.Kind == Shape::RoundedRect) {
+		//triangle fan around the center, with each corner (or the whole circle) as an arc:
+		glm::vec2 half = (shape.Kind == Shape::Circle ? glm::vec2(0.0f) : glm::vec2(shape.Params.x, shape.Params.y) - shape.Params.z);
+		float r = (shape.Kind == Shape::Circle ? shape.Params.x : shape.Params.z);
+		mesh.vertices.emplace_back(to_pixels(glm::vec2(0.0f)), shape.Color);
+		uint32_t corners = (shape.Kind == Shape::Circle ? 1 : 4);
+		uint32_t n = segments(r, 6.2831853f / corners, tolerance);
+		for (uint32_t c = 0; c < corners; ++c) {
+			glm::vec2 corner = glm::vec2((c == 0 || c == 3 ? 1.0f : -1.0f) * half.x, (c < 2 ? 1.0f : -1.0f) * half.y);
+			for (uint32_t i = 0; i <= n; ++i) {
+				float a = (c + i / float(n)) * (6.2831853f / corners);
+				mesh.vertices.emplace_back(to_pixels(corner + r * glm::vec2(std::cos(a), std::sin(a))), shape.Color);
+			}
+		}
+		uint32_t rim = uint32_t(mesh.vertices.size()) - base - 1;
+		for (uint32_t i = 0; i < rim; ++i) {
+			mesh.indices.insert(mesh.indices.end(), { base, base + 1 + i, base + 1 + (i + 1) % rim });
+		}
+	} else {
+		//strip of quads between the inner and outer edges:
+		float inner = shape.Params.x - 0.5f * shape.Params.y;
+		float outer = shape.Params.x + 0.5f * shape.Params.y;
+		float half_angle = std::atan2(shape.Params.w, shape.Params.z);
+		uint32_t n = segments(outer, 2.0f * half_angle, tolerance);
+		for (uint32_t i = 0; i <= n; ++i) {
+			float a = -half_angle + 2.0f * half_angle * (i / float(n));
+			glm::vec2 dir = glm::vec2(std::sin(a), std::cos(a));
+			mesh.vertices.emplace_back(to_pixels(inner * dir), shape.Color);
+			mesh.vertices.emplace_back(to_pixels(outer * dir), shape.Color);
+		}
+		for (uint32_t i = 0; i < n; ++i) {
+			uint32_t q = base + 2 * i;
+			mesh.indices.insert(mesh.indices.end(), { q, q + 1, q + 2, q + 2, q + 1, q + 3 });
+		}
+	}
+}
+
+//----- timing -----
+
+struct Timing {
+	double gpu_ms = 0.0; //median per frame
+	double cpu_ms = 0.0; //median per frame (issuing the calls)
+};
+
+//run 'frame' (upload + draw) a few times to warm up, then settings.frames times with a timer query around each:
+template< typename F >
+static Timing time_frames(Settings const &settings, F const &frame) {
+	for (uint32_t i = 0; i < 5; ++i) {
+		glClear(GL_COLOR_BUFFER_BIT);
+		frame();
+	}
+	glFinish();
+
+	std::vector< GLuint > queries(settings.frames);
+	glGenQueries(GLsizei(queries.size()), queries.data());
+	std::vector< double > cpu(settings.frames);
+	for (uint32_t i = 0; i < settings.frames; ++i) {
+		glClear(GL_COLOR_BUFFER_BIT);
+		auto before = std::chrono::steady_clock::now();
+		glBeginQuery(GL_TIME_ELAPSED, queries[i]);
+		frame();
+		glEndQuery(GL_TIME_ELAPSED);
+		cpu[i] = std::chrono::duration< double, std::milli >(std::chrono::steady_clock::now() - before).count();
+	}
+	std::vector< double > gpu(settings.frames);
+	for (uint32_t i = 0; i < settings.frames; ++i) {
+		GLuint64 ns = 0;
+		glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &ns);
+		gpu[i] = ns * 1e-6;
+	}
+	glDeleteQueries(GLsizei(queries.size()), queries.data());
+
+	auto median = [](std::vector< double > &values) {
+		std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+		return values[values.size() / 2];
+	};
+	Timing timing;
+	timing.gpu_ms = median(gpu);
+	timing.cpu_ms = median(cpu);
+	return timing;
+}
+
+int main(int argc, char **argv) {
+	Settings settings;
+	try {
+		for (int argi = 1; argi < argc; ++argi) {
+			std::string arg = argv[argi];
+			auto value = [&]() -> std::string {
+				if (argi + 1 >= argc) throw std::runtime_error("Expecting a value after '" + arg + "'.");
+				argi += 1;
+				return argv[argi];
+			};
+			if (arg == "--size") {
+				std::string v = value();
+				size_t x = v.find('x');
+				if (x == std::string::npos) throw std::runtime_error("Expecting '--size <width>x<height>'.");
+				settings.size = glm::uvec2(std::stoul(v.substr(0, x)), std::stoul(v.substr(x + 1)));
+			} else if (arg == "--frames") {
+				settings.frames = uint32_t(std::max(1UL, std::stoul(value())));
+			} else if (arg == "--tolerance") {
+				settings.tolerance = std::max(0.01f, std::stof(value()));
+			} else if (arg == "--shapes") {
+				settings.counts = { uint32_t(std::stoul(value())) };
+			} else if (arg == "--seed") {
+				settings.seed = uint32_t(std::stoul(value()));
+			} else {
+				throw std::runtime_error("Unknown argument '" + arg + "'.");
+			}
+		}
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << "Usage: shape-bench [--size <width>x<height>] [--frames <n>] [--tolerance <pixels>] [--shapes <n>] [--seed <n>]" << std::endl;
+		return 1;
+	}
+
+	//----- offscreen OpenGL context -----
+	//(a hidden window, since SDL needs one to make a context; nothing is drawn to it)
+	SDL_Init(SDL_INIT_VIDEO);
+	SDL_GL_ResetAttributes();
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+	SDL_Window *window = SDL_CreateWindow("shape-bench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 64, 64, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+	if (!window) {
+		std::cerr << "Error creating SDL window: " << SDL_GetError() << std::endl;
+		return 1;
+	}
+	SDL_GLContext context = SDL_GL_CreateContext(window);
+	if (!context) {
+		SDL_DestroyWindow(window);
+		std::cerr << "Error creating OpenGL context: " << SDL_GetError() << std::endl;
+		return 1;
+	}
+	init_GL();
+	gl_debug_init();
+
+	int exit_code = 0;
+	{
+		//render target:
+		GLuint color = 0, framebuffer = 0;
+		glGenRenderbuffers(1, &color);
+		glBindRenderbuffer(GL_RENDERBUFFER, color);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, settings.size.x, settings.size.y);
+		glGenFramebuffers(1, &framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			std::cerr << "Offscreen framebuffer is incomplete." << std::endl;
+			exit_code = 1;
+		}
+		glViewport(0, 0, settings.size.x, settings.size.y);
+		GLState::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
+		GLState::disable(GL_DEPTH_TEST);
+		GLState::enable(GL_BLEND);
+		GLState::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		//pixels -> clip:
+		glm::mat4 pixels_to_clip = glm::mat4(
+			glm::vec4(2.0f / settings.size.x, 0.0f, 0.0f, 0.0f),
+			glm::vec4(0.0f, 2.0f / settings.size.y, 0.0f, 0.0f),
+			glm::vec4(0.0f, 0.0f, 1.0f, 0.0f),
+			glm::vec4(-1.0f, -1.0f, 0.0f, 1.0f)
+		);
+
+		ColorProgram color_program;
+		ShapeProgram shape_program;
+		GLuint buffers[4] = { 0, 0, 0, 0 }; //mesh vertices, mesh indices, corners, shapes
+		glGenBuffers(4, buffers);
+		std::vector< glm::vec2 > corners = {
+			glm::vec2(-1.0f,-1.0f), glm::vec2( 1.0f,-1.0f), glm::vec2(-1.0f, 1.0f), glm::vec2( 1.0f, 1.0f)
+		};
+		GLState::bind_buffer(GL_ARRAY_BUFFER, buffers[2]);
+		glBufferData(GL_ARRAY_BUFFER, corners.size() * sizeof(corners[0]), corners.data(), GL_STATIC_DRAW);
+		GLuint mesh_vao = make_vertex_array< PosColVertex >(color_program, buffers[0], buffers[1]);
+		GLuint shape_vao = make_shape_vertex_array(shape_program, buffers[2], buffers[3]);
+
+		std::cout << "Drawing into a " << settings.size.x << "x" << settings.size.y << " offscreen framebuffer; "
+			<< "tessellated edges within " << settings.tolerance << " px; median of " << settings.frames << " frames." << std::endl;
+
+		for (uint32_t count : settings.counts) {
+			if (exit_code != 0) break;
+			std::vector< Shape > shapes = make_scene(settings, count);
+			Mesh mesh;
+			for (auto const &shape : shapes) {
+				tessellate(shape, settings.tolerance, mesh);
+			}
+
+			Timing tessellated = time_frames(settings, [&]() {
+				GLState::bind_buffer(GL_ARRAY_BUFFER, buffers[0]);
+				glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(mesh.vertices[0]), mesh.vertices.data(), GL_STREAM_DRAW);
+				GLState::use_program(color_program.program);
+				glUniformMatrix4fv(color_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(pixels_to_clip));
+				GLState::bind_vertex_array(mesh_vao);
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(mesh.indices[0]), mesh.indices.data(), GL_STREAM_DRAW);
+				glDrawElements(GL_TRIANGLES, GLsizei(mesh.indices.size()), GL_UNSIGNED_INT, (GLbyte *)0);
+			});
+
+			Timing sdf = time_frames(settings, [&]() {
+				GLState::bind_buffer(GL_ARRAY_BUFFER, buffers[3]);
+				glBufferData(GL_ARRAY_BUFFER, shapes.size() * sizeof(shapes[0]), shapes.data(), GL_STREAM_DRAW);
+				GLState::use_program(shape_program.program);
+				glUniformMatrix4fv(shape_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(pixels_to_clip));
+				glUniform1f(shape_program.PIXEL_SIZE_float, 1.0f);
+				GLState::bind_vertex_array(shape_vao);
+				glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(shapes.size()));
+			});
+
+			GL_ERRORS();
+
+			size_t mesh_bytes = mesh.vertices.size() * sizeof(mesh.vertices[0]) + mesh.indices.size() * sizeof(mesh.indices[0]);
+			size_t shape_bytes = shapes.size() * sizeof(shapes[0]);
+			std::cout << count << " shapes:\n" << std::fixed;
+			std::cout << "  tessellated: " << mesh.vertices.size() << " vertices, " << mesh.indices.size() / 3 << " triangles, "
+				<< std::setprecision(1) << (mesh_bytes / 1024.0) << " KiB/frame; "
+				<< std::setprecision(3) << tessellated.gpu_ms << " ms GPU, " << tessellated.cpu_ms << " ms CPU\n";
+			std::cout << "  sdf:         " << 4 * shapes.size() << " vertices (" << shapes.size() << " quads), "
+				<< std::setprecision(1) << (shape_bytes / 1024.0) << " KiB/frame; "
+				<< std::setprecision(3) << sdf.gpu_ms << " ms GPU, " << sdf.cpu_ms << " ms CPU\n";
+			std::cout << "  sdf / tessellated: " << std::setprecision(2) << (double(shape_bytes) / mesh_bytes) << "x bytes, "
+				<< (sdf.gpu_ms / std::max(tessellated.gpu_ms, 1e-6)) << "x GPU time" << std::endl;
+		}
+
+		GLState::delete_vertex_arrays(1, &shape_vao);
+		GLState::delete_vertex_arrays(1, &mesh_vao);
+		GLState::delete_buffers(4, buffers);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteRenderbuffers(1, &color);
+	}
+
+	SDL_GL_DeleteContext(context);
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+	return exit_code;
+}
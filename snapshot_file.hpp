@@ -0,0 +1,61 @@
+#pragma once
+
+/*
+ * Save and load snapshots (trivially copyable game state structs, like
+ *  BallDefender::Snapshot or PongMode::Snapshot) as files.
+ *
+ * A file is a 12-byte header (magic, the snapshot type's Version, sizeof the type)
+ *  followed by the struct's bytes, so files from an older layout are rejected
+ *  instead of misread. Files are in native byte order (for saving test cases and
+ *  benchmark starting points, not for sharing between machines).
+ *
+ * Errors are reported by throwing std::runtime_error.
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+struct SnapshotFileHeader {
+	static constexpr uint32_t Magic = 0x70616e73; //'snap' when read as little-endian bytes
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;
+};
+
+template< typename Snapshot >
+void save_snapshot(std::string const &filename, Snapshot const &snapshot) {
+	static_assert(std::is_trivially_copyable< Snapshot >::value, "Snapshots are saved byte-for-byte, so they must be trivially copyable.");
+
+	SnapshotFileHeader header{ SnapshotFileHeader::Magic, Snapshot::Version, uint32_t(sizeof(Snapshot)) };
+
+	std::ofstream out(filename, std::ios::binary);
+	if (!out) throw std::runtime_error("Failed to open '" + filename + "' for writing.");
+	out.write(reinterpret_cast< char const * >(&header), sizeof(header));
+	out.write(reinterpret_cast< char const * >(&snapshot), sizeof(snapshot));
+	if (!out) throw std::runtime_error("Failed to write snapshot to '" + filename + "'.");
+}
+
+template< typename Snapshot >
+Snapshot load_snapshot(std::string const &filename) {
+	static_assert(std::is_trivially_copyable< Snapshot >::value, "Snapshots are loaded byte-for-byte, so they must be trivially copyable.");
+
+	std::ifstream in(filename, std::ios::binary);
+	if (!in) throw std::runtime_error("Failed to open snapshot '" + filename + "'.");
+
+	SnapshotFileHeader header;
+	if (!in.read(reinterpret_cast< char * >(&header), sizeof(header)) || header.magic != SnapshotFileHeader::Magic) {
+		throw std::runtime_error("'" + filename + "' is not a snapshot file.");
+	}
+	if (header.version != Snapshot::Version || header.size != sizeof(Snapshot)) {
+		throw std::runtime_error("Snapshot '" + filename + "' is version " + std::to_string(header.version) + " (" + std::to_string(header.size) + " bytes); expected version " + std::to_string(Snapshot::Version) + " (" + std::to_string(sizeof(Snapshot)) + " bytes).");
+	}
+
+	Snapshot snapshot;
+	if (!in.read(reinterpret_cast< char * >(&snapshot), sizeof(snapshot))) {
+		throw std::runtime_error("Snapshot '" + filename + "' is truncated.");
+	}
+	return snapshot;
+}
@@ -0,0 +1,245 @@
+//spectator_bench measures SpectatorServer fan-out (see SpectatorStream.hpp) with many local viewers.
+// --host runs a headless bot-played game of Ball Defender and broadcasts it; --watch connects many
+// viewers to a broadcast (this tool's, or the game's --broadcast) and reports what they receive.
+// With neither, both run in one process.
+
+#include "SpectatorStream.hpp"
+#include "BallDefender.hpp"
+#include "PaddleController.hpp"
+#include "FramePacer.hpp"
+
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Settings {
+	std::string address = "@ball-defender-bench";
+	bool host = true, watch = true;
+	uint32_t viewers = 1000;
+	float tick_rate = 60.0f;
+	float seconds = 30.0f;
+	float report_interval = 5.0f;
+};
+
+static double now_seconds() {
+	return std::chrono::duration< double >(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//----- host -----
+
+static void run_host(Settings const &settings, std::atomic< bool > const &quit) {
+	SpectatorServer server(settings.address);
+	BallDefender game;
+	game.restart();
+	BotPaddle bot;
+	bot.reaction = 0.02f; //(a strong bot, so the game stays busy)
+	bot.turn_rate = 30.0f;
+	bot.aim_error = 0.0f;
+
+	std::cout << "Broadcasting on '" << settings.address << "' at " << settings.tick_rate << " ticks/s." << std::endl;
+
+	const float step = 1.0f / settings.tick_rate;
+	FramePacer pacer(settings.tick_rate, false);
+	double end = now_seconds() + settings.seconds;
+	double report_at = now_seconds() + settings.report_interval;
+	uint64_t frames_before = 0, packets_before = 0, bytes_before = 0, dropped_before = 0, encode_before = 0, send_before = 0;
+
+	while (!quit && now_seconds() < end) {
+		server.poll();
+		game.arc_paddle = bot.paddle(game, step);
+		game.update(step);
+		server.broadcast(game.save());
+		pacer.wait();
+
+		if (now_seconds() >= report_at) {
+			double frames = double(server.frames - frames_before);
+			double packets = double(server.packets_sent - packets_before);
+			std::cout << std::fixed << std::setprecision(2)
+				<< "host: " << server.viewer_count() << " viewers"
+				<< ", encode " << ((server.encode_ns - encode_before) / frames * 1e-3) << " us/tick"
+				<< ", send " << ((server.send_ns - send_before) / frames * 1e-3) << " us/tick"
+				<< " (" << (packets ? (server.send_ns - send_before) / packets : 0.0) << " ns/viewer)"
+				<< ", " << (packets ? (server.bytes_sent - bytes_before) / packets : 0.0) << " bytes/frame"
+				<< ", " << (server.packets_dropped - dropped_before) << " dropped"
+				<< std::endl;
+			frames_before = server.frames;
+			packets_before = server.packets_sent;
+			bytes_before = server.bytes_sent;
+			dropped_before = server.packets_dropped;
+			encode_before = server.encode_ns;
+			send_before = server.send_ns;
+			report_at += settings.report_interval;
+		}
+	}
+	std::cout << "host: " << server.frames << " frames (" << server.key_frames << " key frames), "
+		<< server.packets_sent << " packets sent, " << server.packets_dropped << " dropped." << std::endl;
+}
+
+//----- viewers -----
+
+static void run_viewers(Settings const &settings) {
+	std::vector< std::unique_ptr< SpectatorViewer > > viewers;
+	viewers.reserve(settings.viewers);
+	int epoll = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll < 0) throw std::runtime_error("Failed to create epoll instance.");
+	for (uint32_t v = 0; v < settings.viewers; ++v) {
+		viewers.emplace_back(new SpectatorViewer(settings.address));
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.u32 = v;
+		epoll_ctl(epoll, EPOLL_CTL_ADD, int(viewers.back()->native_handle()), &event);
+		viewers.back()->poll(); //(says hello)
+	}
+
+	std::cout << "Watching '" << settings.address << "' with " << viewers.size() << " viewers." << std::endl;
+
+	double start = now_seconds();
+	double end = start + settings.seconds;
+	double report_at = start + settings.report_interval;
+	double hello_at = start;
+	std::vector< epoll_event > events(1024);
+	uint64_t frames_before = 0;
+	double period_start = start;
+
+	auto totals = [&viewers](uint64_t *frames, uint64_t *skipped, double *latency_sum, double *latency_max) {
+		*frames = 0; *skipped = 0; *latency_sum = 0.0; *latency_max = 0.0;
+		for (auto const &viewer : viewers) {
+			*frames += viewer->frames;
+			*skipped += viewer->skipped;
+			*latency_sum += viewer->latency_sum;
+			*latency_max = std::max(*latency_max, viewer->latency_max);
+		}
+	};
+
+	while (now_seconds() < end) {
+		int count = epoll_wait(epoll, events.data(), int(events.size()), 50);
+		for (int e = 0; e < count; ++e) {
+			viewers[events[e].data.u32]->poll();
+		}
+		//(viewers that haven't joined yet need to keep saying hello, even if nothing arrives)
+		if (now_seconds() >= hello_at) {
+			for (auto &viewer : viewers) {
+				if (viewer->tick == 0) viewer->poll();
+			}
+			hello_at += 0.02;
+		}
+
+		if (now_seconds() >= report_at) {
+			uint64_t frames, skipped;
+			double latency_sum, latency_max;
+			totals(&frames, &skipped, &latency_sum, &latency_max);
+			double elapsed = now_seconds() - period_start;
+			std::cout << std::fixed << std::setprecision(2)
+				<< "viewers: " << ((frames - frames_before) / elapsed / viewers.size()) << " frames/s each"
+				<< ", latency " << (frames ? latency_sum / frames * 1e3 : 0.0) << " ms avg, " << (latency_max * 1e3) << " ms max"
+				<< ", " << skipped << " deltas skipped" << std::endl;
+			frames_before = frames;
+			period_start = now_seconds();
+			report_at += settings.report_interval;
+		}
+	}
+
+	uint64_t frames, skipped;
+	double latency_sum, latency_max;
+	totals(&frames, &skipped, &latency_sum, &latency_max);
+	uint32_t synced = 0;
+	for (auto const &viewer : viewers) synced += (viewer->tick != 0 ? 1 : 0);
+	std::cout << std::fixed << std::setprecision(2)
+		<< "viewers: " << synced << " of " << viewers.size() << " received the game; "
+		<< (double(frames) / viewers.size() / settings.seconds) << " frames/s each on average, latency "
+		<< (frames ? latency_sum / frames * 1e3 : 0.0) << " ms avg, " << (latency_max * 1e3) << " ms max; "
+		<< skipped << " deltas skipped." << std::endl;
+
+	viewers.clear(); //(say goodbye before the host stops)
+}
+
+static void usage(char const *argv0) {
+	std::cerr << "Usage:\n\t" << argv0 << " [options]\n"
+		"Options:\n"
+		"\t--host <address>     only broadcast a bot game (e.g. @ball-defender)\n"
+		"\t--watch <address>    only watch a broadcast\n"
+		"\t                     (with neither, do both on @ball-defender-bench)\n"
+		"\t--viewers <n>        viewers to connect (default 1000)\n"
+		"\t--tick-rate <hz>     host ticks per second (default 60)\n"
+		"\t--seconds <s>        how long to run (default 30)\n"
+	;
+}
+
+int main(int argc, char **argv) {
+	Settings settings;
+
+	//------------ command line ------------
+	try {
+		for (int argi = 1; argi < argc; ++argi) {
+			std::string arg = argv[argi];
+			if (arg == "--help") {
+				usage(argv[0]);
+				return 0;
+			}
+			if (argi + 1 >= argc) throw std::runtime_error("missing value for '" + arg + "'");
+			std::string val = argv[++argi];
+			if (arg == "--host") { settings.address = val; settings.watch = false; }
+			else if (arg == "--watch") { settings.address = val; settings.host = false; }
+			else if (arg == "--viewers") settings.viewers = uint32_t(std::stoul(val));
+			else if (arg == "--tick-rate") settings.tick_rate = std::stof(val);
+			else if (arg == "--seconds") settings.seconds = std::stof(val);
+			else throw std::runtime_error("unknown option '" + arg + "'");
+		}
+		if (!settings.host && !settings.watch) throw std::runtime_error("use one of --host or --watch");
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << std::endl;
+		usage(argv[0]);
+		return 1;
+	}
+
+	//------------ run ------------
+	//one socket per viewer (plus a few), so raise the open file limit as far as allowed:
+	rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+
+	try {
+		if (settings.host && settings.watch) {
+			std::atomic< bool > quit(false);
+			std::thread host([&](){
+				try {
+					run_host(settings, quit);
+				} catch (std::exception const &e) {
+					std::cerr << e.what() << std::endl;
+				}
+			});
+			std::this_thread::sleep_for(std::chrono::milliseconds(100)); //(let the host bind first)
+			try {
+				run_viewers(settings);
+			} catch (...) {
+				quit = true;
+				host.join();
+				throw;
+			}
+			quit = true;
+			host.join();
+		} else if (settings.host) {
+			std::atomic< bool > quit(false);
+			run_host(settings, quit);
+		} else {
+			run_viewers(settings);
+		}
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,283 @@
+//state_codec_bench measures StateCodec (see StateCodec.hpp) on recorded frames:
+// bytes per snapshot (raw structs vs. bit-packed, with and without a delta against the previous
+// frame), encode/decode throughput, and the worst quantization error.
+// Cases: a real game of Ball Defender (7 balls, played by BotPaddle) and courts full of 100 and
+// 10,000 bouncing balls (StressMode-style).
+
+#include "StateCodec.hpp"
+#include "BallDefender.hpp"
+#include "PaddleController.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct Settings {
+	uint32_t frames = 600; //frames recorded per case (at 60 Hz)
+	float min_time = 0.25f; //seconds each timing runs for (at least)
+	uint32_t seed = 0;
+};
+
+//run 'pass' (which handles every frame once) until min_time has passed; returns seconds per pass:
+template< typename F >
+static double time_passes(Settings const &settings, F const &pass) {
+	uint32_t passes = 0;
+	auto before = std::chrono::steady_clock::now();
+	double seconds = 0.0;
+	do {
+		pass();
+		passes += 1;
+		seconds = std::chrono::duration< double >(std::chrono::steady_clock::now() - before).count();
+	} while (seconds < settings.min_time);
+	return seconds / passes;
+}
+
+struct CaseResult {
+	size_t raw_bytes = 0; //per snapshot, as structs
+	double full_bytes = 0.0, delta_bytes = 0.0; //per snapshot, average
+	double encode_full = 0.0, encode_delta = 0.0, decode_full = 0.0, decode_delta = 0.0; //seconds per snapshot
+	float position_error = 0.0f, velocity_error = 0.0f; //worst seen
+	bool delta_matches = true; //delta decoding gave exactly the full decoding's values
+};
+
+static void report(std::string const &name, uint32_t balls, CaseResult const &r) {
+	std::cout << name << ":\n";
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "  bytes/snapshot: raw " << r.raw_bytes << ", packed " << r.full_bytes << " (" << (r.full_bytes / r.raw_bytes * 100.0) << "%)"
+		<< ", delta " << r.delta_bytes << " (" << (r.delta_bytes / r.raw_bytes * 100.0) << "%)\n";
+	auto rate = [balls](double seconds) {
+		std::ostringstream str;
+		str << std::fixed << std::setprecision(2) << (seconds * 1e6) << " us (" << (balls / seconds * 1e-6) << " Mballs/s)";
+		return str.str();
+	};
+	std::cout << "  encode: full " << rate(r.encode_full) << ", delta " << rate(r.encode_delta) << "\n";
+	std::cout << "  decode: full " << rate(r.decode_full) << ", delta " << rate(r.decode_delta) << "\n";
+	std::cout << std::setprecision(6);
+	std::cout << "  worst error: position " << r.position_error << ", velocity " << r.velocity_error
+		<< (r.delta_matches ? "" : "  ** DELTA DECODING DIFFERS FROM FULL DECODING **") << "\n";
+}
+
+//----- bouncing balls -----
+
+static std::vector< std::vector< glm::vec4 > > record_balls(Settings const &settings, uint32_t count, glm::vec2 const &court_radius) {
+	std::mt19937 mt(settings.seed);
+	std::uniform_real_distribution< float > unit(-1.0f, 1.0f);
+	std::vector< glm::vec4 > balls(count);
+	for (auto &ball : balls) {
+		ball = glm::vec4(unit(mt) * court_radius.x, unit(mt) * court_radius.y, unit(mt), unit(mt));
+	}
+
+	const float speed = 4.0f; //(velocities are directions, scaled like BallDefender's speed_multiplier)
+	const float step = 1.0f / 60.0f;
+	std::vector< std::vector< glm::vec4 > > frames;
+	frames.reserve(settings.frames);
+	for (uint32_t f = 0; f < settings.frames; ++f) {
+		for (auto &ball : balls) {
+			ball.x += ball.z * speed * step;
+			ball.y += ball.w * speed * step;
+			if (std::abs(ball.x) > court_radius.x) { ball.x = glm::clamp(ball.x, -court_radius.x, court_radius.x); ball.z = -ball.z; }
+			if (std::abs(ball.y) > court_radius.y) { ball.y = glm::clamp(ball.y, -court_radius.y, court_radius.y); ball.w = -ball.w; }
+		}
+		frames.emplace_back(balls);
+	}
+	return frames;
+}
+
+static CaseResult run_balls(Settings const &settings, std::vector< std::vector< glm::vec4 > > const &frames, StateCodec const &codec) {
+	CaseResult r;
+	uint32_t count = uint32_t(frames[0].size());
+	r.raw_bytes = count * sizeof(glm::vec4);
+
+	BitWriter out;
+	std::vector< std::vector< uint8_t > > full(frames.size()), delta(frames.size());
+	auto encode_full = [&]() {
+		for (size_t f = 0; f < frames.size(); ++f) {
+			out.clear();
+			codec.write_balls(out, frames[f].data(), count);
+			out.flush();
+			full[f] = out.bytes;
+		}
+	};
+	auto encode_delta = [&]() {
+		for (size_t f = 1; f < frames.size(); ++f) {
+			out.clear();
+			codec.write_balls(out, frames[f].data(), count, frames[f-1].data());
+			out.flush();
+			delta[f] = out.bytes;
+		}
+	};
+	r.encode_full = time_passes(settings, encode_full) / frames.size();
+	r.encode_delta = time_passes(settings, encode_delta) / (frames.size() - 1);
+
+	std::vector< std::vector< glm::vec4 > > from_full(frames.size(), std::vector< glm::vec4 >(count));
+	std::vector< std::vector< glm::vec4 > > from_delta(frames.size(), std::vector< glm::vec4 >(count));
+	auto decode_full = [&]() {
+		for (size_t f = 0; f < frames.size(); ++f) {
+			BitReader in(full[f].data(), full[f].size());
+			codec.read_balls(in, from_full[f].data(), count);
+			if (in.overrun) throw std::runtime_error("full snapshot overran");
+		}
+	};
+	auto decode_delta = [&]() {
+		//(each delta is against the previous *decoded* frame, like a receiver would have)
+		from_delta[0] = from_full[0];
+		for (size_t f = 1; f < frames.size(); ++f) {
+			BitReader in(delta[f].data(), delta[f].size());
+			codec.read_balls(in, from_delta[f].data(), count, from_delta[f-1].data());
+			if (in.overrun) throw std::runtime_error("delta snapshot overran");
+		}
+	};
+	r.decode_full = time_passes(settings, decode_full) / frames.size();
+	r.decode_delta = time_passes(settings, decode_delta) / (frames.size() - 1);
+
+	for (size_t f = 0; f < frames.size(); ++f) {
+		r.full_bytes += full[f].size();
+		if (f > 0) r.delta_bytes += delta[f].size();
+		for (uint32_t i = 0; i < count; ++i) {
+			glm::vec4 err = glm::abs(from_full[f][i] - frames[f][i]);
+			r.position_error = std::max(r.position_error, std::max(err.x, err.y));
+			r.velocity_error = std::max(r.velocity_error, std::max(err.z, err.w));
+			if (from_delta[f][i] != from_full[f][i]) r.delta_matches = false;
+		}
+	}
+	r.full_bytes /= frames.size();
+	r.delta_bytes /= (frames.size() - 1);
+	return r;
+}
+
+//----- Ball Defender -----
+
+static std::vector< BallDefender::Snapshot > record_game(Settings const &settings) {
+	BallDefender game;
+	game.restart();
+	BotPaddle bot(settings.seed);
+	std::vector< BallDefender::Snapshot > frames;
+	frames.reserve(settings.frames);
+	const float step = 1.0f / 60.0f;
+	while (frames.size() < settings.frames) {
+		game.arc_paddle = bot.paddle(game, step);
+		game.update(step);
+		frames.emplace_back(game.save());
+	}
+	return frames;
+}
+
+static CaseResult run_game(Settings const &settings, std::vector< BallDefender::Snapshot > const &frames, StateCodec const &codec) {
+	CaseResult r;
+	r.raw_bytes = sizeof(BallDefender::Snapshot);
+
+	BitWriter out;
+	std::vector< std::vector< uint8_t > > full(frames.size()), delta(frames.size());
+	auto encode_full = [&]() {
+		for (size_t f = 0; f < frames.size(); ++f) {
+			out.clear();
+			codec.write(out, frames[f]);
+			out.flush();
+			full[f] = out.bytes;
+		}
+	};
+	auto encode_delta = [&]() {
+		for (size_t f = 1; f < frames.size(); ++f) {
+			out.clear();
+			codec.write(out, frames[f], &frames[f-1]);
+			out.flush();
+			delta[f] = out.bytes;
+		}
+	};
+	r.encode_full = time_passes(settings, encode_full) / frames.size();
+	r.encode_delta = time_passes(settings, encode_delta) / (frames.size() - 1);
+
+	std::vector< BallDefender::Snapshot > from_full(frames.size()), from_delta(frames.size());
+	auto decode_full = [&]() {
+		for (size_t f = 0; f < frames.size(); ++f) {
+			BitReader in(full[f].data(), full[f].size());
+			codec.read(in, &from_full[f]);
+			if (in.overrun) throw std::runtime_error("full snapshot overran");
+		}
+	};
+	auto decode_delta = [&]() {
+		from_delta[0] = from_full[0];
+		for (size_t f = 1; f < frames.size(); ++f) {
+			BitReader in(delta[f].data(), delta[f].size());
+			codec.read(in, &from_delta[f], &from_delta[f-1]);
+			if (in.overrun) throw std::runtime_error("delta snapshot overran");
+		}
+	};
+	r.decode_full = time_passes(settings, decode_full) / frames.size();
+	r.decode_delta = time_passes(settings, decode_delta) / (frames.size() - 1);
+
+	for (size_t f = 0; f < frames.size(); ++f) {
+		r.full_bytes += full[f].size();
+		if (f > 0) r.delta_bytes += delta[f].size();
+		BallDefender::Snapshot const &a = frames[f], &b = from_full[f], &d = from_delta[f];
+		for (uint32_t i = 0; i < 7; ++i) {
+			glm::vec2 err = glm::abs(b.balls[i] - a.balls[i]);
+			glm::vec2 vel_err = glm::abs(b.ball_velocities[i] - a.ball_velocities[i]);
+			r.position_error = std::max(r.position_error, std::max(err.x, err.y));
+			if (a.balls[i].x != 12.0f) r.velocity_error = std::max(r.velocity_error, std::max(vel_err.x, vel_err.y));
+			if (d.balls[i] != b.balls[i] || d.ball_velocities[i] != b.ball_velocities[i]) r.delta_matches = false;
+		}
+		if (a.health != b.health || a.num_collisions != b.num_collisions) r.delta_matches = false;
+		if (d.health != b.health || d.num_collisions != b.num_collisions || d.arc_paddle != b.arc_paddle) r.delta_matches = false;
+	}
+	r.full_bytes /= frames.size();
+	r.delta_bytes /= (frames.size() - 1);
+	return r;
+}
+
+static void usage(char const *argv0) {
+	std::cerr << "Usage:\n\t" << argv0 << " [options]\n"
+		"Options:\n"
+		"\t--frames <n>    frames recorded per case (default 600)\n"
+		"\t--min-time <s>  seconds to run each timing for (default 0.25)\n"
+		"\t--seed <n>      random seed (default 0)\n"
+	;
+}
+
+int main(int argc, char **argv) {
+	Settings settings;
+
+	//------------ command line ------------
+	try {
+		for (int argi = 1; argi < argc; ++argi) {
+			std::string arg = argv[argi];
+			if (arg == "--help") {
+				usage(argv[0]);
+				return 0;
+			}
+			if (argi + 1 >= argc) throw std::runtime_error("missing value for '" + arg + "'");
+			std::string val = argv[++argi];
+			if (arg == "--frames") settings.frames = std::max(2U, uint32_t(std::stoul(val)));
+			else if (arg == "--min-time") settings.min_time = std::stof(val);
+			else if (arg == "--seed") settings.seed = uint32_t(std::stoul(val));
+			else throw std::runtime_error("unknown option '" + arg + "'");
+		}
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << std::endl;
+		usage(argv[0]);
+		return 1;
+	}
+
+	//------------ run ------------
+	BallDefender rules;
+	StateCodec codec(rules.court_radius);
+
+	std::cout << "Positions: " << StateCodec::PositionBits << " bits (step " << (4.0f * codec.court_radius.x / ((1U << StateCodec::PositionBits) - 1U)) << " across x); "
+		<< "velocities: " << StateCodec::VelocityBits << " bits (step " << (2.0f * StateCodec::MaxVelocity / ((1U << StateCodec::VelocityBits) - 1U)) << ")." << std::endl;
+
+	report("Ball Defender (7 balls)", 7, run_game(settings, record_game(settings), codec));
+	for (uint32_t count : { 100U, 10000U }) {
+		report(std::to_string(count) + " bouncing balls", count, run_balls(settings, record_balls(settings, count, codec.court_radius), codec));
+	}
+
+	return 0;
+}